@@ -34,10 +34,46 @@
 #define DELAY_DELTA	350.0
 #define DELAY_OFFSET	10L
 
+/* Playback scheduler limits */
+#define PLAYBACK_QUEUE_LEN	8	/* max frames rendered ahead of the display */
+#define PLAYBACK_MAX_DROP	25	/* max frames dropped in one tick before we give up and reset the schedule */
+
 extern Options options;
 
 static int cur_button = BUTTON_PAUSE;
 
+/* State of the playback scheduler.  When animating, frames are shown on a
+ * fixed wall-clock schedule set by the delay scrollbar, rather than by 
+ * waiting a fixed delay after each frame is done, so the frame rate does
+ * not depend on how long each frame takes.  There are two stages:
+ *
+ *   render:  when the interface is idle between ticks, frames coming up are
+ *	      read and colorized into the framestore (view_prerender_frame).
+ *	      At most PLAYBACK_QUEUE_LEN frames are queued up this way.
+ *   display: on each tick, the next frame is shown, normally straight from 
+ *	      the queue.  If we have fallen behind the schedule, the frames 
+ *	      we are late for are deliberately dropped to catch up.
+ */
+static struct {
+	int	step;		/* frames to advance per tick; negative for rewind */
+	double	period;		/* msec between ticks */
+	double	t0;		/* time of tick 0 of the current schedule */
+	long	n_ticks;	/* ticks since t0 */
+	long	n_shown, n_dropped;
+	double	rate_t0;	/* start of the current fps measuring interval */
+	long	rate_n0;	/* n_shown at rate_t0 */
+	float	fps;		/* achieved frames/sec over the last interval */
+	long	queue[PLAYBACK_QUEUE_LEN];	/* frames rendered ahead, in display order */
+	int	queue_n;
+} pb;
+
+static void 	playback_start( int step );
+static void 	playback_stop( void );
+static void 	playback_tick( XtPointer client_data, XtIntervalId *id );
+static Boolean 	playback_render_ahead( XtPointer client_data );
+static double	playback_period( void );
+static void 	playback_sync_queue( void );
+
 /*===========================================================================================*/
 	int
 which_button_pressed( void )
@@ -69,7 +105,7 @@ do_restart( int modifier )
 {
 	cur_button = BUTTON_PAUSE;
 
-	in_timer_clear();
+	playback_stop();
 
 	set_scan_view( 0 );
 	view_draw    ( TRUE, FALSE );
@@ -81,17 +117,12 @@ do_restart( int modifier )
 	void
 do_rewind( int modifier )
 {
-	unsigned long delay_millisec;
 	size_t	size;
 	double	d_delta;
 	int	i_delta;
 
 	cur_button = BUTTON_REWIND;
 
-	delay_millisec = (long)(DELAY_DELTA * options.frame_delay) + DELAY_OFFSET;
- 
-	in_timer_clear();
-
 	if( modifier == MOD_2 ) {
 		size = view_current_nt();
 		d_delta = (double)size / 1000.0;
@@ -99,14 +130,10 @@ do_rewind( int modifier )
 			i_delta = -10;
 		else
 			i_delta = -d_delta;
-		change_view( i_delta, FRAMES );
-		in_timer_set( (XtTimerCallbackProc)do_rewind, (XtPointer)(MOD_2), delay_millisec );
+		playback_start( i_delta );
 		}
 	else
-		{
-		change_view( -1, FRAMES );
-		in_timer_set( (XtTimerCallbackProc)do_rewind, (XtPointer)(MOD_1), delay_millisec );
-		}
+		playback_start( -1 );
 }
 
 /*===========================================================================================*/
@@ -122,7 +149,7 @@ do_backwards( int modifier )
 {
 	size_t	size;
 
-	in_timer_clear();
+	playback_stop();
 
 	if( modifier == MOD_2 ) {
 		size = view_current_nt();
@@ -146,7 +173,7 @@ do_backwards( int modifier )
 do_pause( int modifier )
 {
 	cur_button = BUTTON_PAUSE;
-	in_timer_clear();
+	playback_stop();
 }
 
 /*===========================================================================================*/
@@ -156,7 +183,7 @@ do_forward( int modifier )
 	size_t	size;
 
 	cur_button = BUTTON_PAUSE;
-	in_timer_clear();
+	playback_stop();
 
 	if( modifier == MOD_2 ) {
 		size = view_current_nt();
@@ -177,17 +204,12 @@ do_forward( int modifier )
 	void
 do_fastforward( int modifier )
 {
-	unsigned long	delay_millisec;
 	size_t	size;
 	double	d_delta;
 	int	i_delta;
 
 	cur_button = BUTTON_FASTFORWARD;
 
-	in_timer_clear();
-
-	delay_millisec = (long)(DELAY_DELTA * options.frame_delay) + DELAY_OFFSET;
-
 	if( modifier == MOD_2 ) {
 		size = view_current_nt();
 		d_delta = (double)size / 1000.0;
@@ -195,14 +217,208 @@ do_fastforward( int modifier )
 			i_delta = 10;
 		else
 			i_delta = d_delta;
-		if( change_view( i_delta, FRAMES ) == 0 )
-			in_timer_set( (XtTimerCallbackProc)do_fastforward, (XtPointer)(MOD_2), delay_millisec );
+		playback_start( i_delta );
+		}
+	else
+		playback_start( 1 );
+}
+
+/*===========================================================================================*/
+/* Returns a short description of how playback is going, such as 
+ * " (23.9 fps, 4 dropped)", or an empty string if we are not playing.
+ */
+	char *
+playback_status( void )
+{
+	static char	status[100];
+
+	status[0] = '\0';
+	if( ((cur_button == BUTTON_FASTFORWARD) || (cur_button == BUTTON_REWIND)) && (pb.fps > 0.0) ) 
+		snprintf( status, 99, " (%.1f fps, %ld dropped)", pb.fps, pb.n_dropped );
+
+	return( status );
+}
+
+/*===========================================================================================*/
+/* Starts animating, advancing 'step' frames per tick */
+	static void
+playback_start( int step )
+{
+	in_timer_clear();
+	progressive_cancel();	/* the slice being refined is about to go */
+	in_workproc_clear( WORKPROC_PLAYBACK );
+
+	pb.step      = step;
+	pb.period    = playback_period();
+	pb.t0        = util_time_msec();
+	pb.n_ticks   = 0L;
+	pb.n_shown   = 0L;
+	pb.n_dropped = 0L;
+	pb.rate_t0   = pb.t0;
+	pb.rate_n0   = 0L;
+	pb.fps       = 0.0;
+	pb.queue_n   = 0;
+
+	/* The first frame goes up right away */
+	if( change_view( step, FRAMES ) != 0 ) {
+		playback_stop();
+		return;
+		}
+	pb.n_shown++;
+
+	if( (cur_button == BUTTON_FASTFORWARD) || (cur_button == BUTTON_REWIND) ) {
+		in_timer_set( (XtTimerCallbackProc)playback_tick, NULL, (unsigned long)pb.period );
+		in_workproc_set( WORKPROC_PLAYBACK, (XtWorkProc)playback_render_ahead, NULL );
+		}
+}
+
+/*===========================================================================================*/
+	static void
+playback_stop( void )
+{
+	in_timer_clear();
+	in_workproc_clear( WORKPROC_PLAYBACK );
+	pb.queue_n = 0;
+	pb.fps     = 0.0;
+}
+
+/*===========================================================================================*/
+/* Milliseconds between frames, as set by the delay scrollbar */
+	static double
+playback_period( void )
+{
+	return( DELAY_DELTA * options.frame_delay + (double)DELAY_OFFSET );
+}
+
+/*===========================================================================================*/
+/* Display stage: show the frame that is due now, dropping any we are late for */
+	static void
+playback_tick( XtPointer client_data, XtIntervalId *id )
+{
+	double	now, period, next;
+	long	due, n_frames;
+	int	err;
+
+	if( (cur_button != BUTTON_FASTFORWARD) && (cur_button != BUTTON_REWIND) )
+		return;
+
+	now    = util_time_msec();
+	period = playback_period();
+	if( period != pb.period ) {
+		/* Speed was changed, so start a new schedule from here */
+		pb.period  = period;
+		pb.t0      = now - period;
+		pb.n_ticks = 0L;
+		}
+
+	/* Always advance at least one tick; if more are due, the frames
+	 * for the extra ones are dropped.  Frames being dumped or streamed
+	 * must all be written, so those are never dropped.
+	 */
+	due      = (long)((now - pb.t0)/pb.period);
+	n_frames = due - pb.n_ticks;
+	if( (! options.frame_drop) || options.dump_frames || (options.stream_file != NULL) ) {
+		/* Restart the schedule from this frame, as on a change of speed */
+		n_frames   = 1;
+		pb.t0      = now - pb.period;
+		pb.n_ticks = 0L;
+		}
+	else if( n_frames < 1 )
+		n_frames = 1;
+	if( n_frames > PLAYBACK_MAX_DROP+1 ) {
+		/* Hopelessly behind (or we were stopped in a dialog); 
+		 * don't skip a huge number of frames, just start over 
+		 */
+		n_frames   = PLAYBACK_MAX_DROP+1;
+		pb.t0      = now;
+		pb.n_ticks = 0L;
 		}
 	else
-		{
-		if( change_view( 1, FRAMES ) == 0 )
-			in_timer_set( (XtTimerCallbackProc)do_fastforward, (XtPointer)(MOD_1), delay_millisec );
+		pb.n_ticks += n_frames;
+	pb.n_dropped += n_frames - 1;
+
+	err = change_view( n_frames * pb.step, FRAMES );
+	pb.n_shown++;
+	playback_sync_queue();
+
+	if( now - pb.rate_t0 >= 1000.0 ) {
+		pb.fps     = (float)((pb.n_shown - pb.rate_n0)*1000.0/(now - pb.rate_t0));
+		pb.rate_t0 = now;
+		pb.rate_n0 = pb.n_shown;
+		if( options.debug )
+			printf( "playback: %.1f fps achieved (target %.1f), %ld frames dropped so far, %d queued\n",
+				pb.fps, 1000.0/pb.period, pb.n_dropped, pb.queue_n );
+		}
+
+	/* change_view can pause us, for example on restarting with -pause_on_restart */
+	if( (err != 0) || ((cur_button != BUTTON_FASTFORWARD) && (cur_button != BUTTON_REWIND)) ) {
+		playback_stop();
+		return;
+		}
+
+	next = pb.t0 + (pb.n_ticks+1)*pb.period - util_time_msec();
+	if( next < 1.0 )
+		next = 1.0;
+	in_timer_set( (XtTimerCallbackProc)playback_tick, NULL, (unsigned long)next );
+	in_workproc_set( WORKPROC_PLAYBACK, (XtWorkProc)playback_render_ahead, NULL );
+}
+
+/*===========================================================================================*/
+/* After the display moves on, drop the queue entries up to and including the 
+ * frame now showing.  If that frame was not in the queue at all (say, we 
+ * dropped past the end of the queue) the queue is no good, so empty it.
+ */
+	static void
+playback_sync_queue( void )
+{
+	long	cur;
+	int	i, j;
+
+	cur = view_current_scan_place();
+	for( i=0; i<pb.queue_n; i++ )
+		if( pb.queue[i] == cur )
+			break;
+
+	if( i == pb.queue_n ) {
+		pb.queue_n = 0;
+		return;
 		}
+
+	for( j=i+1; j<pb.queue_n; j++ )
+		pb.queue[j-i-1] = pb.queue[j];
+	pb.queue_n -= i+1;
+}
+
+/*===========================================================================================*/
+/* Render stage: an Xt work procedure, run when the interface is idle, that
+ * renders the next frame that will be displayed into the framestore.  
+ * Returns True (meaning, don't call again) once the queue is full or if
+ * frames can't be rendered ahead.
+ */
+	static Boolean
+playback_render_ahead( XtPointer client_data )
+{
+	long	last, next;
+
+	if( (cur_button != BUTTON_FASTFORWARD) && (cur_button != BUTTON_REWIND) )
+		return( True );
+
+	if( pb.queue_n >= PLAYBACK_QUEUE_LEN )
+		return( True );
+
+	if( pb.queue_n == 0 )
+		last = view_current_scan_place();
+	else
+		last = pb.queue[pb.queue_n-1];
+	next = view_next_scan_place( last, pb.step );
+	if( next < 0 )
+		return( True );
+
+	if( view_prerender_frame( (size_t)next ) != 0 )
+		return( True );
+
+	pb.queue[pb.queue_n++] = next;
+	return( pb.queue_n >= PLAYBACK_QUEUE_LEN );
 }
 		
 /*===========================================================================================*/
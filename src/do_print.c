@@ -102,7 +102,7 @@ do_print( void )
 	FILE	*outf;
 	float	output_scale;
 	int	r, g, b, n_print;
-	ncv_pixel pix;
+	ncv_pixel pix, *pixels;
 
 #ifdef DEBUG
 	fprintf( stderr, "entering do_print()\n" );
@@ -160,10 +160,15 @@ do_print( void )
 	/***** dump out the color image *****/
 	if( ! printopts.test_only ) {
 		view_draw( FALSE, FALSE ); /* Don't allow saveframes -- force reload of image data */
+		if( (pixels = view_whole_image()) == NULL ) {
+			fclose( outf );
+			in_set_cursor_normal();
+			return;
+			}
 		n_print = 0;
 		for( j=0; j<scaled_y_size; j++ ) {
 			for( i=0; i<scaled_x_size; i++ ) {
-				pix = *(view->pixels + j*scaled_x_size + i);
+				pix = *(pixels + j*scaled_x_size + i);
 				pix_to_rgb( pix, &r, &g, &b );
 				fprintf( outf, "%02x%02x%02x", (r>>8), (g>>8), (b>>8)); 
 				n_print += 6;
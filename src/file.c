@@ -41,7 +41,10 @@ static int   file_type;
 extern NCVar *variables;
 extern Options options;
 
-static void fi_get_data_iterate( NCVar *var, size_t *virt_start_pos, size_t *count, void *data );
+static void fi_get_data_iterate( NCVar *var, size_t *virt_start_pos, size_t *count, ptrdiff_t *stride, void *data );
+#ifdef HAVE_UDUNITS2
+static int  fi_dim_value_convert_cal( double dimval, double *converted_dimval, FDBlist *file, NCVar *var, NCDim *d );
+#endif
 
 /************************************************************************************/
 /* return TRUE if passed the name of a file which these routines were designed
@@ -79,8 +82,35 @@ fi_writable( char *name )
 	int
 fi_initialize( char *name, int nfiles )
 {
-	int	id;
+	int	id, k, recvals;
 	Stringlist *var_list;
+	unsigned long long fingerprint;
+	size_t	rec_len;
+	double	rec_first, rec_step;
+
+	/* The first file, which later files are compared against */
+	static int		schema_have = FALSE;
+	static unsigned long long schema_fingerprint;
+	static Stringlist	*schema_var_list;
+
+	TRACE_BEGIN( "fi_initialize", name );
+
+	/* A file from a manifest that has the same schema as the first file
+	 * isn't opened until something has to be read from it
+	 */
+	k = manifest_member( name, &rec_len, &fingerprint );
+	if( schema_have && (k >= 0) && (fingerprint == schema_fingerprint) ) {
+		id = FI_ID_LAZY - k;
+		ncfile_add( name, id, rec_len );
+		add_vars_to_list_same_schema( schema_var_list, id, name );
+		if( options.write_manifest != NULL ) {
+			recvals = manifest_member_recvals( k, &rec_first, &rec_step );
+			manifest_note_file( name, rec_len, fingerprint, manifest_member_units( k ),
+				recvals, rec_first, rec_step );
+			}
+		TRACE_END( "fi_initialize" );
+		return( id );
+		}
 
 	if( file_type == FILE_TYPE_NETCDF ) {
 		if( options.debug ) 
@@ -94,14 +124,36 @@ fi_initialize( char *name, int nfiles )
 		exit( -1 );
 		}
 
-	if( options.debug ) 
-		printf( "Getting list of variables for file %s\n", name );
-	var_list = fi_list_vars( id );
-	add_vars_to_list( var_list, id, name, nfiles );
+	/* A file that looks just like the first one has the same vars, of the
+	 * same shapes apart from the record dimension, so there is no need to
+	 * go through it var by var
+	 */
+	fingerprint = fi_schema_fingerprint( id, &rec_len );
+	ncfile_add( name, id, rec_len );
+	if( schema_have && (fingerprint == schema_fingerprint) )
+		add_vars_to_list_same_schema( schema_var_list, id, name );
+	else
+		{
+		if( options.debug ) 
+			printf( "Getting list of variables for file %s\n", name );
+		var_list = fi_list_vars( id );
+		add_vars_to_list( var_list, id, name, nfiles );
+		if( ! schema_have ) {
+			schema_have        = TRUE;
+			schema_fingerprint = fingerprint;
+			schema_var_list    = var_list;
+			}
+		}
+	if( options.write_manifest != NULL ) {
+		recvals = netcdf_fi_recdim_values( id, rec_len, &rec_first, &rec_step );
+		manifest_note_file( name, rec_len, fingerprint, fi_recdim_units( id, NULL ),
+			recvals, rec_first, rec_step );
+		}
 	
 	if( options.debug ) 
 		printf( "Done initializing file %s\n", name );
 
+	TRACE_END( "fi_initialize" );
 	return( id );
 }	
 
@@ -305,6 +357,17 @@ fi_dim_name_to_id( int fileid, char *var_name, char *dim_name )
  */
 	void
 fi_get_data( NCVar *var, size_t *virt_start_pos, size_t *count, void *data )
+{
+	fi_get_data_strided( var, virt_start_pos, count, NULL, data );
+}
+
+/************************************************************************************/
+/* Same as fi_get_data, but only gets every stride[i]'th point along each
+ * dimension (stride can be NULL to get them all).  count[i] is the number
+ * of points to get, so the data array needs to hold the product of the counts.
+ */
+	void
+fi_get_data_strided( NCVar *var, size_t *virt_start_pos, size_t *count, ptrdiff_t *stride, void *data )
 {
 	size_t	*act_start_pos;
 	FDBlist	*file;
@@ -312,7 +375,7 @@ fi_get_data( NCVar *var, size_t *virt_start_pos, size_t *count, void *data )
 	/* Check to see if we should loop over the timelike indices
 	 */
 	if( (var->is_virtual == TRUE) && (count[0] > 1) ) {
-		fi_get_data_iterate( var, virt_start_pos, count, data );
+		fi_get_data_iterate( var, virt_start_pos, count, stride, data );
 		return;
 		}
 		
@@ -325,8 +388,8 @@ fi_get_data( NCVar *var, size_t *virt_start_pos, size_t *count, void *data )
 	virt_to_actual_place( var, virt_start_pos, act_start_pos, &file );
 
 	if( file_type == FILE_TYPE_NETCDF )
-		netcdf_fi_get_data( file->id, var->name, act_start_pos, 
-			  count, data, (NetCDFOptions *)var->first_file->aux_data );
+		netcdf_fi_get_data_strided( fi_fdb_id( file ), var->name, act_start_pos, 
+			  count, stride, data, (NetCDFOptions *)var->first_file->aux_data );
 	else
 		{
 		fprintf( stderr, "?unknown file_type passed to fi_get_data: %d\n",
@@ -342,9 +405,9 @@ fi_get_data( NCVar *var, size_t *virt_start_pos, size_t *count, void *data )
  * want data from more than one file.  We must iterate over the files.
  */
 	void
-fi_get_data_iterate( NCVar *var, size_t *virt_start_pos, size_t *count, void *data )
+fi_get_data_iterate( NCVar *var, size_t *virt_start_pos, size_t *count, ptrdiff_t *stride, void *data )
 {
-	size_t	it, *act_start_pos, start2[20], count2[20], prod_lower_dims;
+	size_t	n, it, it_step, *act_start_pos, start2[20], count2[20], prod_lower_dims;
 	FDBlist	*file;
 	int	i;
 
@@ -362,13 +425,15 @@ fi_get_data_iterate( NCVar *var, size_t *virt_start_pos, size_t *count, void *da
 		prod_lower_dims *= count[i];
 		}
 
+	it_step = (stride == NULL) ? 1L : stride[0];
 	count2[0] = 1L;
-	for( it=virt_start_pos[0]; it<(virt_start_pos[0]+count[0]); it++ ) {
+	for( n=0; n<count[0]; n++ ) {
+		it = virt_start_pos[0] + n*it_step;
 		start2[0] = it;
 		virt_to_actual_place( var, start2, act_start_pos, &file );
 		if( file_type == FILE_TYPE_NETCDF )
-			netcdf_fi_get_data( file->id, var->name, act_start_pos, 
-				  count2, ((float *)data)+it*prod_lower_dims, 
+			netcdf_fi_get_data_strided( fi_fdb_id( file ), var->name, act_start_pos, 
+				  count2, stride, ((float *)data)+n*prod_lower_dims, 
 				  	(NetCDFOptions *)var->first_file->aux_data );
 		else
 			{
@@ -418,9 +483,7 @@ fi_dim_longname( int fileid, char *dim_name )
 void fi_dim_value_convert( double *dimval, FDBlist *file, NCVar *var, NCDim *d )
 {
 #ifdef HAVE_UDUNITS2
-	double converted_dimval;
-	int	year0, month0, hour0, min0, day0, err;
-	double	sec0;
+	double	x0, v0, v1, v2;
 
 	if( (file->recdim_units 	   == NULL) ||
 	    (var->first_file->recdim_units == NULL) ||
@@ -430,20 +493,64 @@ void fi_dim_value_convert( double *dimval, FDBlist *file, NCVar *var, NCDim *d )
 	    (strcmp(file->recdim_units,var->first_file->recdim_units) == 0) ) 
 	    	return;
 
+	/* Going from something like "hours since A" to "days since B" is
+	 * just a scale and an offset, so we work those out the first time
+	 * through for this file instead of going through the calendar for
+	 * every value.  If a third value doesn't come out the same both
+	 * ways, the units aren't like that, and each value goes through the
+	 * calendar as before.
+	 */
+	if( file->recdim_conv == 0 ) {
+		file->recdim_conv = -1;
+		x0 = *dimval;
+		if( (fi_dim_value_convert_cal( x0,        &v0, file, var, d ) == 0) &&
+		    (fi_dim_value_convert_cal( x0+1000.0, &v1, file, var, d ) == 0) &&
+		    (fi_dim_value_convert_cal( x0-1000.0, &v2, file, var, d ) == 0) ) {
+			file->recdim_scale  = (v1 - v0)/1000.0;
+			file->recdim_offset = v0 - x0*file->recdim_scale;
+			if( fabs( (file->recdim_offset + (x0-1000.0)*file->recdim_scale) - v2 ) <= 1.e-6*fabs(v1 - v0) )
+				file->recdim_conv = 1;
+			}
+		if( options.debug )
+			printf( "fi_dim_value_convert: %s to %s for %s is %s\n", file->recdim_units,
+				var->first_file->recdim_units, file->filename,
+				(file->recdim_conv == 1) ? "linear" : "done value by value" );
+		}
+
+	if( file->recdim_conv == 1 )
+		*dimval = file->recdim_offset + *dimval * file->recdim_scale;
+	else
+		fi_dim_value_convert_cal( *dimval, dimval, file, var, d );
+#endif
+}
+
+#ifdef HAVE_UDUNITS2
+/**************************************************************************************
+ * Puts dimval, in the recdim units of 'file', into converted_dimval in the recdim
+ * units of the var's first file by way of the calendar date.  Returns 0 on success,
+ * in which case converted_dimval is set; otherwise it is untouched.
+ */
+	static int
+fi_dim_value_convert_cal( double dimval, double *converted_dimval, FDBlist *file, NCVar *var, NCDim *d )
+{
+	int	year0, month0, hour0, min0, day0, err;
+	double	sec0, cval;
+
 	/* Convert the dim value to a date using the units given 
 	 * in the file that this dim value came from
 	 */
-	err = utCalendar2_cal( *dimval, file->recdim_units, 
+	err = utCalendar2_cal( dimval, file->recdim_units, 
 		&year0, &month0, &day0, &hour0, &min0, &sec0, d->calendar );
 	if( err == 0 ) {
 		err = utInvCalendar2_cal( year0, month0, day0, hour0, min0, sec0, 
-			var->first_file->recdim_units, &converted_dimval,
+			var->first_file->recdim_units, &cval,
 			d->calendar );
 		if( err == 0 ) 
-			*dimval = converted_dimval;
+			*converted_dimval = cval;
 		}
-#endif
+	return( err );
 }
+#endif
 
 /*************************************************************************************
  * Return the value of a dimension at a specific point.  Returns the type
@@ -475,8 +582,8 @@ for( i=0; i<var->n_dims; i++ ) {
 	else
 		printf( "(%s) %f %f %f\n", 
 			var->dim_map_info[i]->coord_var_name,
-			var->dim_map_info[i]->data_cache[0], var->dim_map_info[i]->data_cache[10],
-			var->dim_map_info[i]->data_cache[100] );
+			dim_map_data( var->dim_map_info[i] )[0], dim_map_data( var->dim_map_info[i] )[10],
+			dim_map_data( var->dim_map_info[i] )[100] );
 	}
 }
 
@@ -489,7 +596,7 @@ for( i=0; i<var->n_dims; i++ ) {
 			idx_map += complete_ndim_virt_place[i] * dmi->index_place_factor[i];
 /*printf( "dimidx=%d  place=%ld  factor=%ld  idx_so_far=%ld\n", i, complete_ndim_virt_place[i], dmi->index_place_factor[i], idx_map );*/
 			}
-		*return_val_double = dmi->data_cache[idx_map];
+		*return_val_double = dim_map_data( dmi )[idx_map];
 /*printf( "mapped, dim=%s loc=%ld  val=%lf\n", var->dim[dim_id]->name, idx_map, *return_val_double );*/
 		return( NC_DOUBLE );
 		}
@@ -518,7 +625,7 @@ for( i=0; i<var->n_dims; i++ ) {
 	d = (*(var->dim+dim_id));
 	dim_name  = d->name;
 	if( file_type == FILE_TYPE_NETCDF )
-		ret_val = netcdf_dim_value( file->id, dim_name, actual_place, 
+		ret_val = netcdf_dim_value( fi_fdb_id( file ), dim_name, actual_place, 
 				return_val_double, return_val_char, virt_place,
 				return_has_bounds, return_bounds_min, return_bounds_max );
 	else
@@ -537,14 +644,77 @@ for( i=0; i<var->n_dims; i++ ) {
 	 */
 	if( ret_val != NC_CHAR) {
 		fi_dim_value_convert( return_val_double, file, var, d );
-		fi_dim_value_convert( return_bounds_min, file, var, d );
-		fi_dim_value_convert( return_bounds_max, file, var, d );
+		if( *return_has_bounds ) {
+			fi_dim_value_convert( return_bounds_min, file, var, d );
+			fi_dim_value_convert( return_bounds_max, file, var, d );
+			}
 		}
 #endif
 
 	return( ret_val );
 }
 
+/*************************************************************************************
+ * Fills 'values' with all the values of dimension dim_id of var, the same as
+ * calling fi_dim_value for each place in turn would give, but reading the
+ * values in each file in one go.  Returns NC_DOUBLE, or NC_CHAR if the dim
+ * has character values, in which case 'values' is not filled out.  Can't be
+ * used on 2-d mapped dims.  Files from a manifest that haven't been opened
+ * are left that way if the manifest says what their record values are.
+ */
+	nc_type
+fi_dim_values( NCVar *var, int dim_id, double *values )
+{
+	FDBlist	*file;
+	NCDim	*d;
+	size_t	size, virt_start, count, j;
+	int	recvals;
+	double	rec_first, rec_step;
+
+	if( file_type != FILE_TYPE_NETCDF ) {
+		fprintf( stderr, "?unknown file_type passed to fi_dim_values: %d\n",
+			file_type );
+		exit( -1 );
+		}
+	if( var->dim_map_info[dim_id] != NULL ) {
+		fprintf( stderr, "ncview: fi_dim_values: internal error, called for 2-d mapped dim %d of var %s\n",
+			dim_id, var->name );
+		exit( -1 );
+		}
+
+	d    = *(var->dim+dim_id);
+	size = *(var->size+dim_id);
+
+	/* Only the first dim is spread across the files */
+	virt_start = 0L;
+	for( file=var->first_file; (file != NULL) && (virt_start < size); file=file->next ) {
+		count = (dim_id == 0) ? *(file->var_size) : size;
+		if( virt_start + count > size )
+			count = size - virt_start;
+		recvals = RECVALS_UNKNOWN;
+		if( (dim_id == var->recdim_index) && (! fi_fdb_is_open( file )) )
+			recvals = manifest_member_recvals( FI_ID_LAZY - file->id, &rec_first, &rec_step );
+		if( recvals == RECVALS_EVEN ) {
+			for( j=0; j<count; j++ )
+				values[virt_start+j] = rec_first + (double)j * rec_step;
+			}
+		else if( recvals == RECVALS_INDEX ) {
+			for( j=0; j<count; j++ )
+				values[virt_start+j] = (double)(virt_start+j);
+			}
+		else if( netcdf_dim_values( fi_fdb_id( file ), d->name, 0L, count, virt_start,
+				values+virt_start ) == NC_CHAR )
+			return( NC_CHAR );
+#ifdef HAVE_UDUNITS2
+		for( j=0; j<count; j++ )
+			fi_dim_value_convert( values+virt_start+j, file, var, d );
+#endif
+		virt_start += count;
+		}
+
+	return( NC_DOUBLE );
+}
+
 /*************************************************************************************
  * Does this data file have *values* for the dimensions?
  */
@@ -638,3 +808,63 @@ fi_recdim_id( int fileid )
 {
 	return( netcdf_fi_recdim_id( fileid ));
 }
+
+/************************************************************************************
+ * Returns which of the var's dims is the record dimension, or -1 if none is.
+ */
+	int
+fi_var_recdim_index( int fileid, char *var_name )
+{
+	return( netcdf_fi_var_recdim_index( fileid, var_name ));
+}
+
+/************************************************************************************
+ * Returns the units of the record dimension seen by the var in this file, or
+ * NULL if there are none.  If var_name is NULL, returns the units of the
+ * file's record dimension.  Files from a manifest that haven't been opened
+ * have the units given in the manifest.
+ */
+	char *
+fi_recdim_units( int fileid, char *var_name )
+{
+	if( fileid <= FI_ID_LAZY )
+		return( manifest_member_units( FI_ID_LAZY - fileid ));
+	return( netcdf_fi_recdim_units( fileid, var_name ));
+}
+
+/************************************************************************************
+ * Returns the id to read the file in fdb with.  Files from a manifest are
+ * opened the first time this is called for them.  Note that fdb->id itself
+ * stays as it is, so the fdbs of different vars in the same file can still
+ * be compared by id.
+ */
+	int
+fi_fdb_id( FDBlist *fdb )
+{
+	if( fdb->id > FI_ID_LAZY )
+		return( fdb->id );
+	return( manifest_member_id( FI_ID_LAZY - fdb->id ));
+}
+
+/************************************************************************************
+ * Returns TRUE if the file in fdb has been opened (see fi_fdb_id)
+ */
+	int
+fi_fdb_is_open( FDBlist *fdb )
+{
+	if( fdb->id > FI_ID_LAZY )
+		return( TRUE );
+	return( manifest_member_is_open( FI_ID_LAZY - fdb->id ));
+}
+
+/************************************************************************************
+ * Returns a fingerprint of the file's schema: its vars, their types and
+ * shapes, and the attributes that affect how their data is read, but not
+ * the length of the record dimension, which is put in rec_len.  Files with
+ * the same fingerprint differ only in the length of the record dimension.
+ */
+	unsigned long long
+fi_schema_fingerprint( int fileid, size_t *rec_len )
+{
+	return( netcdf_fi_schema_fingerprint( fileid, rec_len ));
+}
@@ -288,6 +288,134 @@ Stringlist *netcdf_fi_list_vars( int fileid )
 	return( retval );
 }
 
+/*******************************************************************************************
+ * Adds what we need to know about the vars in this group, and the groups under it, to
+ * the schema fingerprint h.  The length of the record dimension recdim is left out,
+ * since that is what differs between files that otherwise look the same.
+ */
+static unsigned long long netcdf_schema_hash_group( unsigned long long h, int gid, int recdim )
+{
+	int	err, i, j, n_dims, n_vars, n_gatts, rec_dim, n_var_dims, n_atts, dim[MAX_VAR_DIMS],
+		n_groups, *grp_id;
+	char	name[MAX_NC_NAME+1], *att_buf;
+	nc_type	type, att_type;
+	size_t	dim_len, att_len, type_size;
+	long long	rec_marker;
+	static char *atts[] = { "scale_factor", "add_offset", "_FillValue", "missing_value",
+				"valid_min", "valid_max", "valid_range", NULL };
+
+	err = nc_inq( gid, &n_dims, &n_vars, &n_gatts, &rec_dim );
+	if( err != NC_NOERR ) {
+		fprintf( stderr, "netcdf_fi_schema_fingerprint: error on nc_inq, cdfid=%d\n", gid );
+		exit( -1 );
+		}
+	h = util_hash_bytes( h, &n_vars, sizeof(int) );
+
+	rec_marker = -1LL;
+	for( i=0; i<n_vars; i++ ) {
+		err = nc_inq_var( gid, i, name, &type, &n_var_dims, dim, &n_atts );
+		if( err != NC_NOERR ) {
+			fprintf( stderr, "netcdf_fi_schema_fingerprint: error on nc_inq_var, cdfid=%d varid=%d\n", gid, i );
+			exit( -1 );
+			}
+		h = util_hash_bytes( h, name, strlen(name)+1 );
+		h = util_hash_bytes( h, &type, sizeof(nc_type) );
+		h = util_hash_bytes( h, &n_var_dims, sizeof(int) );
+
+		for( j=0; j<n_var_dims; j++ ) {
+			err = nc_inq_dim( gid, dim[j], name, &dim_len );
+			if( err != NC_NOERR ) {
+				fprintf( stderr, "netcdf_fi_schema_fingerprint: error on nc_inq_dim, cdfid=%d\n", gid );
+				exit( -1 );
+				}
+			h = util_hash_bytes( h, name, strlen(name)+1 );
+			if( dim[j] == recdim )
+				h = util_hash_bytes( h, &rec_marker, sizeof(long long) );
+			else
+				h = util_hash_bytes( h, &dim_len, sizeof(size_t) );
+			}
+
+		/* The attributes that set how the data is unpacked and which of it is valid */
+		for( j=0; atts[j] != NULL; j++ ) {
+			if( nc_inq_att( gid, i, atts[j], &att_type, &att_len ) != NC_NOERR )
+				continue;
+			h = util_hash_bytes( h, atts[j], strlen(atts[j])+1 );
+			h = util_hash_bytes( h, &att_type, sizeof(nc_type) );
+			h = util_hash_bytes( h, &att_len,  sizeof(size_t) );
+			if( (nc_inq_type( gid, att_type, NULL, &type_size ) != NC_NOERR) || (att_len == 0) )
+				continue;
+			att_buf = (char *)malloc( att_len * type_size );
+			if( att_buf == NULL ) {
+				fprintf( stderr, "netcdf_fi_schema_fingerprint: failed to allocate %ld bytes\n",
+					(long)(att_len*type_size) );
+				exit( -1 );
+				}
+			if( nc_get_att( gid, i, atts[j], att_buf ) == NC_NOERR )
+				h = util_hash_bytes( h, att_buf, att_len * type_size );
+			free( att_buf );
+			}
+		}
+
+	err = nc_inq_grps( gid, &n_groups, NULL );
+	if( err != NC_NOERR ) {
+		fprintf( stderr, "netcdf_fi_schema_fingerprint: error on nc_inq_grps, cdfid=%d: %s\n", 
+			gid, nc_strerror(err) );
+		exit( -1 );
+		}
+	h = util_hash_bytes( h, &n_groups, sizeof(int) );
+	if( n_groups == 0 )
+		return( h );
+
+	grp_id = (int *)malloc( sizeof(int) * n_groups );
+	err = nc_inq_grps( gid, &n_groups, grp_id );
+	for( i=0; i<n_groups; i++ ) {
+		if( nc_inq_grpname( grp_id[i], name ) == NC_NOERR )
+			h = util_hash_bytes( h, name, strlen(name)+1 );
+		h = netcdf_schema_hash_group( h, grp_id[i], recdim );
+		}
+	free( grp_id );
+
+	return( h );
+}
+
+/*******************************************************************************************
+ * Returns a hash of the file's variable names and types, their dimensions and the
+ * lengths of all but the record dimension, and the attributes that affect how the
+ * data is read.  Two files with the same fingerprint have the same displayable vars,
+ * with the same shapes apart from the record dimension, so the second does not have
+ * to be gone through var by var.  The length of the record dimension (0 if there
+ * isn't one) is returned in rec_len.  Whether it is 0, 1, or more is part of the
+ * fingerprint, since that decides which vars are displayable.
+ */
+unsigned long long netcdf_fi_schema_fingerprint( int fileid, size_t *rec_len )
+{
+	int			recdim, err, rec_class;
+	unsigned long long	h;
+
+	*rec_len = 0L;
+	recdim = netcdf_fi_recdim_id( fileid );
+	if( recdim != -1 ) {
+		err = nc_inq_dimlen( fileid, recdim, rec_len );
+		if( err != NC_NOERR ) {
+			fprintf( stderr, "netcdf_fi_schema_fingerprint: error getting record dim length: %s\n",
+				nc_strerror( err ));
+			exit( -1 );
+			}
+		}
+	rec_class = (*rec_len > 1L) ? 2 : (int)(*rec_len);
+
+	h = UTIL_HASH_INIT;
+	h = util_hash_bytes( h, &recdim,    sizeof(int) );
+	h = util_hash_bytes( h, &rec_class, sizeof(int) );
+	h = netcdf_schema_hash_group( h, fileid, recdim );
+
+	if( options.debug )
+		printf( "netcdf_fi_schema_fingerprint: file %d has fingerprint %016llx, record length %ld\n",
+			fileid, h, (long)(*rec_len) );
+
+	return( h );
+}
+
 /*******************************************************************************************/
 Stringlist *netcdf_scannable_dims( int fileid, char *var_name )
 {
@@ -583,6 +711,17 @@ int netcdf_dim_name_to_id( int fileid, char *var_name, char *dim_name )
  */
 void netcdf_fi_get_data( int fileid, char *var_name, size_t *start_pos, 
 		size_t *count, float *data, NetCDFOptions *aux_data )
+{
+	netcdf_fi_get_data_strided( fileid, var_name, start_pos, count, NULL, data, aux_data );
+}
+
+/*******************************************************************************************
+ * Same as netcdf_fi_get_data, but only reads every stride[i]'th point along
+ * each dimension; count[i] is the number of points read, not the extent.
+ * If stride is NULL, this is an ordinary contiguous read.
+ */
+void netcdf_fi_get_data_strided( int fileid, char *var_name, size_t *start_pos, 
+		size_t *count, ptrdiff_t *stride, float *data, NetCDFOptions *aux_data )
 {
 	int	err, varid, gid, debug, do_scale, do_offset;
 	char	var_name_ng[MAX_NC_NAME];
@@ -613,16 +752,20 @@ void netcdf_fi_get_data( int fileid, char *var_name, size_t *start_pos,
 
 
 	if( options.debug ) {
-		fprintf( stderr, "About to call nc_get_vara_float on variable %s\n",
-				var_name );
+		fprintf( stderr, "About to call nc_get_var%s_float on variable %s\n",
+				(stride == NULL) ? "a" : "s", var_name );
 		fprintf( stderr, "Index, start, count:\n" );
 		for( i=0; i<netcdf_fi_n_dims(fileid, var_name); i++ )
 			fprintf( stderr, "[%ld]: %ld %ld\n", i, *(start_pos+i), *(count+i) );
 		}
 
-	err = nc_get_vara_float( gid, varid, start_pos, count, data );
+	if( stride == NULL )
+		err = nc_get_vara_float( gid, varid, start_pos, count, data );
+	else
+		err = nc_get_vars_float( gid, varid, start_pos, count, stride, data );
 	if( err != NC_NOERR ) {
-		fprintf( stderr, "netcdf_fi_get_data: error on nc_get_vara_float call\n" );
+		fprintf( stderr, "netcdf_fi_get_data: error on nc_get_var%s_float call\n",
+				(stride == NULL) ? "a" : "s" );
 		fprintf( stderr, "cdfid=%d   variable=%s\n", fileid, var_name );
 		fprintf( stderr, "start, count:\n" );
 		for( i=0; i<netcdf_fi_n_dims(fileid, var_name); i++ )
@@ -722,6 +865,35 @@ void netcdf_fi_close( int fileid )
 		}
 }
 
+/*******************************************************************************************
+ * Returns the current size of the variable in a file that is open, but that
+ * someone else may be adding to.  A netCDF-3 file reads its header again on
+ * nc_sync, which is all we need; netCDF-4 (HDF5) files won't show data added
+ * since we opened them, so for those we have to open the file over again.
+ */
+size_t * netcdf_fi_var_size_now( int fileid, char *filename, char *var_name )
+{
+	int	err, format, t_ncid;
+	size_t	*ret_val;
+
+	err = nc_inq_format( fileid, &format );
+#ifdef NC_FORMAT_NETCDF4
+	if( (err == NC_NOERR) && (format != NC_FORMAT_NETCDF4) && (format != NC_FORMAT_NETCDF4_CLASSIC) ) {
+#else
+	if( err == NC_NOERR ) {
+#endif
+		err = nc_sync( fileid );
+		if( err == NC_NOERR )
+			return( netcdf_fi_var_size( fileid, var_name ));
+		}
+
+	t_ncid  = netcdf_fi_initialize( filename );
+	ret_val = netcdf_fi_var_size( t_ncid, var_name );
+	netcdf_fi_close( t_ncid );
+
+	return( ret_val );
+}
+
 /****************************************************************************************/
 /* netCDF utility routines.  Analogs are not required for each data file format.	*/
 /****************************************************************************************/
@@ -1375,13 +1547,256 @@ nc_type netcdf_dim_value( int fileid, char *dim_name, size_t place,
 	return( ret_type );
 }
 
+/*******************************************************************************************/
+/* Reads 'count' values of the dim starting at 'place' in one go, putting them in
+ * ret_vals, with the same treatment as netcdf_dim_value gives each one.  If the
+ * values are characters, nothing is read and NC_CHAR is returned; otherwise
+ * NC_DOUBLE is returned.  virt_place is the virtual place of the first value.
+ */
+nc_type netcdf_dim_values( int fileid, char *dim_name, size_t place, size_t count,
+		size_t virt_place, double *ret_vals )
+{
+	int	err, dimvar_id, nvertices, dimvar_gid, n_dims, n_atts, dim[MAX_VAR_DIMS],
+		dimvar_bounds_id, k;
+	char	var_name[MAX_NC_NAME];
+	nc_type type;
+	size_t	i, bstart[2], bcount[2];
+	double	*boundvals;
+
+	if( count == 0 )
+		return( NC_DOUBLE );
+
+	dimvar_id = -1;
+	if( netcdf_has_dim_values( fileid, dim_name ) )
+		dimvar_id = netcdf_dimvar_id( fileid, dim_name, &dimvar_gid );
+	if( dimvar_id < 0 ) {
+		for( i=0; i<count; i++ )
+			ret_vals[i] = (double)(virt_place+i);
+		return( NC_DOUBLE );
+		}
+
+	err = nc_inq_var( dimvar_gid, dimvar_id, var_name, &type, &n_dims, dim, &n_atts );
+	if( err != NC_NOERR ) {
+		fprintf( stderr, "netcdf_dim_values: failed on nc_inq_var call!\n" );
+		exit(-1);
+		}
+	switch( type ) {
+		case NC_CHAR:
+			return( NC_CHAR );
+
+		case NC_BYTE:
+		case NC_SHORT:
+		case NC_LONG:
+		case NC_FLOAT:
+		case NC_DOUBLE:
+		case NC_INT64:
+			dimvar_bounds_id = netcdf_dimvar_bounds_id( dimvar_gid, dim_name, &nvertices );
+			if( dimvar_bounds_id < 0 ) { 
+				err = nc_get_vara_double( dimvar_gid, dimvar_id, &place, &count, ret_vals );
+				if( err != NC_NOERR ) {	
+					fprintf( stderr, "Error reading values of dim %s from file!\n", dim_name );
+					fprintf( stderr, "%s\n", nc_strerror( err ) );
+					exit(-1);
+					}
+				}
+			else
+				{
+				/* As in netcdf_dim_value, the value is the mean of the bounds */
+				boundvals = (double *)malloc( count*nvertices*sizeof(double) );
+				if( boundvals == NULL ) {
+					fprintf( stderr, "netcdf_dim_values: failed to allocate space for %ld bounds\n",
+						(long)(count*nvertices) );
+					exit(-1);
+					}
+				bstart[0] = place;
+				bstart[1] = 0L;
+				bcount[0] = count;
+				bcount[1] = nvertices;
+				err = nc_get_vara_double( dimvar_gid, dimvar_bounds_id, bstart, bcount, boundvals );
+				if( err != NC_NOERR ) {	
+					fprintf( stderr, "Error reading boundary dim values from file!\n" );
+					fprintf( stderr, "%s\n", nc_strerror( err ) );
+					exit(-1);
+					}
+				for( i=0; i<count; i++ ) {
+					ret_vals[i] = 0.0;
+					for( k=0; k<nvertices; k++ )
+						ret_vals[i] += boundvals[i*nvertices+k];
+					ret_vals[i] /= (double)nvertices;
+					}
+				free( boundvals );
+				}
+			return( NC_DOUBLE );
+
+		default:
+			for( i=0; i<count; i++ )
+				ret_vals[i] = (double)(virt_place+i);
+			return( NC_DOUBLE );
+		}
+}
+
+/*******************************************************************************************
+ * Returns the units of the record dimension as seen by the passed var, or NULL if there
+ * is no record dimension or it has no units.  var_name can have group names prepended.
+ * If var_name is NULL, returns the units of the record dimension of the group 'id'.
+ */
+char *netcdf_fi_recdim_units( int id, char *var_name )
+{
+	int	err, varid, unlimdimvar_id, recdim_id, gid;
+	char	unlimdim_name[MAX_NC_NAME];
+
+	gid = id;
+	if( var_name != NULL ) {
+		err = nc_inq_varid_grp( id, var_name, &varid, &gid );
+		if( err != NC_NOERR ) {
+			fprintf( stderr, "Error in netcdf_fi_recdim_units: could not find var named \"%s\" in file!\n",
+				var_name );
+			exit(-1);
+			}
+		}
+
+	recdim_id = netcdf_fi_recdim_id( gid );
+	if( recdim_id == -1 ) 
+		return( NULL );
+
+	/* Get NAME of the record dimension */
+	err = nc_inq_dimname( gid, recdim_id, unlimdim_name );
+	if( err != 0 ) {
+		fprintf( stderr, "Error in netcdf_fi_recdim_units: could not get recdim name\n%s\n",
+			nc_strerror( err ));
+		exit(-1);
+		}
+
+	/* See if there is a variable with the same name */
+	err = nc_inq_varid( gid, unlimdim_name, &unlimdimvar_id );
+	if( err != 0 ) 
+		return( NULL );
+
+	/* Get the units for the dimvar. Note: can be NULL */
+	return( netcdf_var_units( gid, unlimdim_name ));
+}
+
+/*******************************************************************************************
+ * Says what the values of the root group's record dimension, which is rec_len long, are
+ * like, for manifests: RECVALS_EVEN if they go evenly from 'first' by 'step', 
+ * RECVALS_INDEX if netcdf_dim_value gives the place for them, and RECVALS_UNKNOWN
+ * otherwise.
+ */
+int netcdf_fi_recdim_values( int id, size_t rec_len, double *first, double *step )
+{
+	int	err, recdim_id, dimvar_id, dimvar_gid, ret_val;
+	char	recdim_name[MAX_NC_NAME];
+	nc_type	type;
+	double	*vals;
+	size_t	j;
+
+	recdim_id = netcdf_fi_recdim_id( id );
+	if( recdim_id == -1 ) 
+		return( RECVALS_UNKNOWN );
+
+	err = nc_inq_dimname( id, recdim_id, recdim_name );
+	if( err != 0 ) {
+		fprintf( stderr, "Error in netcdf_fi_recdim_values: could not get recdim name\n%s\n",
+			nc_strerror( err ));
+		exit(-1);
+		}
+
+	if( ! netcdf_has_dim_values( id, recdim_name ))
+		return( RECVALS_INDEX );
+	dimvar_id = netcdf_dimvar_id( id, recdim_name, &dimvar_gid );
+	if( dimvar_id < 0 )
+		return( RECVALS_INDEX );
+
+	err = nc_inq_vartype( dimvar_gid, dimvar_id, &type );
+	if( err != NC_NOERR ) {
+		fprintf( stderr, "Error in netcdf_fi_recdim_values: could not get type of %s\n%s\n",
+			recdim_name, nc_strerror( err ));
+		exit(-1);
+		}
+	switch( type ) {
+		case NC_BYTE:
+		case NC_SHORT:
+		case NC_LONG:
+		case NC_FLOAT:
+		case NC_DOUBLE:
+		case NC_INT64:
+			break;
+
+		case NC_CHAR:
+			return( RECVALS_UNKNOWN );
+
+		default:
+			return( RECVALS_INDEX );	/* see netcdf_dim_value */
+		}
+
+	*first = 0.0;
+	*step  = 0.0;
+	if( rec_len == 0 )
+		return( RECVALS_EVEN );
+
+	vals = (double *)malloc( rec_len*sizeof(double) );
+	if( vals == NULL ) {
+		fprintf( stderr, "netcdf_fi_recdim_values: failed to allocate space for %ld values\n",
+			(long)rec_len );
+		exit(-1);
+		}
+	netcdf_dim_values( id, recdim_name, 0L, rec_len, 0L, vals );
+
+	*first = vals[0];
+	if( rec_len > 1 )
+		*step = (vals[rec_len-1] - vals[0])/(double)(rec_len-1);
+	ret_val = RECVALS_EVEN;
+	for( j=1; j<rec_len; j++ )
+		if( fabs( vals[j] - (*first + (double)j * *step) ) > 1.e-6*fabs(*step) ) {
+			ret_val = RECVALS_UNKNOWN;
+			break;
+			}
+
+	free( vals );
+	return( ret_val );
+}
+
+/*******************************************************************************************
+ * Returns which of the var's dims is the record dimension of the file, or -1 if it
+ * doesn't have one.  Vars in groups can use the record dimension of the root group.
+ */
+int netcdf_fi_var_recdim_index( int id, char *var_name )
+{
+	int	err, i, varid, gid, recdim_id, n_dims, dim[MAX_VAR_DIMS], n_atts;
+	char	var_name_ng[MAX_NC_NAME];
+	nc_type	type;
+
+	err = nc_inq_varid_grp( id, var_name, &varid, &gid );
+	if( err != NC_NOERR ) {
+		fprintf( stderr, "Error in netcdf_fi_var_recdim_index: could not find var named \"%s\" in file!\n",
+			var_name );
+		exit(-1);
+		}
+
+	recdim_id = netcdf_fi_recdim_id( nc_root_id_from_group_id( gid ));
+	if( recdim_id == -1 )
+		return( -1 );
+
+	varname_no_groups( var_name, var_name_ng, NULL );
+	err = nc_inq_var( gid, varid, var_name_ng, &type, &n_dims, dim, &n_atts );
+	if( err != NC_NOERR ) {
+		fprintf( stderr, "netcdf_fi_var_recdim_index: failed on nc_inq_var call!\n" );
+		exit(-1);
+		}
+
+	for( i=0; i<n_dims; i++ )
+		if( dim[i] == recdim_id )
+			return( i );
+	return( -1 );
+}
+
 /*******************************************************************************************
  * On entry, var_name can be something like "group0/group1/varname"
  */
 void netcdf_fill_aux_data( int id, char *var_name, FDBlist *fdb )
 {
-	int	err, varid, n_dims, dim[MAX_NC_DIMS], n_atts, unlimdimvar_id, recdim_id, gid;
-	char	dummy_var_name[ MAX_NC_NAME ], var_name_ng[MAX_NC_NAME], unlimdim_name[MAX_NC_NAME];
+	int	err, varid, n_dims, dim[MAX_NC_DIMS], n_atts, gid;
+	char	dummy_var_name[ MAX_NC_NAME ], var_name_ng[MAX_NC_NAME];
 	nc_type	type;
 	NetCDFOptions *netcdf;
 
@@ -1396,32 +1811,6 @@ void netcdf_fill_aux_data( int id, char *var_name, FDBlist *fdb )
 
 	varname_no_groups( var_name, var_name_ng, NULL );
 
-	/* Record the recdim units in this file
-	 */
-	recdim_id = netcdf_fi_recdim_id( gid );
-	if( recdim_id == -1 ) {
-		fdb->recdim_units = NULL;
-		}
-	else
-		{
-		/* Get NAME of the record dimension */
-		err = nc_inq_dimname( gid, recdim_id, unlimdim_name );
-		if( err != 0 ) {
-			fprintf( stderr, "Error in netcdf_fill_aux_data: could not get recdim name\n%s\n",
-				nc_strerror( err ));
-			exit(-1);
-			}
-		/* See if there is a variable with the same name */
-		err = nc_inq_varid( gid, unlimdim_name, &unlimdimvar_id );
-		if( err != 0 ) 
-			fdb->recdim_units = NULL;
-		else
-			{
-			/* Get the units for the dimvar. Note: can be NULL */
-			fdb->recdim_units = netcdf_var_units( gid, unlimdim_name );
-			}
-		}
-
 	err = nc_inq_var( gid, varid, dummy_var_name, &type, &n_dims, dim, &n_atts );
 	if( err != NC_NOERR ) {
 		fprintf( stderr, "netcdf_fill_aux_data: failed on nc_inq_var call!\n" );
@@ -360,7 +360,7 @@ void x_check_legal_colormap_loaded()
 void x_create_colormap( char *name, unsigned char r[256], unsigned char g[256], unsigned char b[256] )
 {
         Colormap        orig_colormap, new_colormap;
-        Display         *display;
+        Display         *display = NULL;
         int             i, status=0, enabled;
         XColor          *color;
         unsigned long   plane_masks[1], pixels[1];
@@ -376,7 +376,11 @@ void x_create_colormap( char *name, unsigned char r[256], unsigned char g[256],
 	printf( "----------------------\n" );
 	*/
 
-        display = XtDisplay( topLevel );
+	/* There is no display when rendering to files (-render), but
+	 * then we are in TrueColor mode and don't need one
+	 */
+	if( options.display_type == PseudoColor )
+        	display = XtDisplay( topLevel );
 
         if( colormap_list == NULL )
                 first_time_through = TRUE;
@@ -616,6 +620,13 @@ char *x_change_colormap( int delta, int do_widgets_flag )
                         options.n_colors+1 );
         pixel_transform = current_colormap_list->pixel_transform;
 
+	if( options.display_type == TrueColor )
+		make_tc_lut( current_colormap_list->color_list );
+
+	/* Frames already on the server were drawn with the old colormap */
+	x_pixmap_ring_invalidate();
+	x_dirty_tiles_reset();
+
         return( current_colormap_list->name );
 }
 
@@ -34,6 +34,8 @@
 #include "../ncview.defines.h"
 #include "../ncview.protos.h"
 
+extern Options options;
+
 /************************************************************************
  * All of the following routines must be provided for each user        
  * interface model!!
@@ -106,7 +108,9 @@ in_variable_selected( char *var_name )
 		exit( -1 );
 		}
 
+	TRACE_BEGIN( "set_scan_variable", var->name );
 	set_scan_variable( var );
+	TRACE_END( "set_scan_variable" );
 }
 
 /****************************************************************************
@@ -115,6 +119,8 @@ in_variable_selected( char *var_name )
 	void
 in_set_cursor_busy()
 {
+	if( options.render->doit )
+		return;
 	x_set_cursor_busy();
 }
 
@@ -124,6 +130,8 @@ in_set_cursor_busy()
 	void
 in_set_cursor_normal()
 {
+	if( options.render->doit )
+		return;
 	x_set_cursor_normal();
 }
 
@@ -137,6 +145,16 @@ in_change_current( char *dim_name, int modifier )
 	view_change_cur_dim( dim_name, modifier );
 }
 
+/****************************************************************************
+ * Vector through this routine when the user has asked to jump to a date
+ * on one of the dimensions.
+ */
+	void
+in_jump_current( char *dim_name )
+{
+	view_jump_cur_dim( dim_name );
+}
+
 /****************************************************************************
  * Execute a loop which scans for user-interface events, and
  * handles them appropriately.
@@ -223,6 +241,57 @@ in_set_2d_size( size_t width, size_t height )
 	return( 0 );
 }
 
+/****************************************************************************
+ * If the indicated frame, of the given size, is still held in the display's
+ * store of recently drawn frames, then draw it from there and return TRUE.
+ * Otherwise, return FALSE and draw nothing.
+ */
+	int
+in_pixmap_ring_draw( size_t frameno, size_t width, size_t height )
+{
+	return( x_pixmap_ring_draw( frameno, width, height ));
+}
+
+/****************************************************************************
+ * Forget all recently drawn frames held by the display.  Call this whenever
+ * what a frame looks like changes: colormap, range, blowup, and so forth.
+ */
+	void
+in_pixmap_ring_invalidate( void )
+{
+	x_pixmap_ring_invalidate();
+}
+
+/****************************************************************************
+ * Forget just the given frame, if the display is holding it.  Used when what
+ * was drawn is only a stand-in for the real frame.
+ */
+	void
+in_pixmap_ring_forget( size_t frameno )
+{
+	x_pixmap_ring_forget( frameno );
+}
+
+/****************************************************************************
+ * Returns the part of the 2-D field display element that can be seen
+ * in its scrolled window, in pixels from the upper left corner of the field.
+ */
+	void
+in_get_visible_area( size_t *x, size_t *y, size_t *width, size_t *height )
+{
+	x_get_visible_area( x, y, width, height );
+}
+
+/****************************************************************************
+ * Put a width by height piece of the 2-D field on the screen, with its
+ * upper left corner at (x,y) in the field.
+ */
+	void
+in_draw_2d_tile( ncv_pixel *data, size_t x, size_t y, size_t width, size_t height )
+{
+	x_draw_2d_tile( data, x, y, width, height );
+}
+
 /****************************************************************************
  * Called when a button is pressed. Argument 'button_id' indicates which 
  * button was pressed.  Argument modifier should ideally take on one of 
@@ -357,6 +426,27 @@ in_timer_set( XtTimerCallbackProc procedure, XtPointer arg, unsigned long delay_
 	x_timer_set( procedure, arg, delay_millisec );
 }
 
+/*****************************************************************************
+ * Remove the idle-time work procedure 'id' (one of the WORKPROC_*), if there 
+ * is one
+ */
+	void
+in_workproc_clear( int id )
+{
+	x_workproc_clear( id );
+}
+
+/*****************************************************************************
+ * Arrange for the passed procedure to be called whenever the interface is
+ * idle, until it returns True.  Each id (one of the WORKPROC_*) has only one
+ * procedure at a time, but the different ids don't get in each other's way.
+ */
+	void
+in_workproc_set( int id, XtWorkProc procedure, XtPointer arg )
+{
+	x_workproc_set( id, procedure, arg );
+}
+
 /*****************************************************************************
  * Set the sensitivity to the passed button_id to 'True'.  (I.e., 
  * it is currently "greyed out"; undo that.)
@@ -413,6 +503,14 @@ in_error( char *message )
 	int
 in_dialog( char *message, char *ret_string, int want_cancel_button )
 {
+	/* When rendering to files there is no display to ask on, so 
+	 * just report the message and go with the default answer
+	 */
+	if( options.render->doit ) {
+		fprintf( stderr, "ncview: %s\n", message );
+		return( MESSAGE_OK );
+		}
+
 	return(  x_dialog( message, ret_string, want_cancel_button ) );
 }
 
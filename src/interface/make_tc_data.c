@@ -25,16 +25,43 @@
 #include "../ncview.defines.h"
 #include "../ncview.protos.h"
 
+#include <stdint.h>
+#include <string.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 /* These are declared and set in x_interface.c */
 extern Server_Info	server;
+extern Options		options;
+
+/* Images with fewer pixels than this are always converted in a single thread */
+#define TC_THREAD_MIN_PIXELS	(256L*256L)
+#define TC_MAX_THREADS		16
+
+/* Packed pixel lookup table, holding the finished 2, 3, or 4 byte truecolor
+ * pixel for each palette entry, in the server's byte order.  It is rebuilt
+ * whenever a colormap is installed, or we are handed a different color list.
+ */
+static uint32_t		tc_lut32[256];
+static uint16_t		tc_lut16[256];
+static unsigned char	tc_lut24[256][3];
+static XColor		*tc_lut_colors = NULL;
+static int		tc_lut_bytes_per_pixel = 0;
+
+/* One band of rows to convert, possibly in its own thread */
+typedef struct {
+	unsigned char	*data, *tc_data;
+	long		width, row_bytes, j_start, j_end;
+} TCRows;
 
 /* Following are local to this file only */
-static void make_tc_data_16( unsigned char *data, long width, long height, XColor *color_list,
-		unsigned char *tc_data );
-static void make_tc_data_24( unsigned char *data, long width, long height, XColor *color_list,
-		unsigned char *tc_data );
-static void make_tc_data_32( unsigned char *data, long width, long height, XColor *color_list,
-		unsigned char *tc_data );
+static void tc_convert_rows( TCRows *r );
+static long tc_row_bytes( long width );
+static int  tc_n_threads( long width, long height );
+#ifdef HAVE_PTHREAD
+static void *tc_convert_rows_thread( void *arg );
+#endif
 
 /*************************************************************************************************/
 /* Converts the byte-scaled data to truecolor representation,
@@ -43,71 +70,72 @@ static void make_tc_data_32( unsigned char *data, long width, long height, XColo
 void make_tc_data( unsigned char *data, long width, long height, XColor *color_list,
 	unsigned char *tc_data )
 {
-	switch (server.bytes_per_pixel) {
-		case 4: make_tc_data_32( data, width, height, color_list, tc_data );
-			break;
-
-		case 3:
-			make_tc_data_24( data, width, height, color_list, tc_data );
-			break;
+	TCRows	rows[TC_MAX_THREADS];
+	long	row_bytes, rows_per_thread;
+	int	i, n_threads;
+#ifdef HAVE_PTHREAD
+	pthread_t	threads[TC_MAX_THREADS];
+	int		started[TC_MAX_THREADS];
+#endif
 
-		case 2:
-			make_tc_data_16( data, width, height, color_list, tc_data );
-			break;
-
-		default:
-			fprintf( stderr, "Sorry, I am not set up to produce ");
-			fprintf( stderr, "images of %d bytes per pixel.\n", 
-					server.bytes_per_pixel );
-			exit( -1 );
-			break;
+	if( (server.bytes_per_pixel < 2) || (server.bytes_per_pixel > 4) ) {
+		fprintf( stderr, "Sorry, I am not set up to produce ");
+		fprintf( stderr, "images of %d bytes per pixel.\n", 
+				server.bytes_per_pixel );
+		exit( -1 );
 		}
-}
-
-/*************************************************************************************************/
-static void make_tc_data_16( unsigned char *data, long width, long height, XColor *color_list,
-		unsigned char *tc_data )
-{
-	int	i, j, pix;
-	size_t	pad_offset, po_val;
 
-	/* pad to server.bitmap_pad bits if required */
-	pad_offset = 0L;
-	po_val     = 0L;
-	if( (width%2 != 0) && (server.bits_per_pixel != server.bitmap_pad) ) 
-		po_val = 2L;
+	if( (color_list != tc_lut_colors) || (server.bytes_per_pixel != tc_lut_bytes_per_pixel) )
+		make_tc_lut( color_list );
 
-	/****************************************
-	 *    Least significant bit first
-	 ****************************************/
-	for( j=0; j<height; j++ ) {
-		for( i=0; i<width; i++ ) {
+	row_bytes = tc_row_bytes( width );
+	n_threads = tc_n_threads( width, height );
+	rows_per_thread = (height + n_threads - 1)/n_threads;
 
-			pix = *(data+i+j*width);
-
-			*(tc_data+i*2+j*(width*2)+pad_offset) = 
-				(unsigned char)((color_list+pix)->blue>>server.shift_blue & server.mask_blue);
-
-			*(tc_data+i*2+1+j*(width*2)+pad_offset) = 
-				(unsigned char)((color_list+pix)->green>>server.shift_green_upper & server.mask_green_upper);
-
-
-			*(tc_data+i*2+j*(width*2)+pad_offset) +=
-				(unsigned char)((color_list+pix)->green>>server.shift_green_lower & server.mask_green_lower );
+	for( i=0; i<n_threads; i++ ) {
+		rows[i].data      = data;
+		rows[i].tc_data   = tc_data;
+		rows[i].width     = width;
+		rows[i].row_bytes = row_bytes;
+		rows[i].j_start   = i*rows_per_thread;
+		rows[i].j_end     = (i+1)*rows_per_thread;
+		if( rows[i].j_end > height )
+			rows[i].j_end = height;
+		}
 
-			*(tc_data+i*2+1+j*(width*2)+pad_offset) +=
-				(unsigned char)((color_list+pix)->red>>server.shift_red & server.mask_red );
-			}
-		pad_offset += po_val;
+#ifdef HAVE_PTHREAD
+	/* The calling thread does the first band itself.  If a thread
+	 * can't be started, its band is done here too.
+	 */
+	for( i=1; i<n_threads; i++ )
+		started[i] = (pthread_create( &(threads[i]), NULL, tc_convert_rows_thread, &(rows[i]) ) == 0);
+	tc_convert_rows( &(rows[0]) );
+	for( i=1; i<n_threads; i++ ) {
+		if( started[i] )
+			pthread_join( threads[i], NULL );
+		else
+			tc_convert_rows( &(rows[i]) );
 		}
+#else
+	for( i=0; i<n_threads; i++ )
+		tc_convert_rows( &(rows[i]) );
+#endif
 }
 
 /*************************************************************************************************/
-static void make_tc_data_24( unsigned char *data, long width, long height, XColor *color_list,
-		unsigned char *tc_data )
+/* Builds the packed pixel lookup table for the passed color list.  Called
+ * when a colormap is installed; make_tc_data also calls this if it is handed
+ * a color list other than the one the table was last built from.
+ */
+void make_tc_lut( XColor *color_list )
 {
-	int	i, j, pix, o_r, o_g, o_b;
-	long	pad_offset, po_val;
+	int		i, n, o_r, o_g, o_b;
+	unsigned char	b[4];
+	XColor		*c;
+
+	n = options.n_colors + options.n_extra_colors;
+	if( n > 256 )
+		n = 256;
 
 	if( server.rgb_order == ORDER_RGB ) {
 		o_r = 2;
@@ -121,60 +149,146 @@ static void make_tc_data_24( unsigned char *data, long width, long height, XColo
 		o_b = 2;
 		}
 
-	/* pad to server.bitmap_pad bits if required */
-	pad_offset = 0L;
-	po_val     = 0L;
-	if( (((width*3)%4) != 0) && (server.bits_per_pixel != server.bitmap_pad) ) 
-		po_val = (server.bitmap_pad/8) - (width*3)%4;
-
-	for( j=0; j<height; j++ ) {
-		for( i=0; i<width; i++ ) {
-
-			pix = *(data+i+j*width);
-			*(tc_data+i*3+o_b+j*(width*3)+pad_offset) = 
-				(char)((color_list+pix)->blue>>8);
-			*(tc_data+i*3+o_g+j*(width*3)+pad_offset) = 
-				(char)((color_list+pix)->green>>8);
-			*(tc_data+i*3+o_r+j*(width*3)+pad_offset) = 
-				(char)((color_list+pix)->red>>8);
+	for( i=0; i<256; i++ ) {
+		b[0] = b[1] = b[2] = b[3] = 0;
+		if( i < n ) {
+			c = color_list + i;
+			switch( server.bytes_per_pixel ) {
+				case 4:
+					if( server.byte_order == MSBFirst ) {
+						b[o_b+1] = (unsigned char)(c->blue >>8);
+						b[o_g+1] = (unsigned char)(c->green>>8);
+						b[o_r+1] = (unsigned char)(c->red  >>8);
+						}
+					else
+						{
+						b[o_b] = (unsigned char)(c->blue >>8);
+						b[o_g] = (unsigned char)(c->green>>8);
+						b[o_r] = (unsigned char)(c->red  >>8);
+						}
+					break;
+
+				case 3:
+					b[o_b] = (unsigned char)(c->blue >>8);
+					b[o_g] = (unsigned char)(c->green>>8);
+					b[o_r] = (unsigned char)(c->red  >>8);
+					break;
+
+				case 2:
+					/* Least significant bit first */
+					b[0] = (unsigned char)(c->blue>>server.shift_blue & server.mask_blue);
+					b[1] = (unsigned char)(c->green>>server.shift_green_upper & server.mask_green_upper);
+					b[0] += (unsigned char)(c->green>>server.shift_green_lower & server.mask_green_lower);
+					b[1] += (unsigned char)(c->red>>server.shift_red & server.mask_red);
+					break;
+				}
 			}
-		pad_offset += po_val;
+		memcpy( &(tc_lut32[i]), b, 4 );
+		memcpy( &(tc_lut16[i]), b, 2 );
+		memcpy( tc_lut24[i],    b, 3 );
 		}
+
+	tc_lut_colors          = color_list;
+	tc_lut_bytes_per_pixel = server.bytes_per_pixel;
 }
 
 /*************************************************************************************************/
-static void make_tc_data_32( unsigned char *data, long width, long height, XColor *color_list,
-		unsigned char *tc_data )
+/* Number of bytes in each row of the truecolor image, including any padding
+ * out to server.bitmap_pad bits.
+ */
+static long tc_row_bytes( long width )
 {
-	int	i, j, pix, o_r, o_g, o_b;
+	long	po_val;
 
-	if( server.rgb_order == ORDER_RGB ) {
-		o_r = 2;
-		o_g = 1;
-		o_b = 0;
-		}
-	else
-		{
-		o_r = 0;
-		o_g = 1;
-		o_b = 2;
+	po_val = 0L;
+	switch( server.bytes_per_pixel ) {
+		case 2:	if( (width%2 != 0) && (server.bits_per_pixel != server.bitmap_pad) ) 
+				po_val = 2L;
+			break;
+
+		case 3:	if( (((width*3)%4) != 0) && (server.bits_per_pixel != server.bitmap_pad) ) 
+				po_val = (server.bitmap_pad/8) - (width*3)%4;
+			break;
 		}
-	if( server.byte_order == MSBFirst ) {
-		o_r++;
-		o_g++;
-		o_b++;
+
+	return( width*server.bytes_per_pixel + po_val );
+}
+
+/*************************************************************************************************/
+/* How many threads to split the conversion over.  options.n_threads of 0 
+ * means pick based on the number of processors.
+ */
+static int tc_n_threads( long width, long height )
+{
+	long	n;
+
+#ifdef HAVE_PTHREAD
+	if( (width*height < TC_THREAD_MIN_PIXELS) || (height < 2) )
+		return( 1 );
+
+	n = options.n_threads;
+	if( n <= 0 ) {
+		n = sysconf( _SC_NPROCESSORS_ONLN );
+		if( n > 8 )
+			n = 8;
 		}
+	if( n > TC_MAX_THREADS )
+		n = TC_MAX_THREADS;
+	if( n > height )
+		n = height;
+	if( n < 1 )
+		n = 1;
+	return( (int)n );
+#else
+	return( 1 );
+#endif
+}
+
+/*************************************************************************************************/
+/* Converts rows j_start to j_end-1, going along each row so that both the
+ * source and destination are walked in memory order.
+ */
+static void tc_convert_rows( TCRows *r )
+{
+	long		i, j, width;
+	unsigned char	*src, *dst;
+	uint32_t	*dst32;
+	uint16_t	*dst16;
+
+	width = r->width;
+	for( j=r->j_start; j<r->j_end; j++ ) {
+		src = r->data    + j*width;
+		dst = r->tc_data + j*r->row_bytes;
+		switch( server.bytes_per_pixel ) {
+			case 4:
+				dst32 = (uint32_t *)dst;
+				for( i=0; i<width; i++ )
+					dst32[i] = tc_lut32[src[i]];
+				break;
 
-	for( i=0; i<width; i++ )
-	for( j=0; j<height; j++ ) {
-		pix = *(data+i+j*width);
-		*(tc_data+i*4+o_b+j*(width*4)) = 
-			(char)((color_list+pix)->blue>>8);
-		*(tc_data+i*4+o_g+j*(width*4)) = 
-			(char)((color_list+pix)->green>>8);
-		*(tc_data+i*4+o_r+j*(width*4)) = 
-			(char)((color_list+pix)->red>>8);
+			case 3:
+				for( i=0; i<width; i++ ) {
+					dst[0] = tc_lut24[src[i]][0];
+					dst[1] = tc_lut24[src[i]][1];
+					dst[2] = tc_lut24[src[i]][2];
+					dst += 3;
+					}
+				break;
+
+			case 2:
+				dst16 = (uint16_t *)dst;
+				for( i=0; i<width; i++ )
+					dst16[i] = tc_lut16[src[i]];
+				break;
+			}
 		}
 }
-	
 
+#ifdef HAVE_PTHREAD
+/*************************************************************************************************/
+static void *tc_convert_rows_thread( void *arg )
+{
+	tc_convert_rows( (TCRows *)arg );
+	return( NULL );
+}
+#endif
@@ -46,6 +46,7 @@ static char overlay_filename[ OVERLAY_FILENAME_LEN ];
 extern Widget		topLevel;
 extern XtAppContext	x_app_context;
 extern Options		options;
+extern View		*view;
 extern Pixmap 		open_circle_pixmap, closed_circle_pixmap; /* set in x_interface.c */
 extern Server_Info	server;
 extern Cmaplist		*colormap_list, *current_colormap_list;
@@ -98,10 +99,11 @@ void overlay_unset_callback 	( Widget widget, XtPointer client_data, XtPointer c
 void shrink_set_callback 	( Widget widget, XtPointer client_data, XtPointer call_data);
 void shrink_unset_callback 	( Widget widget, XtPointer client_data, XtPointer call_data);
 
-/* Order of these must match defines of SHRINK_METHOD_MEAN and SHRINK_METHOD_MODE
- * in file ../ncview.defines.h!
+/* Order of these must match defines of SHRINK_METHOD_MEAN, SHRINK_METHOD_MODE,
+ * and SHRINK_METHOD_SAMPLE in file ../ncview.defines.h!
  */
-static char *shrink_labels[] = { "Average (Mean; for continuous data)", "Most common value (Mode; for categorical data)" };
+static char *shrink_labels[] = { "Average (Mean; for continuous data)", "Most common value (Mode; for categorical data)",
+				 "Every Nth point (fast preview; reads only those points)" };
 
 /* Local callbacks */
 void cbsel_enable_callback	( Widget w, XtPointer client_data, XtPointer call_data );
@@ -189,6 +191,9 @@ set_options( void )
 		new_shrink = (int)(RadioWidget_query_current( shrink_widget ));
 		if( new_shrink != l_current_shrink ) {
 			options.shrink_method = new_shrink;
+			/* Reduced data read for one method won't do for another */
+			if( (view != NULL) && (view->data_stride != 1) && (view->data_status == VDS_VALID) )
+				view->data_status = VDS_INVALID;
 			invalidate_all_saveframes();
 			change_view( 0, FRAMES );
 			}
@@ -367,7 +372,7 @@ set_options_init()
 		shrink_widget = RadioWidget_init( 
 			opt_shrink_box_widget,		/* parent */
 			opt_shrink_label_widget, 	/* widget to be fromVert */
-			2L,
+			3L,
 			0L,
 			shrink_labels,
 			&open_circle_pixmap, &closed_circle_pixmap,
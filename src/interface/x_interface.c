@@ -33,11 +33,6 @@
 #include <X11/CoreP.h>
 #include <X11/CoreP.h>
 
-#ifdef HAVE_PNG
-#include <png.h>
-#include <setjmp.h>
-#endif
-
 #define DEFAULT_BUTTON_WIDTH	55
 #define DEFAULT_VARNAME_WIDTH	55
 #define DEFAULT_LABEL_WIDTH	400
@@ -127,6 +122,8 @@ Colormap		current_colormap = (Colormap)NULL;
 
 static AppData		app_data;
 static XtIntervalId	timer;
+static XtWorkProcId	workproc[N_WORKPROCS];
+static int		workproc_enabled[N_WORKPROCS];
 
 static int		timer_enabled      = FALSE,
 			ccontour_popped_up = FALSE,
@@ -146,6 +143,30 @@ Pixmap 			open_circle_pixmap,
 
 static XEvent	event;
 
+/* A ring of X server-side pixmaps holding the most recently drawn frames.
+ * Stepping to a frame that is still in the ring is a single XCopyArea,
+ * with no make_tc_data or XPutImage.  The number of entries is set by
+ * options.pixmap_budget_mb and the current frame size.
+ */
+#define PIXMAP_RING_MAX		4096
+typedef struct {
+	Pixmap	pixmap;
+	int	valid;
+	size_t	frameno;
+} PixmapRingEntry;
+
+static PixmapRingEntry	*pixmap_ring = NULL;
+static int		pixmap_ring_n = 0, pixmap_ring_next = 0;
+static size_t		pixmap_ring_width = 0L, pixmap_ring_height = 0L;
+
+/* Copy of the frame now showing in the ccontour window, used to send only
+ * the tiles that changed when options.dirty_tile_size > 0.  Must be marked
+ * invalid whenever the window contents change some other way.
+ */
+static ncv_pixel	*last_drawn = NULL;
+static size_t		last_drawn_width = 0L, last_drawn_height = 0L;
+static int		last_drawn_valid = FALSE;
+
 static Widget
 	error_popup_widget = NULL,
 		error_popupcanvas_widget,
@@ -400,7 +421,7 @@ void 	x_make_dim_button_util  ( int dimension, Stringlist *dim_list, char *prefi
 					char *selected_name );
 void	x_popup			( char *message );
 int	x_dialog                ( char *message, char *ret_string, int want_cancel_button );
-void	track_pointer		( void );
+void	track_pointer		( Widget w, XtPointer client_data, XEvent *event, Boolean *continue_to_dispatch );
 
 /* the button callbacks and actions in x_interface.c */
 /* _mod1 is a standard callback; _mod2 is an accelerated action, and _mod3
@@ -443,6 +464,7 @@ void 	diminfo_cur_mod1(Widget w, XtPointer client_data, XtPointer call_data);
 void 	diminfo_cur_mod2(Widget w, XButtonEvent *e, String *p, Cardinal *n );
 void 	diminfo_cur_mod3(Widget w, XButtonEvent *e, String *p, Cardinal *n );
 void 	diminfo_cur_mod4(Widget w, XButtonEvent *e, String *p, Cardinal *n );
+void 	diminfo_cur_jump(Widget w, XButtonEvent *e, String *p, Cardinal *n );
 void 	diminfo_min_mod1(Widget w, XtPointer client_data, XtPointer call_data);
 void 	do_plot_xy	(Widget w, XButtonEvent *e, String *p, Cardinal *n );
 void 	do_quit_app            (Widget w, XButtonEvent *e, String *p, Cardinal *n );
@@ -460,6 +482,10 @@ static void 	add_callbacks( void );
 static void 	dump_to_png( unsigned char *data, size_t width, size_t height,
 				size_t timestep );
 #endif
+static int 	pixmap_ring_resize( size_t width, size_t height );
+static int 	pixmap_ring_store( XImage *ximage, GC gc, size_t frameno, size_t width, size_t height );
+static int 	put_dirty_tiles( XImage *ximage, GC gc, unsigned char *data, size_t width, size_t height );
+static void 	remember_drawn_frame( unsigned char *data, size_t width, size_t height );
 
 /*************************************************************************************************/
 void x_parse_args( int *p_argc, char **argv )
@@ -625,7 +651,6 @@ void x_parse_args( int *p_argc, char **argv )
 void x_initialize()
 {
 	void	  check_app_res();
-	void 	  track_pointer();
 
 	static XtActionsRec new_actions[] = {
 		{"cmap_mod3",    	(XtActionProc)cmap_mod3        	},
@@ -636,6 +661,7 @@ void x_initialize()
 		{"diminfo_cur_mod2",	(XtActionProc)diminfo_cur_mod2  },
 		{"diminfo_cur_mod3",	(XtActionProc)diminfo_cur_mod3  },
 		{"diminfo_cur_mod4",	(XtActionProc)diminfo_cur_mod4  },
+		{"diminfo_cur_jump",	(XtActionProc)diminfo_cur_jump  },
 		{"range_mod3",		(XtActionProc)range_mod3	},
 		{"blowup_mod2",		(XtActionProc)blowup_mod2	},
 		{"blowup_mod3",		(XtActionProc)blowup_mod3	},
@@ -727,22 +753,34 @@ void x_query_pointer_position( int *ret_x, int *ret_y )
 }
 
 /*************************************************************************************************/
-void track_pointer()
+/* The position comes from the event itself rather than asking the server where
+ * the pointer is.  When the pointer moves quickly, motion events pile up faster
+ * than we can report them; only the latest one queued up matters, so the rest
+ * are thrown away.
+ */
+void track_pointer( Widget w, XtPointer client_data, XEvent *event, Boolean *continue_to_dispatch )
 {
-	Window root_return, child_window_return;
-	int	root_x, root_y, win_x, win_y;
-	unsigned int keys_and_buttons;
+	XEvent	latest;
+	int	n_skipped;
+	unsigned int state;
+
+	if( event->type == MotionNotify ) {
+		latest    = *event;
+		n_skipped = 0;
+		while( XCheckTypedWindowEvent( XtDisplay(w), XtWindow(w), MotionNotify, &latest ))
+			n_skipped++;
+		if( options.debug && (n_skipped > 0) )
+			printf( "track_pointer: skipped %d motion events\n", n_skipped );
+		report_position( latest.xmotion.x, latest.xmotion.y, latest.xmotion.state );
+		}
 
-	if( XQueryPointer( XtDisplay(topLevel),
-			XtWindow( ccontour_widget ),
-			&root_return,
-			&child_window_return,
-			&root_x,
-			&root_y,
-			&win_x,
-			&win_y,
-			&keys_and_buttons ) )
-		report_position( win_x, win_y, keys_and_buttons );
+	else if( event->type == ButtonPress ) {
+		/* The state is from just before the press, so add the button */
+		state = event->xbutton.state;
+		if( (event->xbutton.button >= Button1) && (event->xbutton.button <= Button5) )
+			state |= (Button1Mask << (event->xbutton.button - Button1));
+		report_position( event->xbutton.x, event->xbutton.y, state );
+		}
 }
 
 /*************************************************************************************************/
@@ -1883,11 +1921,15 @@ void x_draw_2d_field( unsigned char *data, size_t width, size_t height, size_t t
 	GC	gc;
 	static	size_t last_width=0L, last_height=0L;
 	static 	unsigned char *tc_data=NULL;
+	double	t_start;
 
 #ifdef HAVE_PNG
 	if( options.dump_frames )
 		dump_to_png( data, width, height, timestep );
 #endif
+	if( options.stream_file != NULL )
+		stream_display_frame( data, width, height, current_colormap_list->color_list,
+			options.n_colors+options.n_extra_colors );
 
 	display = XtDisplay( ccontour_widget );
 	screen  = XtScreen ( ccontour_widget );
@@ -1910,7 +1952,9 @@ void x_draw_2d_field( unsigned char *data, size_t width, size_t height, size_t t
 		/* Convert data to TrueColor representation, with
 		 * the proper number of bytes per pixel
 		 */
+		t_start = util_time_msec();
 		make_tc_data( data, width, height, current_colormap_list->color_list, tc_data );
+		timing_add( TIMING_TRUECOLOR, t_start );
 
 		ximage  = XCreateImage(
 			display,
@@ -1940,13 +1984,285 @@ void x_draw_2d_field( unsigned char *data, size_t width, size_t height, size_t t
 	if( !valid_display )
 		return;
 
-	XPutImage(
-		display,
-		XtWindow( ccontour_widget ),
-		gc,
-		ximage,
-		0, 0, 0, 0,
-		(unsigned int)width, (unsigned int)height );
+	/* If we are keeping recent frames on the server, the image goes
+	 * to the ring's pixmap and is copied to the window from there.
+	 * Otherwise, if asked to, only send the parts that changed.
+	 */
+	t_start = util_time_msec();
+	if( pixmap_ring_store( ximage, gc, timestep, width, height ))
+		;
+	else if( put_dirty_tiles( ximage, gc, data, width, height ))
+		;
+	else
+		XPutImage(
+			display,
+			XtWindow( ccontour_widget ),
+			gc,
+			ximage,
+			0, 0, 0, 0,
+			(unsigned int)width, (unsigned int)height );
+	timing_add( TIMING_XFER, t_start );
+
+	remember_drawn_frame( data, width, height );
+}
+
+/*************************************************************************************************/
+/* Compares the new frame to the one now in the window in square tiles of 
+ * options.dirty_tile_size pixels, and sends only the changed tiles.  Runs of
+ * changed tiles along a row are sent as one rectangle.  Returns TRUE if the
+ * frame was drawn this way, FALSE if a full XPutImage is needed instead.
+ */
+static int put_dirty_tiles( XImage *ximage, GC gc, unsigned char *data, size_t width, size_t height )
+{
+	Display	*display;
+	size_t	ts, tx, ty, ntx, nty, x0, y0, w, h, j, run_start;
+	long	n_changed, n_rects;
+	int	changed, in_run;
+
+	ts = options.dirty_tile_size;
+	if( (ts <= 0) || (! last_drawn_valid) ||
+	    (width != last_drawn_width) || (height != last_drawn_height) )
+		return( FALSE );
+
+	display   = XtDisplay( ccontour_widget );
+	ntx       = (width  + ts - 1)/ts;
+	nty       = (height + ts - 1)/ts;
+	n_changed = 0L;
+	n_rects   = 0L;
+
+	for( ty=0; ty<nty; ty++ ) {
+		y0 = ty*ts;
+		h  = ((y0+ts) > height) ? (height-y0) : ts;
+		in_run    = FALSE;
+		run_start = 0L;
+		for( tx=0; tx<=ntx; tx++ ) {
+			changed = FALSE;
+			if( tx < ntx ) {
+				x0 = tx*ts;
+				w  = ((x0+ts) > width) ? (width-x0) : ts;
+				for( j=y0; j<(y0+h); j++ )
+					if( memcmp( data+j*width+x0, last_drawn+j*width+x0, w ) != 0 ) {
+						changed = TRUE;
+						break;
+						}
+				}
+			if( changed ) {
+				n_changed++;
+				if( ! in_run ) {
+					in_run    = TRUE;
+					run_start = tx*ts;
+					}
+				}
+			else if( in_run ) {
+				/* Send the run of changed tiles that just ended */
+				x0 = tx*ts;
+				if( x0 > width )
+					x0 = width;
+				XPutImage( display, XtWindow( ccontour_widget ), gc, ximage,
+					(int)run_start, (int)y0, (int)run_start, (int)y0,
+					(unsigned int)(x0-run_start), (unsigned int)h );
+				n_rects++;
+				in_run = FALSE;
+				}
+			}
+		}
+
+	if( options.debug )
+		printf( "dirty tiles: %ld of %ld tiles (%ldx%ld) changed, %.1f%%, sent as %ld rectangles\n",
+			n_changed, (long)(ntx*nty), (long)ts, (long)ts,
+			100.0*(float)n_changed/(float)(ntx*nty), n_rects );
+
+	return( TRUE );
+}
+
+/*************************************************************************************************/
+/* Saves a copy of the frame just drawn, if we are sending dirty tiles */
+static void remember_drawn_frame( unsigned char *data, size_t width, size_t height )
+{
+	if( options.dirty_tile_size <= 0 )
+		return;
+
+	if( (last_drawn == NULL) || (width != last_drawn_width) || (height != last_drawn_height) ) {
+		if( last_drawn != NULL )
+			free( last_drawn );
+		last_drawn = (ncv_pixel *)malloc( width*height*sizeof(ncv_pixel) );
+		if( last_drawn == NULL ) {
+			fprintf( stderr, "ncview: remember_drawn_frame: can't allocate %ld bytes; sending full frames\n",
+				width*height*sizeof(ncv_pixel) );
+			options.dirty_tile_size = 0;
+			last_drawn_valid = FALSE;
+			return;
+			}
+		last_drawn_width  = width;
+		last_drawn_height = height;
+		}
+
+	memcpy( last_drawn, data, width*height*sizeof(ncv_pixel) );
+	last_drawn_valid = TRUE;
+}
+
+/*************************************************************************************************/
+/* Call when the contents of the ccontour window change other than by 
+ * x_draw_2d_field, so the next frame is sent in full.
+ */
+void x_dirty_tiles_reset( void )
+{
+	last_drawn_valid = FALSE;
+}
+
+/*************************************************************************************************/
+/* Copies the indicated frame to the ccontour window if it is in the pixmap
+ * ring.  Returns TRUE if the frame was drawn, FALSE otherwise.
+ */
+int x_pixmap_ring_draw( size_t frameno, size_t width, size_t height )
+{
+	Display	*display;
+	XGCValues values;
+	GC	gc;
+	int	i;
+
+	if( (pixmap_ring == NULL) || (!valid_display) )
+		return( FALSE );
+
+	if( (width != pixmap_ring_width) || (height != pixmap_ring_height) )
+		return( FALSE );
+
+	for( i=0; i<pixmap_ring_n; i++ ) {
+		if( pixmap_ring[i].valid && (pixmap_ring[i].frameno == frameno) ) {
+			if( options.debug )
+				printf( "drawing frame %ld from pixmap ring entry %d\n", frameno, i );
+			display = XtDisplay( ccontour_widget );
+			gc = XtGetGC( ccontour_widget, (XtGCMask)0, &values );
+			XCopyArea( display, pixmap_ring[i].pixmap, XtWindow( ccontour_widget ), gc,
+				0, 0, (unsigned int)width, (unsigned int)height, 0, 0 );
+			last_drawn_valid = FALSE;
+			return( TRUE );
+			}
+		}
+
+	return( FALSE );
+}
+
+/*************************************************************************************************/
+/* Marks every frame in the pixmap ring as stale.  The pixmaps themselves are 
+ * kept, so they can be reused as long as the frame size does not change.
+ */
+void x_pixmap_ring_invalidate( void )
+{
+	int	i;
+
+	for( i=0; i<pixmap_ring_n; i++ )
+		pixmap_ring[i].valid = FALSE;
+	pixmap_ring_next = 0;
+}
+
+/*************************************************************************************************/
+/* Marks just the given frame in the pixmap ring as stale, if it is there.
+ */
+void x_pixmap_ring_forget( size_t frameno )
+{
+	int	i;
+
+	for( i=0; i<pixmap_ring_n; i++ )
+		if( pixmap_ring[i].valid && (pixmap_ring[i].frameno == frameno) )
+			pixmap_ring[i].valid = FALSE;
+}
+
+/*************************************************************************************************/
+/* Makes sure the pixmap ring is set up for frames of the given size.  Returns
+ * the number of entries in the ring, which is 0 if the ring is not in use.
+ */
+static int pixmap_ring_resize( size_t width, size_t height )
+{
+	Display	*display;
+	size_t	bytes_per_frame, budget;
+	int	i, n;
+
+	if( (pixmap_ring != NULL) && (width == pixmap_ring_width) && (height == pixmap_ring_height) )
+		return( pixmap_ring_n );
+
+	display = XtDisplay( ccontour_widget );
+	if( pixmap_ring != NULL ) {
+		for( i=0; i<pixmap_ring_n; i++ )
+			if( pixmap_ring[i].pixmap != None )
+				XFreePixmap( display, pixmap_ring[i].pixmap );
+		free( pixmap_ring );
+		pixmap_ring   = NULL;
+		pixmap_ring_n = 0;
+		}
+
+	if( (options.pixmap_budget_mb <= 0) || (width == 0) || (height == 0) )
+		return( 0 );
+
+	bytes_per_frame = width * height * ((server.bits_per_pixel+7)/8);
+	budget          = (size_t)options.pixmap_budget_mb * 1048576L;
+	if( bytes_per_frame > budget )
+		return( 0 );
+	n = budget / bytes_per_frame;
+	if( n > PIXMAP_RING_MAX )
+		n = PIXMAP_RING_MAX;
+
+	pixmap_ring = (PixmapRingEntry *)malloc( n * sizeof( PixmapRingEntry ));
+	if( pixmap_ring == NULL ) {
+		fprintf( stderr, "ncview: pixmap_ring_resize: failed to allocate %d ring entries\n", n );
+		return( 0 );
+		}
+	for( i=0; i<n; i++ ) {
+		pixmap_ring[i].pixmap = None;
+		pixmap_ring[i].valid  = FALSE;
+		}
+	pixmap_ring_n      = n;
+	pixmap_ring_next   = 0;
+	pixmap_ring_width  = width;
+	pixmap_ring_height = height;
+
+	if( options.debug )
+		printf( "pixmap ring: %d entries of %ldx%ld (%ld bytes each)\n", n, width, height, bytes_per_frame );
+
+	return( n );
+}
+
+/*************************************************************************************************/
+/* Puts the image into the pixmap ring, replacing either an older copy of the
+ * same frame or the oldest entry, then copies it to the ccontour window.
+ * Returns TRUE if the image was drawn, FALSE if the ring is not in use.
+ */
+static int pixmap_ring_store( XImage *ximage, GC gc, size_t frameno, size_t width, size_t height )
+{
+	Display	*display;
+	Screen	*screen;
+	int	i, slot;
+
+	if( pixmap_ring_resize( width, height ) == 0 )
+		return( FALSE );
+
+	display = XtDisplay( ccontour_widget );
+	screen  = XtScreen ( ccontour_widget );
+
+	slot = -1;
+	for( i=0; i<pixmap_ring_n; i++ )
+		if( pixmap_ring[i].valid && (pixmap_ring[i].frameno == frameno) ) {
+			slot = i;
+			break;
+			}
+	if( slot == -1 ) {
+		slot = pixmap_ring_next;
+		pixmap_ring_next = (pixmap_ring_next + 1) % pixmap_ring_n;
+		}
+
+	if( pixmap_ring[slot].pixmap == None )
+		pixmap_ring[slot].pixmap = XCreatePixmap( display, XtWindow( ccontour_widget ),
+			(unsigned int)width, (unsigned int)height, XDefaultDepthOfScreen( screen ));
+
+	XPutImage( display, pixmap_ring[slot].pixmap, gc, ximage,
+		0, 0, 0, 0, (unsigned int)width, (unsigned int)height );
+	pixmap_ring[slot].valid   = TRUE;
+	pixmap_ring[slot].frameno = frameno;
+
+	XCopyArea( display, pixmap_ring[slot].pixmap, XtWindow( ccontour_widget ), gc,
+		0, 0, (unsigned int)width, (unsigned int)height, 0, 0 );
+
+	return( TRUE );
 }
 
 /*************************************************************************************************/
@@ -1958,6 +2274,99 @@ void x_set_speed_proc( Widget scrollbar, XtPointer client_data, XtPointer positi
 	options.frame_delay = f_pos;
 }
 
+/*************************************************************************************************/
+/* Returns the part of the ccontour widget that can be seen through its
+ * viewport.  When scrolled, the viewport moves the ccontour widget to a
+ * negative position inside itself.
+ */
+void x_get_visible_area( size_t *x, size_t *y, size_t *width, size_t *height )
+{
+	Position	cx, cy;
+	Dimension	vp_width, vp_height;
+
+	XtVaGetValues( ccontour_widget, XtNx, &cx, XtNy, &cy, NULL );
+	XtVaGetValues( ccontour_viewport_widget, XtNwidth, &vp_width, XtNheight, &vp_height, NULL );
+
+	*x      = (cx < 0) ? (size_t)(-cx) : 0L;
+	*y      = (cy < 0) ? (size_t)(-cy) : 0L;
+	*width  = (size_t)vp_width;
+	*height = (size_t)vp_height;
+}
+
+/*************************************************************************************************/
+/* Puts a width by height piece of the field, whose upper left corner
+ * is at (x,y), into the ccontour window.
+ */
+void x_draw_2d_tile( unsigned char *data, size_t x, size_t y, size_t width, size_t height )
+{
+	Display	*display;
+	Screen	*screen;
+	XImage	*ximage;
+	XGCValues values;
+	GC	gc;
+	static 	unsigned char *tc_data=NULL;
+	static	size_t tc_size=0L;
+	double	t_start;
+
+	if( !valid_display )
+		return;
+
+	display = XtDisplay( ccontour_widget );
+	screen  = XtScreen ( ccontour_widget );
+
+	if( options.display_type == TrueColor ) {
+		if( server.bitmap_unit*width*height > tc_size ) {
+			if( tc_data != NULL )
+				free( tc_data );
+			tc_size = server.bitmap_unit*width*height;
+			tc_data = (unsigned char *)malloc( tc_size );
+			if( tc_data == NULL ) {
+				fprintf( stderr, "ncview: x_draw_2d_tile: failed to allocate %ld bytes\n", (long)tc_size );
+				exit( -1 );
+				}
+			}
+		t_start = util_time_msec();
+		make_tc_data( data, width, height, current_colormap_list->color_list, tc_data );
+		timing_add( TIMING_TRUECOLOR, t_start );
+
+		ximage  = XCreateImage(
+			display,
+			XDefaultVisualOfScreen( screen ),
+			XDefaultDepthOfScreen ( screen ),
+			ZPixmap,
+			0,
+			(char *)tc_data, 
+			(unsigned int)width, (unsigned int)height,
+			32, 0 );
+		}
+	else /* display_type == PseudoColor */
+		{
+		ximage  = XCreateImage(
+			display,
+			XDefaultVisualOfScreen( screen ),
+			XDefaultDepthOfScreen ( screen ),
+			ZPixmap,
+			0,
+			(char *)data,
+			(unsigned int)width, (unsigned int)height,
+			8, 0 );
+		}
+
+	gc = XtGetGC( ccontour_widget, (XtGCMask)0, &values );
+
+	t_start = util_time_msec();
+	XPutImage( display, XtWindow( ccontour_widget ), gc, ximage,
+		0, 0, (int)x, (int)y, (unsigned int)width, (unsigned int)height );
+	timing_add( TIMING_XFER, t_start );
+
+	/* The data isn't ours to free */
+	ximage->data = NULL;
+	XDestroyImage( ximage );
+
+	/* What's in the window is no longer a whole frame we know about */
+	last_drawn_valid = FALSE;
+}
+
 /*************************************************************************************************/
 void x_set_2d_size( size_t width, size_t height )
 {
@@ -2313,6 +2722,28 @@ void diminfo_cur_mod4( Widget widget, XButtonEvent *event, String *params,
 	exit( -1 );
 }
 
+/*************************************************************************************************/
+void diminfo_cur_jump( Widget widget, XButtonEvent *event, String *params, 
+							Cardinal *num_params )
+{
+	int	i = 0;
+	Widget	*w;
+	String	label;
+
+	while( (w = diminfo_cur_widget+i) != NULL ) {
+		if( *w == widget ) {
+			XtVaGetValues( *(diminfo_name_widget+i), 
+						XtNlabel, &label, NULL );
+			in_jump_current( label );
+			return;
+			}
+		i++;
+		}
+	fprintf( stderr, "ncview: diminfo_cur_jump callback: can't find " );
+	fprintf( stderr, "widget for the pressed button\n" );
+	exit( -1 );
+}
+
 /*************************************************************************************************/
 void restart_mod1( Widget widget, XtPointer client_data, XtPointer call_data)
 {
@@ -2525,6 +2956,47 @@ void x_timer_clear( void )
 		}
 }
 
+/*************************************************************************************************/
+/* Xt removes a work procedure itself when it returns True, so we wrap the 
+ * caller's procedure to know when that has happened.
+ */
+static XtWorkProc	workproc_proc[N_WORKPROCS];
+static XtPointer	workproc_arg [N_WORKPROCS];
+
+static Boolean x_workproc_wrapper( XtPointer client_arg )
+{
+	Boolean	done;
+	long	id;
+
+	id   = (long)client_arg;
+	done = (*workproc_proc[id])( workproc_arg[id] );
+	if( done )
+		workproc_enabled[id] = FALSE;
+	return( done );
+}
+
+/*************************************************************************************************/
+void x_workproc_set( int id, XtWorkProc procedure, XtPointer client_arg )
+{
+	x_workproc_clear( id );
+	workproc_proc[id] = procedure;
+	workproc_arg [id] = client_arg;
+	workproc[id] = XtAppAddWorkProc( 
+		x_app_context,
+		x_workproc_wrapper,
+		(XtPointer)(long)id );
+	workproc_enabled[id] = TRUE;
+}
+
+/*************************************************************************************************/
+void x_workproc_clear( int id )
+{
+	if( workproc_enabled[id] ) {
+		XtRemoveWorkProc( workproc[id] );
+		workproc_enabled[id] = FALSE;
+		}
+}
+
 /*************************************************************************************************/
 void x_indicate_active_var( char *var_name )
 {
@@ -3331,6 +3803,7 @@ void x_init_dim_info( Stringlist *dims )
 
 		/* Add the modifications for the created curr_dimension button;
 		 * Button-3 gives mod3 and holding down control gives mod2.
+		 * Holding down shift asks for a date to jump to.
 		 */
 		XtAugmentTranslations( *(diminfo_cur_widget+ll), 
 			XtParseTranslationTable( 
@@ -3341,6 +3814,9 @@ void x_init_dim_info( Stringlist *dims )
 		XtOverrideTranslations( *(diminfo_cur_widget+ll), 
 			XtParseTranslationTable( 
 				"Ctrl<Btn3Down>,<Btn3Up>: diminfo_cur_mod4()" ));
+		XtOverrideTranslations( *(diminfo_cur_widget+ll), 
+			XtParseTranslationTable( 
+				"Shift<Btn1Down>,<Btn1Up>: diminfo_cur_jump()" ));
 
 		snprintf( widget_name, 127, "diminfo_max_%1ld", ll );
 		*(diminfo_max_widget+ll) = XtVaCreateManagedWidget(
@@ -3498,6 +3974,9 @@ void expose_ccontour( Widget w, XtPointer client_data, XExposeEvent *event, Bool
 		return;
 		}
 
+	/* Window contents were lost, so don't send just the dirty tiles */
+	last_drawn_valid = FALSE;
+
 	if( (event->count == 0) && (event->width > 1) && (event->height > 1))
 		view_draw( TRUE, FALSE );
 }
@@ -3695,98 +4174,15 @@ void x_set_colormap_form_width( int width )
 void dump_to_png( unsigned char *data, size_t width, size_t height, size_t frameno )
 {
 	char		filename[2048];
-	FILE		*out_file;
-	png_structp	png_ptr;
-	png_infop	info_ptr;
-	png_colorp	palette;
-	int		bit_depth, i, j, n_palette;
-	unsigned char	**row_pointers;
 	static int	error_state = 0;
 
 	if( error_state == 1 ) return;
 
 	snprintf( filename, 2047, "frame.%05ld.png", frameno );
-	frameno++;
-
-	/* Open binary output file */
-	if( (out_file = fopen( filename, "wb" )) == NULL ) {
-		fprintf( stderr, "ncview: can't open PNG file %s for writing\n", filename );
-		error_state = 1;
-		return;
-		}
-
-	/* Set up PNG information structures */
-	png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, (png_voidp)NULL, NULL, NULL );	/* use default error handlers */
-	if( ! png_ptr ) {
-		fprintf( stderr, "Error returned when trying to allocate PNG write structure\n" );
-		error_state = 1;
-		return;
-		}
-
-	info_ptr = png_create_info_struct( png_ptr );
-	if( ! info_ptr ) {
-		fprintf( stderr, "Error returned when trying to allocate PNG info structure\n" );
-		png_destroy_write_struct( &png_ptr, (png_infopp)NULL );
-		error_state = 1;
-		return;
-		}
-
-	/* Set up PNG I/O ops */
-	png_init_io( png_ptr, out_file );
-
-	/* Describe our image for PNG */
-	bit_depth = 8;
-	png_set_IHDR( png_ptr, info_ptr, width, height, bit_depth, 
-		PNG_COLOR_TYPE_PALETTE,		/* ncview operates with palettes almost exclusively */
-		PNG_INTERLACE_NONE,
-		PNG_COMPRESSION_TYPE_DEFAULT,
-		PNG_FILTER_TYPE_DEFAULT );
 
-	/* Set our palette */
-	n_palette = 256;
-	palette = (png_colorp)malloc( sizeof(png_color) * n_palette );
-	if( palette == NULL ) {
-		fprintf( stderr, "Failed to allocate colormap; returning without writing output file\n" );
+	if( png_queue_frame( filename, data, width, height, current_colormap_list->color_list,
+			options.n_colors+options.n_extra_colors ) != 0 )
 		error_state = 1;
-		return;
-		}
-	for( i=0; i<n_palette; i++ ) {
-		palette[i].red   = ((current_colormap_list->color_list+i)->red   >> 8);
-		palette[i].green = ((current_colormap_list->color_list+i)->green >> 8);
-		palette[i].blue  = ((current_colormap_list->color_list+i)->blue  >> 8);
-		}
-	png_set_PLTE( png_ptr, info_ptr, palette, n_palette );
-
-	/* Make our row pointers */
-	row_pointers = (unsigned char **)malloc( sizeof( unsigned char * ) * height );
-	if( row_pointers == NULL ) {
-		fprintf( stderr, "Failed to allocate row pointers; returning without writing output file\n" );
-		error_state = 1;
-		return;
-		}
-	for( j=0; j<height; j++ ) 
-		row_pointers[j] = data + j*width;
-
-	/* Associate row pointers with the PNG structures */
-	png_set_rows( png_ptr, info_ptr, row_pointers );
-
-	/* Set up longjump target (PNG will use this for an error) */
-	if( setjmp( png_jmpbuf(png_ptr))) {
-		fprintf( stderr, "Error returned when trying to write PNG file, aborting operation\n" );
-		png_destroy_write_struct( &png_ptr, &info_ptr );
-		fclose( out_file );
-		error_state = 1;
-		return;
-		}
-
-	/* Write PNG data */
-	png_write_png( png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL );
-
-	/* Delete allocated space */
-	free( row_pointers );
-	free( palette );
-
-	fclose(out_file);
 }
 #endif
 
@@ -0,0 +1,430 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Manifests of aggregated files.  With tens of thousands of input files,
+ * even opening each one at startup takes too long, and is hard on the
+ * file servers.  A manifest is a text file listing the member files along
+ * with what we need to know about each one without opening it: the length
+ * and units of its record dimension, and its schema fingerprint (see
+ * fi_schema_fingerprint).  Giving ncview a manifest is the same as giving
+ * it all the member files, except that members with the same fingerprint
+ * as the first file are not opened until something has to be read from
+ * them.  Until then their fdb->id is FI_ID_LAZY-k, k being the member's
+ * place in the manifest; fi_fdb_id gives the real id, opening the file if
+ * need be.  -write_manifest FILE writes a manifest of the input files.
+ *
+ * The format is a first line of NCVIEW-MANIFEST, then one line per file,
+ * with tabs between the fields:
+ *
+ *	path	record length	fingerprint (hex)	record dimension units	first value	step
+ *
+ * The last two say what the values of the record dimension are, so that
+ * they can be shown without opening the file.  If the values don't go
+ * evenly from the first by the step, both are empty, and the file is
+ * opened to read them; if there is no coordinate variable for the record
+ * dimension, the first value is "index".  The units and everything after
+ * them can be left out.  Lines starting with '#' are skipped.  Paths that
+ * don't start with '/' are relative to the directory of the manifest.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+#define MANIFEST_MAGIC		"NCVIEW-MANIFEST"
+#define MANIFEST_INDEX		"index"
+#define MANIFEST_N_FIELDS	6
+#define MANIFEST_LINE_LEN	(2*MAX_FILE_NAME_LEN)
+
+extern Options  options;
+
+typedef struct {
+	char			*filename;
+	size_t			rec_len;
+	unsigned long long	fingerprint;
+	char			*units;		/* NULL if none */
+	int			recvals;	/* RECVALS_*, and if RECVALS_EVEN, */
+	double			rec_first,	/* the values of the record */
+				rec_step;	/* dimension */
+	int			id;		/* once opened, else -1 */
+} ManifestMember;
+
+typedef struct {
+	ManifestMember	*m;
+	int		n, max;
+} ManifestList;
+
+/* The members of the manifests given on the command line, and the files
+ * to be written out with -write_manifest
+ */
+static ManifestList	members = { NULL, 0, 0 },
+			scanned = { NULL, 0, 0 };
+static int		next_member = 0;
+
+static int	manifest_is_manifest( char *filename );
+static void	manifest_read( char *filename, Stringlist **files, Stringlist **tail );
+static void	manifest_add_file( Stringlist **files, Stringlist **tail, char *filename );
+static void	manifest_list_add( ManifestList *list, char *filename, size_t rec_len,
+			unsigned long long fingerprint, char *units, int recvals, 
+			double rec_first, double rec_step );
+
+/*============================================================================*/
+/* Returns the list of input files with any manifests on it replaced by
+ * the files they list.
+ */
+	Stringlist *
+manifest_expand( Stringlist *input_files )
+{
+	Stringlist	*sl, *ret_val, *tail;
+
+	for( sl=input_files; sl != NULL; sl=sl->next )
+		if( manifest_is_manifest( sl->string ))
+			break;
+	if( sl == NULL )
+		return( input_files );
+
+	ret_val = NULL;
+	tail    = NULL;
+	for( sl=input_files; sl != NULL; sl=sl->next ) {
+		if( manifest_is_manifest( sl->string ))
+			manifest_read( sl->string, &ret_val, &tail );
+		else
+			manifest_add_file( &ret_val, &tail, sl->string );
+		}
+
+	if( ret_val == NULL ) {
+		fprintf( stderr, "ncview: the manifest lists no files\n" );
+		exit( -1 );
+		}
+
+	return( ret_val );
+}
+
+/*============================================================================*/
+/* If filename came from a manifest, returns which member it is and puts
+ * its record length and fingerprint in rec_len and fingerprint.  Returns
+ * -1 otherwise.  The files are usually asked about in the order they were
+ * listed, so that is tried first.
+ */
+	int
+manifest_member( char *filename, size_t *rec_len, unsigned long long *fingerprint )
+{
+	int	k;
+
+	if( members.n == 0 )
+		return( -1 );
+
+	k = -1;
+	if( (next_member < members.n) && (strcmp( members.m[next_member].filename, filename ) == 0) )
+		k = next_member;
+	else
+		{
+		for( k=0; k<members.n; k++ )
+			if( strcmp( members.m[k].filename, filename ) == 0 )
+				break;
+		if( k == members.n )
+			return( -1 );
+		}
+	next_member = k+1;
+
+	*rec_len     = members.m[k].rec_len;
+	*fingerprint = members.m[k].fingerprint;
+	return( k );
+}
+
+/*============================================================================*/
+/* The units of the record dimension of manifest member k, which can be NULL */
+	char *
+manifest_member_units( int k )
+{
+	return( members.m[k].units );
+}
+
+/*============================================================================*/
+/* What the manifest says about the values of the record dimension of member
+ * k: one of the RECVALS_*.  If RECVALS_EVEN, rec_first and rec_step are set.
+ */
+	int
+manifest_member_recvals( int k, double *rec_first, double *rec_step )
+{
+	if( (k < 0) || (k >= members.n) )
+		return( RECVALS_UNKNOWN );
+
+	*rec_first = members.m[k].rec_first;
+	*rec_step  = members.m[k].rec_step;
+	return( members.m[k].recvals );
+}
+
+/*============================================================================*/
+/* The file id of manifest member k, which is opened the first time this
+ * is asked for
+ */
+	int
+manifest_member_id( int k )
+{
+	if( (k < 0) || (k >= members.n) ) {
+		fprintf( stderr, "ncview: manifest_member_id: internal error, no manifest member %d\n", k );
+		exit( -1 );
+		}
+
+	if( members.m[k].id < 0 ) {
+		if( options.debug )
+			printf( "manifest_member_id: opening %s\n", members.m[k].filename );
+		members.m[k].id = netcdf_fi_initialize( members.m[k].filename );
+		}
+
+	return( members.m[k].id );
+}
+
+/*============================================================================*/
+/* Returns TRUE if manifest member k has been opened */
+	int
+manifest_member_is_open( int k )
+{
+	return( (k >= 0) && (k < members.n) && (members.m[k].id >= 0) );
+}
+
+/*============================================================================*/
+/* Remembers a file that has been read in, for -write_manifest */
+	void
+manifest_note_file( char *filename, size_t rec_len, unsigned long long fingerprint, char *units,
+		int recvals, double rec_first, double rec_step )
+{
+	manifest_list_add( &scanned, filename, rec_len, fingerprint, units, recvals, rec_first, rec_step );
+}
+
+/*============================================================================*/
+/* Writes a manifest of all the files that were read in to 'filename'.
+ * Relative file names are written out in full, since in the manifest
+ * they would be relative to where the manifest is.  Returns 0 on success,
+ * -1 on error.
+ */
+	int
+manifest_write( char *filename )
+{
+	FILE	*f;
+	int	k;
+	char	cwd[MAX_FILE_NAME_LEN];
+
+	if( getcwd( cwd, MAX_FILE_NAME_LEN ) == NULL ) {
+		fprintf( stderr, "Error, can't get the current directory to write the manifest\n" );
+		return( -1 );
+		}
+
+	if( (f = fopen( filename, "w" )) == NULL ) {
+		fprintf( stderr, "Error, can't open \"%s\" to write the manifest to\n", filename );
+		return( -1 );
+		}
+
+	fprintf( f, "%s\n", MANIFEST_MAGIC );
+	fprintf( f, "# path\trecord length\tschema fingerprint\trecord dimension units\tfirst value\tstep\n" );
+	for( k=0; k<scanned.n; k++ ) {
+		fprintf( f, "%s%s%s\t%ld\t%016llx\t%s\t", 
+			(scanned.m[k].filename[0] == '/') ? "" : cwd,
+			(scanned.m[k].filename[0] == '/') ? "" : "/",
+			scanned.m[k].filename, (long)scanned.m[k].rec_len,
+			scanned.m[k].fingerprint, (scanned.m[k].units == NULL) ? "" : scanned.m[k].units );
+		if( scanned.m[k].recvals == RECVALS_EVEN )
+			fprintf( f, "%.17g\t%.17g\n", scanned.m[k].rec_first, scanned.m[k].rec_step );
+		else if( scanned.m[k].recvals == RECVALS_INDEX )
+			fprintf( f, "%s\t\n", MANIFEST_INDEX );
+		else
+			fprintf( f, "\t\n" );
+		}
+
+	if( fclose( f ) != 0 ) {
+		fprintf( stderr, "Error writing the manifest to \"%s\"\n", filename );
+		return( -1 );
+		}
+
+	if( options.debug )
+		printf( "manifest_write: wrote %d files to %s\n", scanned.n, filename );
+	return( 0 );
+}
+
+/*============================================================================*/
+/* Returns TRUE if the file starts like a manifest */
+	static int
+manifest_is_manifest( char *filename )
+{
+	FILE	*f;
+	char	line[sizeof(MANIFEST_MAGIC)];
+	int	ret_val;
+
+	if( (f = fopen( filename, "r" )) == NULL )
+		return( FALSE );
+	ret_val = (fread( line, 1, strlen(MANIFEST_MAGIC), f ) == strlen(MANIFEST_MAGIC)) &&
+		  (strncmp( line, MANIFEST_MAGIC, strlen(MANIFEST_MAGIC) ) == 0);
+	fclose( f );
+
+	return( ret_val );
+}
+
+/*============================================================================*/
+/* Reads the manifest in 'filename', remembering its members and adding
+ * their names to the end of 'files', whose last element is 'tail'
+ */
+	static void
+manifest_read( char *filename, Stringlist **files, Stringlist **tail )
+{
+	FILE	*f;
+	char	line[MANIFEST_LINE_LEN], path[MAX_FILE_NAME_LEN], dirname[MAX_FILE_NAME_LEN],
+		*fields[MANIFEST_N_FIELDS], *s, *slash;
+	int	n_fields, line_no, n_read, recvals;
+	long	rec_len;
+	unsigned long long fingerprint;
+	double	rec_first, rec_step;
+
+	if( (f = fopen( filename, "r" )) == NULL ) {
+		fprintf( stderr, "ncview: can't open manifest %s", filename );
+		perror( " " );
+		exit( -1 );
+		}
+
+	/* Relative paths are relative to the manifest */
+	dirname[0] = '\0';
+	slash = strrchr( filename, '/' );
+	if( (slash != NULL) && (slash-filename < MAX_FILE_NAME_LEN-1) ) {
+		strncpy( dirname, filename, slash-filename+1 );
+		dirname[slash-filename+1] = '\0';
+		}
+
+	line_no = 0;
+	n_read  = 0;
+	while( fgets( line, MANIFEST_LINE_LEN, f ) != NULL ) {
+		line_no++;
+		if( (s = strchr( line, '\n' )) != NULL )
+			*s = '\0';
+		else if( ! feof( f )) {
+			fprintf( stderr, "ncview: line %d of manifest %s is too long\n", line_no, filename );
+			exit( -1 );
+			}
+		if( line_no == 1 )
+			continue;	/* the magic */
+		if( (line[0] == '#') || (line[0] == '\0') )
+			continue;
+
+		n_fields = 0;
+		s = line;
+		fields[n_fields++] = s;
+		while( (n_fields < MANIFEST_N_FIELDS) && ((s = strchr( s, '\t' )) != NULL) ) {
+			*s++ = '\0';
+			fields[n_fields++] = s;
+			}
+		if( (n_fields < 3) ||
+		    (sscanf( fields[1], "%ld", &rec_len ) != 1) || (rec_len < 0) ||
+		    (sscanf( fields[2], "%llx", &fingerprint ) != 1) ) {
+			fprintf( stderr, "ncview: can't understand line %d of manifest %s:\n%s\n",
+				line_no, filename, line );
+			exit( -1 );
+			}
+
+		recvals   = RECVALS_UNKNOWN;
+		rec_first = 0.0;
+		rec_step  = 0.0;
+		if( (n_fields >= 5) && (strcmp( fields[4], MANIFEST_INDEX ) == 0) )
+			recvals = RECVALS_INDEX;
+		else if( (n_fields == 6) && (sscanf( fields[4], "%lf", &rec_first ) == 1) &&
+			 (sscanf( fields[5], "%lf", &rec_step ) == 1) )
+			recvals = RECVALS_EVEN;
+
+		if( fields[0][0] == '/' )
+			snprintf( path, MAX_FILE_NAME_LEN, "%s", fields[0] );
+		else
+			snprintf( path, MAX_FILE_NAME_LEN, "%s%s", dirname, fields[0] );
+
+		manifest_list_add( &members, path, (size_t)rec_len, fingerprint,
+			((n_fields >= 4) && (fields[3][0] != '\0')) ? fields[3] : NULL,
+			recvals, rec_first, rec_step );
+		manifest_add_file( files, tail, path );
+		n_read++;
+		}
+	fclose( f );
+
+	if( options.debug )
+		printf( "manifest_read: read %d files from manifest %s\n", n_read, filename );
+}
+
+/*============================================================================*/
+/* Adds filename to the end of 'files', whose last element is '*tail'.
+ * stringlist_add_string walks to the end of the list it is given, so
+ * giving it the tail rather than the head keeps reading a manifest of
+ * many thousands of files from taking time that goes as the square.
+ */
+	static void
+manifest_add_file( Stringlist **files, Stringlist **tail, char *filename )
+{
+	int	err;
+
+	if( *tail == NULL )
+		err = stringlist_add_string( files, filename, NULL, SLTYPE_NULL );
+	else
+		err = stringlist_add_string( tail, filename, NULL, SLTYPE_NULL );
+	if( err != 0 ) {
+		fprintf( stderr, "ncview: manifest_add_file: failed to add %s to the list of files\n", filename );
+		exit( -1 );
+		}
+
+	if( *tail == NULL )
+		*tail = *files;
+	else
+		{
+		/* The index was counted from the tail */
+		((Stringlist *)((*tail)->next))->index = (*tail)->index + 1;
+		*tail = (*tail)->next;
+		}
+}
+
+/*============================================================================*/
+	static void
+manifest_list_add( ManifestList *list, char *filename, size_t rec_len,
+		unsigned long long fingerprint, char *units, int recvals, 
+		double rec_first, double rec_step )
+{
+	ManifestMember	*mm;
+
+	if( list->n == list->max ) {
+		list->max = (list->max == 0) ? 256 : 2*list->max;
+		list->m = (ManifestMember *)realloc( list->m, list->max * sizeof(ManifestMember) );
+		if( list->m == NULL ) {
+			fprintf( stderr, "ncview: manifest_list_add: failed to allocate space for %d files\n",
+				list->max );
+			exit( -1 );
+			}
+		}
+
+	mm = list->m + list->n;
+	mm->filename = (char *)malloc( strlen(filename)+1 );
+	strcpy( mm->filename, filename );
+	mm->rec_len     = rec_len;
+	mm->fingerprint = fingerprint;
+	mm->units       = NULL;
+	if( units != NULL ) {
+		mm->units = (char *)malloc( strlen(units)+1 );
+		strcpy( mm->units, units );
+		}
+	mm->recvals   = recvals;
+	mm->rec_first = rec_first;
+	mm->rec_step  = rec_step;
+	mm->id = -1;
+	list->n++;
+}
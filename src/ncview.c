@@ -59,6 +59,16 @@
 #define DEFAULT_BLOWUP_TYPE	BLOWUP_BILINEAR
 #define DEFAULT_SHRINK_METHOD	SHRINK_METHOD_MEAN
 #define DEFAULT_SAVEFRAMES	TRUE
+#define DEFAULT_PIXMAP_BUDGET_MB 0
+#define DEFAULT_DIRTY_TILE_SIZE	0
+#define DEFAULT_N_THREADS	0
+#define DEFAULT_VIEWPORT_TILE_SIZE 256
+#define DEFAULT_PROGRESSIVE_STRIDE 0
+#define DEFAULT_FRAME_DROP	TRUE
+#define DEFAULT_WATCH_INTERVAL	1000
+#define DEFAULT_WATCH_NEW_FILES	FALSE
+#define DEFAULT_RENDER_PROCS	1
+#define DEFAULT_STREAM_FPS	24
 #define DEFAULT_NO_AUTOFLIP	FALSE
 #define DEFAULT_LISTSEL_MAX	40
 #define DEFAULT_COLOR_BY_NDIMS	TRUE
@@ -81,7 +91,7 @@ static int any_var_in_group( NCVar *var );
 main( int argc, char **argv )
 {
 	Stringlist *input_files, *state_to_save;
-	int	   err, found_state_file;
+	int	   i, err, found_state_file, no_display;
 
 	/* Initialize misc constants */
 	initialize_misc();
@@ -96,14 +106,57 @@ main( int argc, char **argv )
 		found_state_file = FALSE;
 
 	options.blowup       = DEFAULT_BLOWUP;
-	in_parse_args               ( &argc, argv );
+
+	/* When rendering frames to files (-render) we don't use the 
+	 * display at all, so don't let X try to open one.  This has to
+	 * match the option the same way parse_options does.
+	 */
+	for( i=1; i<argc; i++ )
+		if( strncmp( argv[i], "-render", 7 ) == 0 )
+			options.render->doit = TRUE;
+
+	/* Converting an overlay file is all that is done with -convert_overlay */
+	for( i=1; i<argc; i++ )
+		if( strcmp( argv[i], "-convert_overlay" ) == 0 ) {
+			if( i >= argc-2 ) {
+				fprintf( stderr, "Error, -convert_overlay must be followed by the NCVIEW-OVERLAY text file and the binary file to write\n" );
+				exit( -1 );
+				}
+			exit( overlay_convert( argv[i+1], argv[i+2] ));
+			}
+
+	/* Nor does writing a manifest */
+	no_display = options.render->doit;
+	for( i=1; i<argc; i++ )
+		if( strncmp( argv[i], "-write_manifest", 15 ) == 0 )
+			no_display = TRUE;
+	if( ! no_display )
+		in_parse_args       ( &argc, argv );
+
 	input_files = parse_options ( argc,  argv );	/* This parses ALL the non-X11 command line options, not just the input files */
+	trace_init();
+	timing_init();	/* before -render, which times its frames too */
+	input_files = manifest_expand( input_files );	/* manifests on the list are replaced by the files in them */
 	determine_file_type         ( input_files );
 
 	options.window_title = input_files->string;
 
+	if( options.render->doit ) {
+		err = render_main( input_files );
+		timing_finish();
+		exit( err );
+		}
+
 	/* this routine sets up the 'variables' structure */
+	TRACE_BEGIN( "initialize_file_interface", NULL );
 	initialize_file_interface   ( input_files );
+	TRACE_END( "initialize_file_interface" );
+
+	if( options.write_manifest != NULL ) {
+		err = manifest_write( options.write_manifest );
+		timing_finish();
+		exit( err );
+		}
 
 	if( n_vars_in_list( variables ) == 0 ) {
 		fprintf( stderr, "no displayable variables found!\n" );
@@ -122,11 +175,15 @@ main( int argc, char **argv )
 
 	/* This initializes the colormaps, and then the X widows system */
 	if( options.debug ) printf( "Initializing display interface...\n" );
+	TRACE_BEGIN( "initialize_display_interface", NULL );
 	initialize_display_interface(); 
+	TRACE_END( "initialize_display_interface" );
 	if( options.debug ) printf( "Initializing printing subsystem...\n" );
 	print_init();
 	if( options.debug ) printf( "Initializing overlays...\n" );
+	TRACE_BEGIN( "overlay_init", NULL );
 	overlay_init();
+	TRACE_END( "overlay_init" );
 
 	/* If there is only one variable, make it the active one */
 	if( n_vars_in_list( variables ) == 1 ) {
@@ -203,6 +260,29 @@ parse_options( int argc, char *argv[] )
 				i++;
 				}
 
+			/* These have to come before -w */
+			else if( strncmp( argv[i], "-write_manifest", 15 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -write_manifest argument must be followed by the name of the manifest file to write\n" );
+					exit(-1);
+					}
+				options.write_manifest = argv[i+1];
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-watch_interval", 15 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.watch_interval) ) != 1) ||
+				    (options.watch_interval < 1) ) {
+					fprintf( stderr, "Error, -watch_interval argument must be followed by the time between checks in msec\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-watch_new_files", 16 ) == 0 )
+				options.watch_new_files = TRUE;
+
 			else if( strncmp( argv[i], "-w", 2 ) == 0 ) {
 				print_no_warranty();
 				exit( 0 );
@@ -252,6 +332,9 @@ parse_options( int argc, char *argv[] )
 			else if( strncmp( argv[i], "-shrink_mode", 12) == 0 )
 				options.shrink_method = SHRINK_METHOD_MODE;
 
+			else if( strncmp( argv[i], "-shrink_sample", 14) == 0 )
+				options.shrink_method = SHRINK_METHOD_SAMPLE;
+
 			else if( strncmp( argv[i], "-repl", 5) == 0 )
 				options.blowup_type = BLOWUP_REPLICATE;
 
@@ -260,6 +343,15 @@ parse_options( int argc, char *argv[] )
 				i++;
                                 }
 
+			else if( strncmp( argv[i], "-colormap", 9 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -colormap argument must be followed by the name of a colormap\n" );
+					exit(-1);
+					}
+				options.render->colormap = argv[i+1];
+				i++;
+				}
+
 			else if( strncmp( argv[i], "-c", 2 ) == 0 ) {
 				print_copying();
 				exit( 0 );
@@ -269,6 +361,10 @@ parse_options( int argc, char *argv[] )
 				options.color_by_ndims = FALSE;
 				}
 
+			else if( strncmp( argv[i], "-no_frame_drop", 14 ) == 0 ) {
+				options.frame_drop = FALSE;
+				}
+
 			else if( strncmp( argv[i], "-no_auto_overlay", 7 ) == 0 ) {
 				options.auto_overlay = FALSE;
 				}
@@ -287,6 +383,190 @@ parse_options( int argc, char *argv[] )
 				i++;
 				}
 
+			else if( strncmp( argv[i], "-pixmap_mb", 10 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.pixmap_budget_mb) ) != 1) ||
+				    (options.pixmap_budget_mb < 0) ) {
+					fprintf( stderr, "Error, -pixmap_mb argument must be followed by a non-negative integer (megabytes)\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-dirty_tiles", 12 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.dirty_tile_size) ) != 1) ||
+				    (options.dirty_tile_size < 0) ) {
+					fprintf( stderr, "Error, -dirty_tiles argument must be followed by the tile size in pixels (0 to disable)\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-progressive", 12 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.progressive_stride) ) != 1) ||
+				    (options.progressive_stride < 0) ) {
+					fprintf( stderr, "Error, -progressive argument must be followed by how many points to skip in the preview (0 to disable)\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-overlay_cache", 14 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -overlay_cache argument must be followed by the directory to keep overlay files in\n" );
+					exit(-1);
+					}
+				options.overlay_cache_dir = argv[i+1];
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-pyramid", 8 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -pyramid argument must be followed by the directory to keep pyramid files in\n" );
+					exit(-1);
+					}
+				options.pyramid_dir = argv[i+1];
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-viewport_tiles", 15 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.viewport_tile_size) ) != 1) ||
+				    (options.viewport_tile_size < 0) ) {
+					fprintf( stderr, "Error, -viewport_tiles argument must be followed by the tile size in pixels (0 to disable)\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-threads", 8 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.n_threads) ) != 1) ||
+				    (options.n_threads < 0) ) {
+					fprintf( stderr, "Error, -threads argument must be followed by the number of threads to use (0 for automatic)\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-timings", 8 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -timings argument must be followed by the name of the CSV file to write\n" );
+					exit(-1);
+					}
+				options.timings_file = argv[i+1];
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-trace", 6 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -trace argument must be followed by the name of the file to write the trace to\n" );
+					exit(-1);
+					}
+#ifdef NO_TRACE
+				fprintf( stderr, "Warning, this copy of ncview was compiled without tracing; -trace ignored\n" );
+#else
+				options.trace_file = argv[i+1];
+#endif
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-png_level", 10 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.png_level) ) != 1) ||
+				    (options.png_level < 0) || (options.png_level > 9) ) {
+					fprintf( stderr, "Error, -png_level argument must be followed by a compression level from 0 to 9\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-png_filter", 11 ) == 0 ) {
+				if( (i == (argc-1)) || ((options.png_filter = png_parse_filter( argv[i+1] )) < 0) ) {
+					fprintf( stderr, "Error, -png_filter argument must be followed by none, sub, up, avg, paeth, or all\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-stream_fmt", 11 ) == 0 ) {
+				if( (i == (argc-1)) || ((options.stream_format = stream_parse_format( argv[i+1] )) < 0) ) {
+					fprintf( stderr, "Error, -stream_fmt argument must be followed by y4m or rgb\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-stream", 7 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -stream argument must be followed by the file or FIFO to write to, or - for standard output\n" );
+					exit(-1);
+					}
+				options.stream_file = argv[i+1];
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-fps", 4 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.stream_fps) ) != 1) ||
+				    (options.stream_fps < 1) ) {
+					fprintf( stderr, "Error, -fps argument must be followed by the number of frames per second\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-render", 7 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -render argument must be followed by the name of the variable to render\n" );
+					exit(-1);
+					}
+				options.render->doit     = TRUE;
+				options.render->var_name = argv[i+1];
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-slices", 7 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%ld:%ld:%ld", &(options.render->first),
+						&(options.render->last), &(options.render->stride) ) < 2) ) {
+					fprintf( stderr, "Error, -slices argument must be followed by FIRST:LAST or FIRST:LAST:STEP (frames numbered from 1)\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-procs", 6 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%d", &(options.render->n_procs) ) != 1) ||
+				    (options.render->n_procs < 1) ) {
+					fprintf( stderr, "Error, -procs argument must be followed by the number of processes to render with\n" );
+					exit(-1);
+					}
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-outdir", 7 ) == 0 ) {
+				if( i == (argc-1) ) {
+					fprintf( stderr, "Error, -outdir argument must be followed by a directory name\n" );
+					exit(-1);
+					}
+				options.render->outdir = argv[i+1];
+				i++;
+				}
+
+			else if( strncmp( argv[i], "-range", 6 ) == 0 ) {
+				if( (i == (argc-1)) ||
+				    (sscanf( argv[i+1], "%f,%f", &(options.render->min), &(options.render->max) ) != 2) ) {
+					fprintf( stderr, "Error, -range argument must be followed by MIN,MAX\n" );
+					exit(-1);
+					}
+				options.render->have_range = TRUE;
+				i++;
+				}
+
 			else if( strncmp( argv[i], "-listsel_max", 7 ) == 0 ) {
 				sscanf( argv[i+1], "%d", &(options.listsel_max) );
 				i++;
@@ -391,6 +671,24 @@ initialize_misc()
 	options.small  		 = FALSE;
 	options.blowup_type      = DEFAULT_BLOWUP_TYPE;
 	options.save_frames      = DEFAULT_SAVEFRAMES;
+	options.pixmap_budget_mb = DEFAULT_PIXMAP_BUDGET_MB;
+	options.dirty_tile_size  = DEFAULT_DIRTY_TILE_SIZE;
+	options.n_threads        = DEFAULT_N_THREADS;
+	options.viewport_tile_size = DEFAULT_VIEWPORT_TILE_SIZE;
+	options.pyramid_dir      = NULL;
+	options.overlay_cache_dir = NULL;
+	options.write_manifest   = NULL;
+	options.progressive_stride = DEFAULT_PROGRESSIVE_STRIDE;
+	options.frame_drop       = DEFAULT_FRAME_DROP;
+	options.watch_interval   = DEFAULT_WATCH_INTERVAL;
+	options.watch_new_files  = DEFAULT_WATCH_NEW_FILES;
+	options.timings_file     = NULL;
+	options.trace_file       = NULL;
+	options.stream_file      = NULL;
+	options.stream_format    = STREAM_Y4M;
+	options.stream_fps       = DEFAULT_STREAM_FPS;
+	options.png_level        = -1;
+	options.png_filter       = -1;
 	options.no_autoflip      = DEFAULT_NO_AUTOFLIP;
 	options.t_conv      	 = TRUE;
 	options.varsel_style	 = VARSEL_LIST;
@@ -407,6 +705,17 @@ initialize_misc()
 	options.overlay->doit    = FALSE;
 	options.overlay->overlay = NULL;
 
+	options.render             = (RenderOptions *)malloc( sizeof( RenderOptions ));
+	options.render->doit       = FALSE;
+	options.render->var_name   = NULL;
+	options.render->first      = 1L;
+	options.render->last       = 0L;
+	options.render->stride     = 1L;
+	options.render->n_procs    = DEFAULT_RENDER_PROCS;
+	options.render->outdir     = NULL;
+	options.render->colormap   = NULL;
+	options.render->have_range = FALSE;
+
 	options.maxsize_pct	 = 75;	/* maximum size of a window, in percent of screen, before switching to scrollbars */
 
 	/* Set default color to use for missing data */
@@ -675,7 +984,9 @@ initialize_file_interface( Stringlist *input_files )
 		}
 	if( options.debug ) 
 		printf( "...calculating dim min & maxes...\n" );
+	TRACE_BEGIN( "calc_dim_minmaxes", NULL );
 	calc_dim_minmaxes();
+	TRACE_END( "calc_dim_minmaxes" );
 
 	/* Get the effective dimensionality of all the vars.
 	 * Can't do this before we have read in all of the
@@ -690,9 +1001,8 @@ initialize_file_interface( Stringlist *input_files )
 			if( *(var->size + idim) > 1 )
 				var->effective_dimensionality++;
 			if( options.debug ) 
-				printf( "var %s has %d dims, dim %d: >%s< len %ld\n",
-					var->name, var->n_dims, idim, 
-					var->dim[idim]->name, var->dim[idim]->size );
+				printf( "var %s has %d dims, dim %d: len %ld\n",
+					var->name, var->n_dims, idim, *(var->size + idim) );
 			}
 		if( options.debug ) {
 			printf( "variable %s had effective_dimensionality of %d\n",
@@ -705,7 +1015,9 @@ initialize_file_interface( Stringlist *input_files )
 	 * gather any scalar coordinate information (which
 	 * might possibly change in each file)
 	 */
+	TRACE_BEGIN( "cache_scalar_coord_info", NULL );
 	cache_scalar_coord_info( variables );
+	TRACE_END( "cache_scalar_coord_info" );
 
 	if( nvars > options.listsel_max )
 		options.varsel_style = VARSEL_MENU;
@@ -718,7 +1030,9 @@ initialize_file_interface( Stringlist *input_files )
 	void
 initialize_display_interface()
 {
+	TRACE_BEGIN( "initialize_colormaps", NULL );
 	initialize_colormaps();
+	TRACE_END( "initialize_colormaps" );
 
 	/* Make the colormaps in the program congruent in order
 	 * and "enabled-ness" with the read-in state
@@ -726,7 +1040,9 @@ initialize_display_interface()
 	x_check_legal_colormap_loaded();
 
 	if( options.debug ) printf( "...initializing X interface\n" );
+	TRACE_BEGIN( "in_initialize", NULL );
 	in_initialize();
+	TRACE_END( "in_initialize" );
 	if( options.debug ) printf( "...done with initializing X interface\n" );
 }
 
@@ -743,6 +1059,11 @@ process_user_input()
 	void
 quit_app()
 {
+#ifdef HAVE_PNG
+	png_queue_finish();
+#endif
+	stream_finish();
+	timing_finish();
 	exit( 0 );
 }
 
@@ -811,6 +1132,7 @@ fprintf( stderr, "	-private: Use a private colormap.\n" );
 fprintf( stderr, "	-debug: Print lots of debugging info.\n" );
 fprintf( stderr, "	-beep: 	Ring the bell when the movie restarts at frame zero.\n" );
 fprintf( stderr, "	-pause_on_restart: Pause playback when the movie restarts at frame zero.\n" );
+fprintf( stderr, "	-no_frame_drop: Show every frame during playback, even if that is slower than the delay asks for.\n" );
 fprintf( stderr, "	-extra: Put some extra information on the display window.\n" );
 fprintf( stderr, "	-mtitle: My title to use on the display window.\n" );
 fprintf( stderr, "	-noautoflip: Do not automatically flip image, even\n" );
@@ -819,6 +1141,8 @@ fprintf( stderr, "	-w: 	print the lack-of-warranty blurb.\n" );
 fprintf( stderr, "	-small: Keep popup window as small as possible by default.\n" );
 fprintf( stderr, "	-shrink_mode: Shrink image assuming integer classes, so most common\n" );
 fprintf( stderr, "		value in sub-block returned instead of arithmetic mean.\n" );
+fprintf( stderr, "	-shrink_sample: Shrink image by only reading every Nth point from the file.\n" );
+fprintf( stderr, "		Much faster for a quick look at very large fields, but not exact.\n" );
 fprintf( stderr, "	-listsel_max NN: max number of vars allowed before switching to menu selection\n");
 fprintf( stderr, "	-no_color_ndims: do NOT color the var selection buttons by their dimensionality\n" );
 fprintf( stderr, "	-no_auto_overlay: do NOT automatically put on continental overlays\n" );
@@ -827,6 +1151,42 @@ fprintf( stderr, "	-missvalrgb RRR GGG BBB: specifies 3 integers (range: 0 to 25
 fprintf( stderr, "	-maxsize: specifies max size of window before scrollbars are added. Either a single\n" );
 fprintf( stderr, "              integer between 30 and 100 giving percentage, or two integers separated by a\n" );
 fprintf( stderr, "              comma giving width and height. Ex: -maxsize 75  or -maxsize 800,600\n" );
+fprintf( stderr, "	-pixmap_mb NN: keep up to NN MB of recently drawn frames on the X server for fast stepping\n" );
+fprintf( stderr, "	-dirty_tiles NN: only send the NNxNN pixel tiles that changed since the last frame\n" );
+fprintf( stderr, "		to the display; speeds up playback over a remote X connection\n" );
+fprintf( stderr, "	-viewport_tiles NN: when the blown-up image is much bigger than the window, only make the\n" );
+fprintf( stderr, "		NNxNN pixel tiles that are scrolled into view (default: %d; 0 to always make the whole image)\n", DEFAULT_VIEWPORT_TILE_SIZE );
+fprintf( stderr, "	-pyramid DIR: when shrinking big fields by averaging, save the shrunken versions in DIR\n" );
+fprintf( stderr, "		the first time each slice is viewed, and shrink from those afterwards\n" );
+fprintf( stderr, "	-convert_overlay IN OUT: convert NCVIEW-OVERLAY text file IN to a binary overlay file OUT,\n" );
+fprintf( stderr, "		which can be used as a custom overlay and is quicker to read, then exit\n" );
+fprintf( stderr, "	-overlay_cache DIR: save the overlays made for each grid in DIR, so they don't have to be\n" );
+fprintf( stderr, "		made again next time\n" );
+fprintf( stderr, "	-progressive NN: for big slices, first show every NN'th point, then read the rest in the\n" );
+fprintf( stderr, "		background; helps with compressed or remote files (default: off)\n" );
+fprintf( stderr, "	-write_manifest FILE: write a manifest of the input files to FILE, then exit.  Giving\n" );
+fprintf( stderr, "		the manifest in place of the files starts up without opening them all\n" );
+fprintf( stderr, "	-watch_interval NN: when paused on the last frame, check every NN msec whether the\n" );
+fprintf( stderr, "		last file has grown (default: %d)\n", DEFAULT_WATCH_INTERVAL );
+fprintf( stderr, "	-watch_new_files: also add new files that turn up next to the last file, and sort\n" );
+fprintf( stderr, "		after it, as more timesteps\n" );
+fprintf( stderr, "	-threads NN: number of threads to use when converting images for display,\n" );
+fprintf( stderr, "		and for writing PNG frames (default: automatic)\n" );
+fprintf( stderr, "	-timings FILE: write how long each stage of drawing each frame took to FILE, in CSV format\n" );
+fprintf( stderr, "	-trace FILE: write a timeline of the session to FILE, for viewing in chrome://tracing or Perfetto\n" );
+fprintf( stderr, "	-png_level N: compression level (0-9) of PNG frames; 1 is much faster than the default\n" );
+fprintf( stderr, "	-png_filter none|sub|up|avg|paeth|all: filters to use when compressing PNG frames\n" );
+fprintf( stderr, "	-stream FILE: write each frame drawn to FILE (a file, FIFO, or - for standard output)\n" );
+fprintf( stderr, "		as an uncompressed video stream, to pipe into a movie encoder.  Also works with -render.\n" );
+fprintf( stderr, "		-stream_fmt y4m|rgb: YUV4MPEG2 (default) or raw 24-bit RGB\n" );
+fprintf( stderr, "		-fps NN: frame rate of the stream (default: %d)\n", DEFAULT_STREAM_FPS );
+fprintf( stderr, "	-render VAR: without using a display, write frames of VAR to frame.NNNNN.png files, then exit.\n" );
+fprintf( stderr, "		These options go with -render:\n" );
+fprintf( stderr, "		-slices FIRST:LAST[:STEP]: frames along the scan dimension to render, numbered from 1\n" );
+fprintf( stderr, "		-procs NN: spread the frames across NN processes\n" );
+fprintf( stderr, "		-outdir DIR: directory to put the frames in\n" );
+fprintf( stderr, "		-range MIN,MAX: data range for the colormap (default: calculated as usual)\n" );
+fprintf( stderr, "		-colormap NAME: colormap to use\n" );
 fprintf( stderr, "	-c: 	print the copying policy.\n" );
 fprintf( stderr, "	-scale: Useful for changing units; scale data by this factor\n" );
 fprintf( stderr, "	-offset: Useful for changing units; offset data by this factor (Ex: -scale 1.8 -offset 32 converts C to F)\n" );
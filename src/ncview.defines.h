@@ -135,6 +135,21 @@
 /* Maximum name length of a file */
 #define MAX_FILE_NAME_LEN	4095
 
+/*****************************************************************************/
+/* File ids of FI_ID_LAZY-k and below are member k of a manifest, which
+ * is opened when first needed; see fi_fdb_id.
+ */
+#define FI_ID_LAZY		(-2)
+
+/* What a manifest knows about the values of a member's record dimension */
+#define RECVALS_UNKNOWN		0	/* nothing; the file has to be read */
+#define RECVALS_EVEN		1	/* they go evenly from a first value by a step */
+#define RECVALS_INDEX		2	/* there is no coordinate var, so they are the place */
+
+/*****************************************************************************/
+/* Starting value for util_hash_bytes (FNV-1a) */
+#define UTIL_HASH_INIT		14695981039346656037ULL
+
 /*****************************************************************************/
 /* Maximum name length of a recdim units */
 #define MAX_RECDIM_UNITS_LEN	4095
@@ -204,6 +219,7 @@
  */
 #define SHRINK_METHOD_MEAN	0
 #define SHRINK_METHOD_MODE	1
+#define SHRINK_METHOD_SAMPLE	2	/* only read every N'th point from the file; fast, for previews */
 
 /*********************************************************************
  * Possible states which the data inside the current buffer can be in
@@ -211,6 +227,7 @@
 #define VDS_VALID	1
 #define VDS_INVALID	2
 #define VDS_EDITED	3
+#define VDS_PREVIEW	4	/* a coarse stand-in while the full data is read (progressive.c) */
 
 /*******************************************************************
  * Where postscript output can go.
@@ -271,6 +288,37 @@ typedef unsigned char ncv_pixel;/* If you change this, make sure to change
 				 * X routines do also.
 				 */
 
+/*****************************************************************************/
+/* What we know about each input file that is the same for all the variables
+ * in it.  Each variable has its own FDBlist for the file, which points here.
+ */
+typedef struct _NCFile {
+	char	*filename;
+	int	id;		/* internally used ID number (FI_ID_LAZY-k if not opened yet) */
+	size_t	rec_len;	/* length of the record dimension, 0 if none */
+	int	have_recdim_units; /* TRUE once recdim_units has been looked up */
+	char	*recdim_units;	/* can be NULL */
+#ifdef HAVE_UDUNITS2
+	ut_unit	*ut_unit_ptr;	/* only non-null if ut_parse worked on these units */
+#endif
+	struct _NCFile *next;
+} NCFile;
+
+/*****************************************************************************/
+/* Which file each timestep of a variable is in.  Shared between variables
+ * whose files hold the same number of timesteps each.
+ */
+typedef struct _NCTimestepMap {
+	int	n_files;
+	NCFile	**files;
+	size_t	*file_start;	/* the first timestep in each file; n_files+1 entries */
+	size_t	n_ts;
+	int	*ts_file;	/* which file (0 to n_files-1) each timestep is in */
+	unsigned long long hash; /* of the files and how many timesteps each holds */
+	int	n_refs;		/* how many vars use this */
+	struct _NCTimestepMap *next;
+} NCTimestepMap;
+
 /*****************************************************************************/
 /* This describes the file which the relevant variable lives in */
 typedef struct {
@@ -278,9 +326,13 @@ typedef struct {
 	int	id;		/* internally used ID number */
 	int	index;		/* starts at 0, increments by 1 for each file associated
 				 * with this variable */
-	char	*filename;
-	void	*aux_data;	/* For specific datafile implementations */
+	NCFile	*file;		/* what is shared with the other vars in this file */
+	char	*filename;	/* points to file->filename */
+	void	*aux_data;	/* For specific datafile implementations.  Files with the
+				 * same schema as the first share the first file's */
 	size_t	*var_size;	/* Multi-dimensional size of variables which live in this file */
+	int	var_size_shared; /* TRUE if var_size belongs to an earlier file of this var,
+				 * which has the same size */
 	float	data_min, data_max; /* for a specific variable in the file */
 
 	/* Following is an ugly hack for an ugly problem.  Basically, different files can have
@@ -288,11 +340,18 @@ typedef struct {
 	 * we must store the recdim units for each file.  In a way this is a property more of
 	 * the dimensions, so maybe should be in the NCDim structure somehow, but the units live
 	 * in each file and have a 1-1 association with each file, so I'm putting them here.
+	 * For vars in the root group, these point to the ones in 'file'.
 	 */
 	char	*recdim_units;
 #ifdef HAVE_UDUNITS2
 	ut_unit	*ut_unit_ptr;	/* only non-null if ut_parse worked on these units */
+	int	recdim_conv;	/* How to put recdim values in the units of the var's first file:
+				 * 0 not worked out yet, 1 with recdim_scale and recdim_offset,
+				 * -1 only by going through the calendar for each value */
+	double	recdim_scale, recdim_offset;
 #endif
+	int	same_schema;	/* TRUE if the file has the same schema fingerprint as the
+				 * first file, so its aux_data is the same as there */
 } FDBlist;	
 
 /*****************************************************************************
@@ -324,6 +383,13 @@ typedef struct {
 	int	units_change;	/* if 1, then a virtully concatenated timelike dimension has different units in different input files */
 	float	min, max, *values;
 	int	have_calc_minmax;  /* 0 initially, 1 after min & max have been calculated */
+	double	*time_values;	/* timelike dims only: the values in double precision, in the
+				 * units of the first file.  NULL until calculated */
+	size_t	n_time_values;
+	int	time_order;	/* 1 if time_values increase, -1 if they decrease, 0 if neither */
+	int	has_bounds;	/* 1 if the dim's values come from a bounds var, so labels show the bounds;
+				 * from the first file.  -1 until known */
+	int	char_values;	/* TRUE if the dim's values are strings; then 'values' are just the index */
 	size_t	size;
 	int	timelike;	/* 0 if NOT timelike, 1 if is.  If is, MUST */
 				/* have an identified time standard (below). */
@@ -334,6 +400,22 @@ typedef struct {
 	int	is_lat, is_lon; /* Just a guess if these are lat/lon. Used to put on coastlines automatically */
 } NCDim;
 
+/*****************************************************************************/
+/* The values of a 2-D coordinate variable (such as lon(y,x)), shared by
+ * all the variables it maps.  There is one per file, coordinate variable,
+ * and shape; the values are only read when first needed.
+ */
+typedef struct ncv_coord_cache {
+	char	*filename;		/* file the coordinate variable is in */
+	int	ncid;
+	char	*coord_var_name;
+	int	ndims;
+	size_t	*size;			/* (MULTIDIMENSIONAL) size of the coordinate variable */
+	float	*data;			/* NULL until first needed */
+	int	n_refs;			/* number of NCDim_map_info's using this */
+	struct ncv_coord_cache *next;
+} NCCoordCache;
+
 /*****************************************************************************/
 /* A dimension can be "mapped", by which it means that, for example, the lat
  * or lon coordinates are two dimensional, and a variable is supplied that
@@ -348,7 +430,9 @@ typedef struct {
 	char	*coord_var_units;	/* if the coord var has a units att, this records it */
 	size_t	*coord_var_size;	/* size of the mapping var (MULTIDIMENSIONAL) */
 	int	*matching_var_dims;	/* This has n_dims equal to the DATA VARIABLE, NOT the coord var! */
-	float	*data_cache;		/* Cached info from the mapping var */
+	float	*data_cache;		/* Cached info from the mapping var; for 2-D mapping vars,
+					 * NULL until dim_map_data() is called */
+	NCCoordCache *coord_cache;	/* for 2-D mapping vars, the shared values; otherwise NULL */
 	size_t	*index_place_factor;	/* Array of size var_i_map->n_dims, is 0 or factor to mult loc by */
 	int	scalar_all_same;	/* ==1 iff is a scalar coord var AND all vals are identical; ==0 otherwise */
 	
@@ -377,22 +461,18 @@ typedef struct {
 						 * in more than one input file, false
 						 * otherwise.
 						 */
-	FDBlist **timestep_2_fdb;		/* Files can only be virtually concatenated
+	NCTimestepMap *ts_map;			/* Files can only be virtually concatenated
 	  					 * along the first (timelike) dimension.
-						 * This gives pointers to the FDBlist 
-						 * elements that each individual timestep
-						 * of the var lives in. So it is dimension
-						 * size[0]. Note that many entries can 
-						 * point to the same target. For example,
-						 * if a sequency of data files with a year's
-						 * worth of monthly data is given, then
-						 * the first 12 entries of this will all
-						 * point to the first file's FDBlist.
+						 * This says which file each timestep of
+						 * the var lives in, as an index into
+						 * fdb_by_index.  Vars whose files hold the
+						 * same number of timesteps each share one.
 						 * Because this can only be filled out
 						 * AFTER we have processed all the files,
 						 * it is done in a slighly strange place...
 						 * in routine cache_scalar_coord_info.
 						 */
+	FDBlist	**fdb_by_index;			/* The var's FDBlists, by their index */
 	float	global_min, global_max,		/* These are diffferent from the */
 	        user_min, user_max;	 	/* min & max in the FDBs because these
 					 	* are global, rather than local to
@@ -450,6 +530,17 @@ typedef struct {
 						   'scalar_dim_map_info' array for
 						   this var.
 						*/
+	int	have_details;			/* FALSE until var_fill_details has
+						   been called.  Until then, only the
+						   name, size, and files of the var
+						   are known; 'dim' and 'dim_map_info'
+						   are NULL.
+						*/
+	int	recdim_index;			/* Which dim is the record dimension
+						   in the first file, or -1 if none.
+						   Files with the same schema as the
+						   first differ only in its length.
+						*/
 } NCVar;
 
 /*****************************************************************************/
@@ -460,7 +551,11 @@ typedef struct {
 	size_t	*var_place;	/* Where we currently are in that var's space, in that file */
 	void	*data;		/* The actual 2-D data to colorcontour */
 	int	data_status;	/* Either valid, invalid, or edited (changed) */
+	int	data_stride;	/* If > 1, data only holds every data_stride'th point in X and Y (SHRINK_METHOD_SAMPLE),
+				 * or averages over data_stride by data_stride blocks from the pyramid (SHRINK_METHOD_MEAN) */
 	unsigned char *pixels;	/* Scaled, replicated, byte array version of data */
+	size_t	n_pixels;	/* How many pixels 'pixels' has room for.  Big images drawn a tile
+				 * at a time don't need it, so it is only allocated when used */
 	int	x_axis_id, 	/* which axes the 2-D data lies on.  'scan' */
 		y_axis_id,	/* is the one accessed by the pushbuttons */
 		scan_axis_id;
@@ -481,15 +576,49 @@ typedef struct {
 	int	*frame_valid;	/* Is this particular frame valid? */
 } FrameStore;
 
+/*****************************************************************************
+ * Bucket grid over the 2-D X and Y values of a mapped (curvilinear) grid,
+ * for finding the cell nearest to each overlay point (overlay_index.c)
+ */
+typedef struct {
+	char	x_name[MAX_NC_NAME], y_name[MAX_NC_NAME];	/* what grid this is */
+	size_t	nx, ny;
+	float	*xvals, *yvals;		/* X and Y of each cell, nx*ny */
+	float	xmin, xmax, ymin, ymax;	/* extent of the cells with good values */
+	long	nbx, nby;		/* number of buckets across and down */
+	float	bw, bh;			/* bucket width and height */
+	long	*bucket_start;		/* cells of bucket b are cell_id[bucket_start[b]..bucket_start[b+1]-1] */
+	long	*cell_id;
+} OverlayIndex;
+
 /*****************************************************************************/
 /* program options */
 
-/* Options for the overlay feature */
+/* Options for the overlay feature.  The overlay has one bit for each
+ * point of the grid, set where the overlay is drawn.
+ */
 typedef struct {
 	int	doit;
-	int	*overlay;
+	unsigned char *overlay;
 } OverlayOptions;
 
+#define OVERLAY_NBYTES(n)	(((n)+7)/8)
+#define OVERLAY_GET(ov,i)	(((ov)[(i)>>3] >> ((i)&7)) & 1)
+#define OVERLAY_SET(ov,i)	((ov)[(i)>>3] |= (unsigned char)(1 << ((i)&7)))
+
+/* Options for rendering frames straight to files, without a display (-render) */
+typedef struct {
+	int	doit;
+	char	*var_name;	/* variable to render */
+	long	first, last,	/* frames to render along the scan axis; 1-based and */
+		stride;		/* inclusive, with last <= 0 meaning through the end */
+	int	n_procs;	/* number of worker processes to spread the frames across */
+	char	*outdir;	/* directory to write the frame.NNNNN.png files to */
+	char	*colormap;	/* name of colormap to use, or NULL for the first one */
+	int	have_range;	/* if TRUE, use min and max instead of calculating the range */
+	float	min, max;
+} RenderOptions;
+
 typedef struct {
 	int	invert_physical,
 		invert_colors,
@@ -534,6 +663,24 @@ typedef struct {
 	int	autoscale;	/* If TRUE, then tries to automatically scale colors for EACH frame.  Much slower!! */
 
 	int	save_frames;	/* If true, try to save frames in core for faster display */
+	int	pixmap_budget_mb; /* Max MB of X server pixmaps holding recently drawn frames; 0 disables */
+	int	dirty_tile_size; /* If > 0, only send changed tiles of this many pixels on a side to the display */
+	char	*pyramid_dir;	/* If not NULL, keep pyramids of shrunken big fields in this directory */
+	char	*overlay_cache_dir; /* If not NULL, keep the overlays made for each grid in this directory */
+	char	*write_manifest; /* If not NULL, write a manifest of the input files to this file and exit */
+	int	viewport_tile_size; /* If > 0, make only the visible tiles, this many pixels on a side, of big blown-up images */
+	int	progressive_stride; /* If > 1, first show every this many'th point of big slices, then read the rest */
+	int	frame_drop;	/* If TRUE, playback that falls behind skips frames to keep up */
+	int	watch_interval;	/* msec between checks of the last file for new data */
+	int	watch_new_files; /* If TRUE, new files next to the last file are added as more timesteps */
+	int	n_threads;	/* Threads to use for image conversion; 0 means pick based on # of processors */
+	char	*timings_file;	/* If not NULL, write per-frame timings of each drawing stage to this CSV file */
+	char	*trace_file;	/* If not NULL, write a trace of the session to this file in Chrome trace JSON format */
+	char	*stream_file;	/* If not NULL, write frames as a video stream to this file ("-" for stdout) */
+	int	stream_format;	/* STREAM_Y4M or STREAM_RGB */
+	int	stream_fps;	/* frame rate recorded in the stream */
+	int	png_level;	/* zlib compression level for PNG frames, or -1 for the default */
+	int	png_filter;	/* libpng filter flags for PNG frames, or -1 for the default */
 	float	frame_delay;	/* Normalied to be between 0.0 and 1.0 */
 
 	int	enable_group_sel;	/* TRUE if we have some vars in groups, so interface must incl. grp selection */
@@ -544,6 +691,7 @@ typedef struct {
 				/* SCALE IS APPLIED FIRST. So to conv C to F, use -scale 1.8 -offset 32 */
 
 	OverlayOptions *overlay;
+	RenderOptions  *render;
 } Options;
 
 /***********************************************************************************************************/
@@ -590,6 +738,37 @@ typedef struct {
                 mask_blue;
 } Server_Info;
 
+/*****************************************************************************************************/
+/* The idle-time work procedures, which can be active at the same time; see in_workproc_set */
+#define WORKPROC_PLAYBACK	0	/* rendering ahead of the animation */
+#define WORKPROC_REFINE		1	/* reading the rest of a progressively shown slice */
+#define N_WORKPROCS		2
+
+/*****************************************************************************************************/
+/* Stages of drawing a frame that are timed separately; see timing.c */
+#define TIMING_READ		0	/* reading the data from the file */
+#define TIMING_EXPAND		1	/* expanding or shrinking the data to the display size */
+#define TIMING_COLORIZE		2	/* converting data values to pixels */
+#define TIMING_TRUECOLOR	3	/* converting pixels to the TrueColor image format */
+#define TIMING_XFER		4	/* handing the image to the X server */
+#define TIMING_TOTAL		5	/* the whole frame */
+#define N_TIMING_STAGES		6
+
+/* Marks around things that are recorded in the session trace (-trace FILE).
+ * Compile with -DNO_TRACE to take them out entirely.
+ */
+#ifdef NO_TRACE
+#define TRACE_BEGIN(name,detail)
+#define TRACE_END(name)
+#else
+#define TRACE_BEGIN(name,detail)	trace_begin( (name), (detail) )
+#define TRACE_END(name)			trace_end( (name) )
+#endif
+
+/* Formats for the video stream of frames (-stream FILE); see stream.c */
+#define STREAM_Y4M		1	/* YUV4MPEG2, 4:4:4 */
+#define STREAM_RGB		2	/* headerless packed 24-bit RGB */
+
 /*****************************************************************************************************/
 /* This structure holds information about MY list of colormaps (as opposed to standard X window
  * colormaps).
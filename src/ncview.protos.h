@@ -49,6 +49,7 @@ Stringlist *fi_list_vars ( int fileid );
 int	fi_n_dims	 ( int fileid, char *var_name );
 size_t	*fi_var_size	 ( int fileid, char *var_name );
 void 	fi_get_data      ( NCVar *var, size_t *start_pos, size_t *count, void *data );
+void 	fi_get_data_strided( NCVar *var, size_t *start_pos, size_t *count, ptrdiff_t *stride, void *data );
 void 	fi_close         ( int fileid );
 void	determine_file_type( Stringlist *input_files );
 Stringlist *fi_scannable_dims( int fileid, char *var_name );
@@ -62,17 +63,24 @@ char 	*fi_dim_longname ( int fileid, char *dim_name );
 nc_type fi_dim_value     ( NCVar *v, int dim_id, size_t place, double *ret_val_double, char *ret_val_char, 
 				int *return_has_bounds, double *return_bounds_min, double *return_bounds_max,
 				size_t *complete_ndim_virt_place );
+nc_type fi_dim_values    ( NCVar *v, int dim_id, double *values );
 char 	*fi_dim_id_to_name( int fileid, char *var_name, int dim_id );
 int 	fi_dim_name_to_id( int fileid, char *var_name, char *dim_name );
 size_t 	fi_n_dim_entries ( int fileid, char *dim_name );
 void 	fi_fill_aux_data ( int id, char *var_name, FDBlist *fdb );
 void 	fi_fill_value	 ( NCVar *var, float *fillval );
 int 	fi_recdim_id     ( int fileid );
+int	fi_var_recdim_index( int fileid, char *var_name );
+char	*fi_recdim_units ( int fileid, char *var_name );
+unsigned long long fi_schema_fingerprint( int fileid, size_t *rec_len );
+int	fi_fdb_id	 ( FDBlist *fdb );
+int	fi_fdb_is_open	 ( FDBlist *fdb );
 
 /******************************************************************************
  * in file_netcdf.c, netcdf specific routines 
  */
 char *  netcdf_att_string       ( int fileid, char *var_name );
+void	safe_strcat		( char *dest, size_t dest_len, char *src );
 char *  netcdf_global_att_string( int fileid );
 int 	netcdf_fi_confirm	( char *name );
 int 	netcdf_fi_writable	( char *name );
@@ -82,7 +90,10 @@ int	netcdf_fi_n_dims	( int fileid, char *var_name );
 size_t	*netcdf_fi_var_size	( int fileid, char *var_name );
 void 	netcdf_fi_get_data	( int fileid, char *var_name, size_t *start_pos, 
 						size_t *count, float *data, NetCDFOptions *aux_data );
+void 	netcdf_fi_get_data_strided( int fileid, char *var_name, size_t *start_pos, 
+						size_t *count, ptrdiff_t *stride, float *data, NetCDFOptions *aux_data );
 void	netcdf_fi_close		( int fileid );
+size_t	*netcdf_fi_var_size_now	( int fileid, char *filename, char *var_name );
 int 	netcdf_n_dims 		( int cdfid, char *varname );
 char	*netcdf_varindex_to_name( int cdfid, int index );
 Stringlist *netcdf_scannable_dims( int fileid, char *var_name );
@@ -95,6 +106,8 @@ int 	netcdf_has_dim_values   ( int fileid, char *dim_name );
 char 	*netcdf_dim_longname 	( int fileid, char *dim_name );
 nc_type	netcdf_dim_value     	( int fileid, char *dim_name, size_t place, double *ret_val_double, char *ret_val_char, 
 				  size_t virt_place, int *has_bounds, double *return_bounds_min, double *return_bounds_max  );
+nc_type	netcdf_dim_values     	( int fileid, char *dim_name, size_t place, size_t count,
+				  size_t virt_place, double *ret_vals );
 char 	*netcdf_dim_id_to_name  ( int fileid, char *var_name, int dim_id );
 int 	netcdf_dim_name_to_id   ( int fileid, char *var_name, char *dim_name );
 size_t 	netcdf_n_dim_entries    ( int fileid, char *dim_name );
@@ -104,6 +117,10 @@ int	netcdf_min_option_set	( NCVar *var, float *ret_min );
 int	netcdf_max_option_set	( NCVar *var, float *ret_max );
 void 	netcdf_fill_value	( int file_id, char *var_name, float *v, NetCDFOptions *opts );
 int 	netcdf_fi_recdim_id     ( int fileid );
+int	netcdf_fi_var_recdim_index( int id, char *var_name );
+char	*netcdf_fi_recdim_units ( int id, char *var_name );
+int	netcdf_fi_recdim_values( int id, size_t rec_len, double *first, double *step );
+unsigned long long netcdf_fi_schema_fingerprint( int fileid, size_t *rec_len );
 int 	netcdf_dimvar_bounds_id ( int fileid, char *dim_name, int *nvertices );
 char 	*netcdf_dim_calendar( int fileid, char *dim_name );
 int 	safe_ncvarid( int fileid, char *varname );
@@ -112,9 +129,13 @@ int 	safe_ncvarid( int fileid, char *varname );
  * in util.c, general utility routines
  */
 int 	close_enough	   ( float data, float fill );
-void 	new_fdblist        ( FDBlist **el );
+void 	new_fdblist        ( FDBlist **el, NCFile *file, void *aux_data );
+NCFile	*ncfile_add	   ( char *filename, int id, size_t rec_len );
+void	fdb_own_var_size   ( NCVar *var, FDBlist *fdb );
 void 	new_netcdf         ( NetCDFOptions **n );
 int	data_to_pixels     ( View *v );
+void	data_to_pixels_rect( View *v, size_t x0, size_t y0, size_t width, size_t height, ncv_pixel *pixels );
+int	data_check_range   ( View *v );
 void	add_var_to_list    ( char *var_name, int file_id, char *filename, int nfiles );
 NCVar	*get_var	   ( char *var_name );
 void	add_to_varlist     ( NCVar **list, NCVar *new_var );
@@ -122,10 +143,13 @@ void	init_min_max	   ( NCVar *var );
 void	clip_f		   ( float *val, float min, float max );
 void	clip_i		   ( int   *val, int   min, int   max );
 void 	fill_dim_structs   ( NCVar *v );
+float	*dim_map_data	   ( NCDim_map_info *dmi );
 void 	expand_data	   ( float *big_data, View *v, size_t array_size );
+void 	expand_data_array  ( float *big_data, float *little, size_t nxl, size_t nyl, float fill_val,
+				size_t array_size );
 void 	check_ranges       ( NCVar *var );
 char 	*limit_string	   ( char *s );
-int 	*gen_overlay       ( View *v, char *overlay_fname );
+unsigned char *gen_overlay  ( View *v, char *overlay_fname );
 void 	fmt_time	   ( char *temp_string, size_t temp_string_len, double new_dimval, NCDim *dim, int include_granularity );
 int	n_vars_in_list	   ( NCVar *v );
 void 	set_blowup_type	   ( int new_type );
@@ -134,21 +158,32 @@ int 	strncmp_nocase     ( char *s1, char *s2, size_t n );
 int 	warn_if_file_exits ( char *fname );
 void 	virt_to_actual_place( NCVar *var, size_t *virt_pl, size_t *act_pl, FDBlist **file );
 void 	calc_dim_minmaxes   ( void );
+int	dim_fill_time_values( NCVar *v, int dimid );
+size_t	dim_nearest_time    ( NCDim *d, double val );
+int	parse_time	    ( char *s, NCDim *dim, double *val );
 void    add_vars_to_list    ( Stringlist *var_list, int id, char *filename, int nfiles );
+void    add_vars_to_list_same_schema( Stringlist *var_list, int id, char *filename );
 int     is_scannable        ( NCVar *v, int i );
 void 	sl_cat		    ( Stringlist **dest, Stringlist **src );
 void 	get_min_max_onestep( NCVar *var, size_t n_other, size_t tstep, float *data, 
 					float *min, float *max, int verbose );
 int 	unpack_groupname( char *varname, int ig, char *groupname );
 void 	cache_scalar_coord_info( NCVar *vars );
+void	var_fill_details   ( NCVar *var );
+void	fill_timestep_map   ( NCVar *v );
+FDBlist	*timestep_fdb	    ( NCVar *v, size_t ts );
+size_t	add_new_file_to_vars( NCVar *var, char *new_filename );
 int 	count_nslashes	    ( char *s );
 Stringlist *get_group_list  ( NCVar *vars );
 void 	varname_no_groups   ( char *varname, char *varname_sans_groups, char *groupname );
+double	util_time_msec	    ( void );
+unsigned long long util_hash_bytes( unsigned long long h, void *p, size_t n );
 
 /******************************************************************************
  * in interface.c 
  */
 void 	in_change_current	( char *dim_name, int modifier );
+void 	in_jump_current		( char *dim_name );
 void 	in_change_dat		( size_t index, float new_val );
 void 	in_display_stuff	( char *s, char *var_name );
 void 	in_set_edit_place	( size_t index, int x, int y, int nx, int ny );
@@ -164,6 +199,11 @@ void	in_draw_2d_field 	( unsigned char *data, size_t width, size_t height,
 void	in_create_colormap	( char *name, ncv_pixel r[256], ncv_pixel g[256], ncv_pixel b[256] );
 char	*in_install_next_colormap( int do_widgets_flag );
 int	in_set_2d_size   	( size_t width, size_t height );
+int	in_pixmap_ring_draw	( size_t frameno, size_t width, size_t height );
+void	in_pixmap_ring_invalidate( void );
+void	in_pixmap_ring_forget	( size_t frameno );
+void	in_get_visible_area	( size_t *x, size_t *y, size_t *width, size_t *height );
+void	in_draw_2d_tile		( ncv_pixel *data, size_t x, size_t y, size_t width, size_t height );
 void 	in_variable_selected	( char *var_name );
 void	in_set_sensitive	( int button_id, int state );
 void	in_make_dim_buttons	( Stringlist *dim_list );
@@ -188,6 +228,8 @@ void	in_popdown_2d_window	( void );
 void 	in_timer_clear		( void );
 int	in_report_auto_overlay  ( void );
 void 	in_timer_set            ( XtTimerCallbackProc procedure, XtPointer arg, unsigned long delay_millisec );
+void 	in_workproc_clear	( int id );
+void 	in_workproc_set         ( int id, XtWorkProc procedure, XtPointer arg );
 char    *in_install_prev_colormap( int do_widgets );
 void 	in_data_edit_dump	( void );
 
@@ -207,6 +249,7 @@ void	do_backwards      ( int modifier );
 void	do_pause          ( int modifier );
 void	do_forward        ( int modifier );
 void	do_fastforward    ( int modifier );
+char	*playback_status  ( void );
 void	do_colormap_sel   ( int modifier );
 void	do_invert_physical( int modifier );
 void	do_invert_colormap( int modifier );
@@ -229,6 +272,12 @@ void	x_set_speed_proc	( Widget scrollbar, XtPointer client_data, XtPointer posit
 void	x_draw_2d_field		( unsigned char *data, size_t width, size_t height,
 	size_t timestep );
 void	x_set_2d_size 		( size_t width, size_t height );
+int	x_pixmap_ring_draw	( size_t frameno, size_t width, size_t height );
+void	x_pixmap_ring_invalidate( void );
+void	x_pixmap_ring_forget	( size_t frameno );
+void	x_dirty_tiles_reset	( void );
+void	x_get_visible_area	( size_t *x, size_t *y, size_t *width, size_t *height );
+void	x_draw_2d_tile		( unsigned char *data, size_t x, size_t y, size_t width, size_t height );
 void    x_indicate_active_var   ( char *var_name );
 void    *x_create_default_colormap( void );
 void 	x_add_to_cmap_list	( char *name, Colormap new_colormap );
@@ -260,6 +309,8 @@ void 	x_draw_colorbar		( void );
 void 	x_create_colorbar       ( float user_min, float user_max, int transform );
 void    x_timer_clear           ( void );
 void    x_timer_set             ( XtTimerCallbackProc procedure, XtPointer client_arg, unsigned long delay_millisec );
+void    x_workproc_clear        ( int id );
+void    x_workproc_set          ( int id, XtWorkProc procedure, XtPointer client_arg );
 void    x_indicate_active_var   ( char *var_name );
 int     x_dialog                ( char *message, char *ret_string, int want_cancel_button );
 
@@ -280,6 +331,7 @@ void 	set_scan_view        ( size_t scan_place );
 int 	change_view          ( int delta, int interpretation );
 int	view_draw            ( int allow_saveframes_useage, int force_range_to_frame );
 void 	view_change_cur_dim  ( char *dim_name, int modifier );
+void 	view_jump_cur_dim    ( char *dim_name );
 void	view_forward         ( void );
 void	view_backward        ( void );
 void	view_change_blowup   ( int delta, int redraw_flag, int view_var_is_valid );
@@ -300,6 +352,8 @@ void	view_set_XY_plot_axis( String );
 void	view_plot_XY_fmt_x_val( float val, int dimindex, char *s, size_t slen );
 void 	view_change_dat	     ( size_t index, float new_val );
 void	view_get_scaled_size ( int blowup, size_t old_nx, size_t old_ny, size_t *new_nx, size_t *new_ny );
+void	view_data_size       ( View *v, size_t *nx, size_t *ny );
+void	view_set_refined_data( float *data );
 void 	view_change_transform( int delta );
 void 	view_recompute_colorbar( void );
 void    view_set_range_frame ( void );
@@ -308,6 +362,12 @@ void    view_set_scan_dims   ( void );
 void 	view_data_edit       ( void );
 void 	view_information     ( void );
 long 	view_current_nt      ( void );
+int	view_prerender_frame ( size_t frameno );
+long	view_current_scan_place( void );
+long	view_next_scan_place ( long place, int delta );
+View	*view_new_offscreen  ( NCVar *var );
+int	view_render_offscreen( View *v, size_t scan_place );
+ncv_pixel *view_whole_image  ( void );
 
 
 /******************************************************************************
@@ -319,6 +379,14 @@ int 	overlay_current		( void );
 int 	overlay_n_overlays	( void );
 void 	determine_overlay_base_dir( char *overlay_base_dir, int n );
 int 	overlay_custom_n	( void );
+int	overlay_convert		( char *text_fname, char *bin_fname );
+void	overlay_draw		( View *v, size_t x0, size_t y0, size_t width, size_t height, ncv_pixel *pixels );
+
+/******************************************************************************
+ * in overlay_index.c
+ */
+OverlayIndex *overlay_index_for_view( View *v );
+void	overlay_index_query	( OverlayIndex *idx, float *pts, long npts, long *cell );
 
 /******************************************************************************
  * in set_options.c
@@ -358,6 +426,7 @@ void 	udu_utinit( char *path );
 int 	udu_utistime( char *dimname, char *units );
 int 	udu_calc_tgran( int fileid, NCVar *v, int dimid );
 void 	udu_fmt_time( char *temp_string, size_t temp_string_len, double new_dimval, NCDim *dim, int include_granularity );
+int 	udu_parse_time( char *s, NCDim *dim, double *val );
 
 /******************************************************************************
  * in epic_time.c
@@ -402,6 +471,7 @@ char *cbar_data();
  * in interface/make_tc_data.c
  */
 void make_tc_data( unsigned char *data, long width, long height, XColor *color_list, unsigned char *tc_data );
+void make_tc_lut( XColor *color_list );
 
 /******************************************************************************
  * in interface/colormap_funcs.c
@@ -416,6 +486,91 @@ void 	x_check_legal_colormap_loaded();
 void 	delete_cmaplist( Cmaplist *cml );
 int 	colormap_options_to_stringlist( Stringlist **sl );
 
+/******************************************************************************
+ * in timing.c
+ */
+void	timing_init	    ( void );
+void	timing_add	    ( int stage, double t_start );
+void	timing_frame_done   ( char *var_name, long scan_place );
+void	timing_frame_abort  ( void );
+void	timing_report	    ( char *s, size_t len );
+void	timing_summary	    ( char *s, size_t len );
+void	timing_finish	    ( void );
+void	trace_init	    ( void );
+void	trace_begin	    ( char *name, char *detail );
+void	trace_end	    ( char *name );
+void	trace_finish	    ( void );
+void	timing_detach	    ( void );
+
+/******************************************************************************
+ * in render.c
+ */
+int	render_main	    ( Stringlist *input_files );
+int	write_png_file	    ( char *filename, unsigned char *data, size_t width, size_t height,
+				XColor *color_list, int n_palette );
+int	png_queue_frame	    ( char *filename, unsigned char *data, size_t width, size_t height,
+				XColor *color_list, int n_palette );
+int	png_queue_finish    ( void );
+int	png_parse_filter    ( char *s );
+
+/******************************************************************************
+ * in stream.c
+ */
+int	stream_parse_format ( char *s );
+FILE	*stream_open	    ( char *name );
+int	stream_header	    ( char *buf, int len, int format, size_t width, size_t height, int fps );
+unsigned char *stream_convert( unsigned char *pixels, size_t width, size_t height,
+				XColor *color_list, int n_colors, int format, size_t *nbytes );
+void	stream_display_frame( unsigned char *pixels, size_t width, size_t height,
+				XColor *color_list, int n_colors );
+void	stream_finish	    ( void );
+
+/******************************************************************************
+ * in tiles.c
+ */
+int	view_tiles_active   ( View *v );
+void	view_tiles_invalidate( void );
+void	view_tiles_forget   ( size_t frameno );
+int	view_tiles_prepare  ( View *v );
+void	view_tiles_draw	    ( View *v, size_t frameno, size_t width, size_t height );
+
+/******************************************************************************
+ * in pyramid.c
+ */
+int	pyramid_stride_wanted( View *v );
+int	pyramid_read	    ( View *v, int stride );
+int	pyramid_build	    ( View *v );
+
+/******************************************************************************
+ * in progressive.c
+ */
+int	progressive_wanted  ( View *v );
+void	progressive_start   ( View *v );
+int	progressive_pending ( void );
+void	progressive_cancel  ( void );
+
+/******************************************************************************
+ * in watch.c
+ */
+void	watch_file	    ( char *filename );
+void	watch_stop	    ( void );
+int	watch_file_changed  ( void );
+int	watch_new_file	    ( char *new_filename, int len );
+unsigned long watch_interval( void );
+
+/******************************************************************************
+ * in manifest.c
+ */
+Stringlist *manifest_expand ( Stringlist *input_files );
+int	manifest_member	    ( char *filename, size_t *rec_len, unsigned long long *fingerprint );
+char	*manifest_member_units( int k );
+int	manifest_member_id  ( int k );
+int	manifest_member_is_open( int k );
+void	manifest_note_file  ( char *filename, size_t rec_len, unsigned long long fingerprint, char *units,
+				int recvals, double rec_first, double rec_step );
+int	manifest_member_recvals( int k, double *rec_first, double *rec_step );
+int	manifest_write	    ( char *filename );
+
 /******************************************************************************
  * in handle_rc_file.c
  */
@@ -24,6 +24,8 @@
 #include "ncview.defines.h"
 #include "ncview.protos.h"
 
+#include <sys/mman.h>
+
 /* These are the arrays of coastline and outline data build into ncview
  * (i.e, they are NOT required to be loaded from an external directory)
  */
@@ -42,14 +44,82 @@ char *my_overlay_names[] = { "None",
 
 extern View  	*view;
 extern Options  options;
+extern ncv_pixel *pixel_transform;
 
 static int	my_current_overlay;
 
-static int 	gen_xform( float value, int n, float *dimvals );
-static int 	*gen_overlay_internal( View *v, float *data, long n );
-static void 	do_overlay_inner( View *v, float *data, long nvals, int suppress_screen_changes );
-static void 	overlay_find_closest_pt( size_t point_number, float locx, float locy, float *xvals, float *yvals, size_t nx, size_t ny,
-			size_t *idxx, size_t *idxy );
+/* Overlays made recently, so going back to one, or to another variable
+ * on the same grid, doesn't make it again.  The one in use is never
+ * dropped from the cache.
+ */
+#define OVERLAY_CACHE_N		8
+#define OVERLAY_FILE_MAGIC	"NCVOVL1"
+
+typedef struct {
+	unsigned long long key;		/* which overlay on which grid; see overlay_key */
+	size_t		nx, ny;
+	unsigned char	*overlay;	/* NULL if this entry is unused */
+	unsigned long	last_used;
+} OverlayCacheEntry;
+
+/* Header of an overlay file saved in options.overlay_cache_dir; the
+ * overlay follows, OVERLAY_NBYTES(nx*ny) bytes of it.
+ */
+typedef struct {
+	char		magic[8];
+	unsigned long long key;
+	size_t		nx, ny;
+} OverlayFileHeader;
+
+/* The part of the scaled image that overlay_draw is drawing into */
+typedef struct {
+	long		x0, y0, width, height;
+	long		new_ny;		/* rows in the whole scaled image */
+	ncv_pixel	*pixels, pix;
+} OverlayDrawArea;
+
+/* Binary overlay files, made from NCVIEW-OVERLAY text files with
+ * -convert_overlay.  The points are grouped into tiles, and after the
+ * header comes the index of the tiles, then the points (an X, Y pair of
+ * floats each), tile by tile.  The file is mapped into memory, and only
+ * the points of the tiles that overlap the grid are looked at.
+ */
+#define OVERLAY_BIN_MAGIC	"NCVOVB1"
+#define OVERLAY_BIN_BYTE_ORDER	0x01020304
+#define OVERLAY_BIN_TILE_POINTS	4096L	/* about how many points to put in a tile */
+#define OVERLAY_BIN_MAX_TILES	64	/* along X and along Y */
+
+typedef struct {
+	char		magic[8];
+	unsigned int	byte_order;	/* OVERLAY_BIN_BYTE_ORDER, as written by the machine that made it */
+	unsigned int	n_tiles;
+	float		xmin, xmax, ymin, ymax;
+	unsigned long long n_points;
+} OverlayBinHeader;
+
+typedef struct {
+	float		xmin, xmax, ymin, ymax;	/* of the points in the tile */
+	unsigned long long first, n;		/* the tile's points, counting from the first point in the file */
+} OverlayBinTile;
+
+static OverlayCacheEntry overlay_cache[OVERLAY_CACHE_N];
+static unsigned long	overlay_cache_use_count = 0L;
+
+static int 	gen_xform( float value, int n, float *dimvals, int monotonic );
+static int	gen_axis_monotonic( int n, float *dimvals );
+static unsigned char *gen_overlay_internal( View *v, float *data, long n );
+static void	gen_overlay_add_points( View *v, float *data, long nvals, unsigned char *overlay );
+static unsigned char *gen_overlay_binary( View *v, char *overlay_fname );
+static long	overlay_read_text( char *overlay_fname, float **data, char *err_mess, int len );
+static void 	do_overlay_inner( View *v, int n, char *custom_filename, float *data, long nvals,
+			int suppress_screen_changes );
+static unsigned char *overlay_get( View *v, int n, char *custom_filename, float *data, long nvals );
+static int	overlay_key( View *v, int n, char *custom_filename, unsigned long long *key );
+static unsigned char *overlay_cache_find( unsigned long long key, size_t nx, size_t ny );
+static void	overlay_cache_add( unsigned long long key, size_t nx, size_t ny, unsigned char *overlay );
+static void	overlay_plot( OverlayDrawArea *a, long sx, long sy );
+static unsigned char *overlay_file_read( unsigned long long key, size_t nx, size_t ny );
+static void	overlay_file_write( unsigned long long key, size_t nx, size_t ny, unsigned char *overlay );
 
 /*====================================================================================
  * This routine is only called when the state of the overlay is being changed
@@ -62,14 +132,13 @@ do_overlay( int n, char *custom_filename, int suppress_screen_changes )
 		return;
 		}
 
-	/* Free space for previous overlay */
-	if( options.overlay->doit && (options.overlay->overlay != NULL ))
-		free( options.overlay->overlay );
+	/* The previous overlay stays in the cache, which owns it */
 
 	switch(n) {
 		
 		case OVERLAY_NONE:
-			options.overlay->doit = FALSE;
+			options.overlay->doit    = FALSE;
+			options.overlay->overlay = NULL;
 			if( ! suppress_screen_changes ) {
 				view->data_status = VDS_INVALID;
 				invalidate_all_saveframes();
@@ -78,17 +147,17 @@ do_overlay( int n, char *custom_filename, int suppress_screen_changes )
 			break;
 
 		case OVERLAY_P8DEG:
-			do_overlay_inner( view, overlay_coasts_p8deg, n_overlay_coasts_p8deg,
+			do_overlay_inner( view, n, NULL, overlay_coasts_p8deg, n_overlay_coasts_p8deg,
 					suppress_screen_changes );
 			break;
 
 		case OVERLAY_P08DEG:
-			do_overlay_inner( view, overlay_coasts_p08deg, n_overlay_coasts_p08deg,
+			do_overlay_inner( view, n, NULL, overlay_coasts_p08deg, n_overlay_coasts_p08deg,
 					suppress_screen_changes );
 			break;
 
 		case OVERLAY_USA:
-			do_overlay_inner( view, overlay_usa, n_overlay_usa,
+			do_overlay_inner( view, n, NULL, overlay_usa, n_overlay_usa,
 					suppress_screen_changes );
 			break;
 
@@ -97,14 +166,7 @@ do_overlay( int n, char *custom_filename, int suppress_screen_changes )
 				in_error( "Specified custom overlay filename is not a valid filename!\n" );
 				return;
 				}
-			options.overlay->overlay = gen_overlay( view, custom_filename ); 
-			if( options.overlay->overlay != NULL ) {
-				options.overlay->doit = TRUE;
-				if( ! suppress_screen_changes ) {
-					invalidate_all_saveframes();
-					change_view( 0, FRAMES );
-					}
-				}
+			do_overlay_inner( view, n, custom_filename, NULL, 0L, suppress_screen_changes );
 			break;
 
 		default:
@@ -116,13 +178,18 @@ do_overlay( int n, char *custom_filename, int suppress_screen_changes )
 }
 
 /*=========================================================================================
+ * Puts on overlay 'n'.  For the built-in overlays, the points are in 'data'; 
+ * for a custom overlay, they are read from custom_filename.
  * NOTE: 'nvals' is the total number of data values in array data.  Since there are
  * two data values per location, nvals is TWICE the number of locations.
  */
 	void
-do_overlay_inner( View *v, float *data, long nvals, int suppress_screen_changes )
+do_overlay_inner( View *v, int n, char *custom_filename, float *data, long nvals, 
+		int suppress_screen_changes )
 {
-	options.overlay->overlay = gen_overlay_internal( v, data, nvals );
+	TRACE_BEGIN( "gen_overlay", custom_filename );
+	options.overlay->overlay = overlay_get( v, n, custom_filename, data, nvals );
+	TRACE_END( "gen_overlay" );
 	if( options.overlay->overlay != NULL ) {
 		options.overlay->doit = TRUE;
 		if( ! suppress_screen_changes ) {
@@ -132,6 +199,354 @@ do_overlay_inner( View *v, float *data, long nvals, int suppress_screen_changes
 		}
 }
 
+/*=========================================================================================
+ * Returns overlay 'n' for the grid of the view, from the cache if we have it,
+ * then from the overlay cache directory, and otherwise by making it.
+ */
+	static unsigned char *
+overlay_get( View *v, int n, char *custom_filename, float *data, long nvals )
+{
+	unsigned long long key;
+	size_t	nx, ny;
+	unsigned char *overlay;
+
+	nx = *(v->variable->size + v->x_axis_id);
+	ny = *(v->variable->size + v->y_axis_id);
+
+	if( ! overlay_key( v, n, custom_filename, &key )) {
+		/* Can't tell what it is, so just make it */
+		if( n == OVERLAY_CUSTOM )
+			return( gen_overlay( v, custom_filename ));
+		return( gen_overlay_internal( v, data, nvals ));
+		}
+
+	if( (overlay = overlay_cache_find( key, nx, ny )) != NULL ) {
+		if( options.debug )
+			printf( "overlay_get: overlay %d for %s is in the cache\n", n, v->variable->name );
+		return( overlay );
+		}
+
+	if( (overlay = overlay_file_read( key, nx, ny )) == NULL ) {
+		if( n == OVERLAY_CUSTOM )
+			overlay = gen_overlay( v, custom_filename );
+		else
+			overlay = gen_overlay_internal( v, data, nvals );
+		if( overlay == NULL )
+			return( NULL );
+		overlay_file_write( key, nx, ny, overlay );
+		}
+
+	overlay_cache_add( key, nx, ny, overlay );
+	return( overlay );
+}
+
+/*=========================================================================================
+ * Works out the key for overlay 'n' on the grid of the view: a hash of the
+ * overlay (for a custom overlay, the file's name, size, and modification
+ * time) and of the grid's X and Y values.  For mapped grids, those are the
+ * 2-D values held by the overlay index.  Returns FALSE if we can't tell.
+ */
+	static int
+overlay_key( View *v, int n, char *custom_filename, unsigned long long *key )
+{
+	unsigned long long h;
+	struct stat	st;
+	NCDim		*dim_x, *dim_y;
+	OverlayIndex	*idx;
+	size_t		nx, ny;
+
+	dim_x = *(v->variable->dim + v->x_axis_id);
+	dim_y = *(v->variable->dim + v->y_axis_id);
+	nx = *(v->variable->size + v->x_axis_id);
+	ny = *(v->variable->size + v->y_axis_id);
+
+	h = UTIL_HASH_INIT;
+	h = util_hash_bytes( h, &n, sizeof(int) );
+	if( n == OVERLAY_CUSTOM ) {
+		if( stat( custom_filename, &st ) != 0 )
+			return( FALSE );
+		h = util_hash_bytes( h, custom_filename, strlen( custom_filename ));
+		h = util_hash_bytes( h, &(st.st_size),  sizeof(st.st_size) );
+		h = util_hash_bytes( h, &(st.st_mtime), sizeof(st.st_mtime) );
+		}
+
+	h = util_hash_bytes( h, &nx, sizeof(size_t) );
+	h = util_hash_bytes( h, &ny, sizeof(size_t) );
+	if( (v->variable->dim_map_info[ v->x_axis_id ] != NULL) || 
+	    (v->variable->dim_map_info[ v->y_axis_id ] != NULL) ) {
+		idx = overlay_index_for_view( v );
+		h = util_hash_bytes( h, idx->xvals, nx*ny*sizeof(float) );
+		h = util_hash_bytes( h, idx->yvals, nx*ny*sizeof(float) );
+		}
+	else
+		{
+		if( (dim_x->values == NULL) || (dim_y->values == NULL) )
+			return( FALSE );
+		h = util_hash_bytes( h, dim_x->values, nx*sizeof(float) );
+		h = util_hash_bytes( h, dim_y->values, ny*sizeof(float) );
+		}
+
+	*key = h;
+	return( TRUE );
+}
+
+/*=========================================================================================*/
+	static unsigned char *
+overlay_cache_find( unsigned long long key, size_t nx, size_t ny )
+{
+	int	i;
+
+	for( i=0; i<OVERLAY_CACHE_N; i++ )
+		if( (overlay_cache[i].overlay != NULL) && (overlay_cache[i].key == key) &&
+		    (overlay_cache[i].nx == nx) && (overlay_cache[i].ny == ny) ) {
+			overlay_cache[i].last_used = ++overlay_cache_use_count;
+			return( overlay_cache[i].overlay );
+			}
+	return( NULL );
+}
+
+/*=========================================================================================
+ * Puts the overlay in the cache in place of the one used least recently,
+ * other than the one in use now.
+ */
+	static void
+overlay_cache_add( unsigned long long key, size_t nx, size_t ny, unsigned char *overlay )
+{
+	int	i, oldest;
+
+	oldest = -1;
+	for( i=0; i<OVERLAY_CACHE_N; i++ ) {
+		if( overlay_cache[i].overlay == NULL ) {
+			oldest = i;
+			break;
+			}
+		if( overlay_cache[i].overlay == options.overlay->overlay )
+			continue;
+		if( (oldest == -1) || (overlay_cache[i].last_used < overlay_cache[oldest].last_used) )
+			oldest = i;
+		}
+
+	if( overlay_cache[oldest].overlay != NULL )
+		free( overlay_cache[oldest].overlay );
+	overlay_cache[oldest].key       = key;
+	overlay_cache[oldest].nx        = nx;
+	overlay_cache[oldest].ny        = ny;
+	overlay_cache[oldest].overlay   = overlay;
+	overlay_cache[oldest].last_used = ++overlay_cache_use_count;
+}
+
+/*=========================================================================================
+ * Reads the overlay from options.overlay_cache_dir, if it's there.  Returns
+ * NULL if not.
+ */
+	static unsigned char *
+overlay_file_read( unsigned long long key, size_t nx, size_t ny )
+{
+	char		path[MAX_FILE_NAME_LEN];
+	FILE		*f;
+	OverlayFileHeader hdr;
+	unsigned char	*overlay;
+	size_t		nbytes;
+
+	if( options.overlay_cache_dir == NULL )
+		return( NULL );
+
+	snprintf( path, MAX_FILE_NAME_LEN, "%s/ncview_%016llx.ovl", options.overlay_cache_dir, key );
+	if( (f = fopen( path, "r" )) == NULL )
+		return( NULL );
+
+	nbytes = OVERLAY_NBYTES( nx*ny );
+	overlay = (unsigned char *)malloc( nbytes );
+	if( (overlay != NULL) && (fread( &hdr, sizeof(hdr), 1, f ) == 1) && 
+	    (strncmp( hdr.magic, OVERLAY_FILE_MAGIC, 8 ) == 0) &&
+	    (hdr.key == key) && (hdr.nx == nx) && (hdr.ny == ny) &&
+	    (fread( overlay, 1, nbytes, f ) == nbytes) ) {
+		if( options.debug )
+			printf( "overlay_file_read: read overlay from %s\n", path );
+		}
+	else if( overlay != NULL ) {
+		free( overlay );
+		overlay = NULL;
+		}
+	fclose( f );
+
+	return( overlay );
+}
+
+/*=========================================================================================
+ * Saves the overlay in options.overlay_cache_dir, if there is one.  It is
+ * written to a temporary file first, so no one sees a partial file.
+ */
+	static void
+overlay_file_write( unsigned long long key, size_t nx, size_t ny, unsigned char *overlay )
+{
+	char		path[MAX_FILE_NAME_LEN], tmp_path[MAX_FILE_NAME_LEN];
+	FILE		*f;
+	OverlayFileHeader hdr;
+	size_t		nbytes;
+	int		ok;
+
+	if( options.overlay_cache_dir == NULL )
+		return;
+
+	nbytes = OVERLAY_NBYTES( nx*ny );
+
+	memset( &hdr, 0, sizeof(hdr) );
+	strncpy( hdr.magic, OVERLAY_FILE_MAGIC, 8 );
+	hdr.key = key;
+	hdr.nx  = nx;
+	hdr.ny  = ny;
+
+	snprintf( path,     MAX_FILE_NAME_LEN, "%s/ncview_%016llx.ovl", options.overlay_cache_dir, key );
+	snprintf( tmp_path, MAX_FILE_NAME_LEN, "%s/ncview_%016llx.ovl.%ld", options.overlay_cache_dir, key, (long)getpid() );
+	ok = FALSE;
+	if( (f = fopen( tmp_path, "w" )) != NULL ) {
+		ok = (fwrite( &hdr, sizeof(hdr), 1, f ) == 1) && (fwrite( overlay, 1, nbytes, f ) == nbytes);
+		ok = (fclose( f ) == 0) && ok;
+		if( ok )
+			ok = (rename( tmp_path, path ) == 0);
+		if( ! ok )
+			unlink( tmp_path );
+		}
+
+	if( options.debug )
+		printf( "overlay_file_write: %s %s\n", ok ? "wrote" : "could not write", path );
+}
+
+/*=========================================================================================
+ * Draws the overlay into 'pixels', which holds the width by height pixel part
+ * of the scaled image with its upper left corner at (x0,y0).  This is done
+ * after the data are turned into pixels, so the data themselves are left
+ * alone.  When the image is blown up, the overlay is drawn as lines one
+ * pixel wide joining the centers of neighboring points that are in it;
+ * when the image is shrunk, a pixel is drawn if any of the points it
+ * stands for are in it.
+ */
+	void
+overlay_draw( View *v, size_t x0, size_t y0, size_t width, size_t height, ncv_pixel *pixels )
+{
+	unsigned char	*ov;
+	size_t		nx, ny, new_nx, new_ny, px, py, sy, i_lo, i_hi, j_lo, j_hi, ii, jj;
+	long		b, n, i, j, k, i0, i1, j0, j1, cx, cy, sy_lo, sy_hi;
+	int		hit, east, north, west;
+	OverlayDrawArea	a;
+
+	ov = options.overlay->overlay;
+	if( ! (options.overlay->doit && (ov != NULL)))
+		return;
+
+	nx = *(v->variable->size + v->x_axis_id);
+	ny = *(v->variable->size + v->y_axis_id);
+	view_get_scaled_size( options.blowup, nx, ny, &new_nx, &new_ny );
+	b = options.blowup;
+
+	if( b <= 1 ) {
+		n = (b < 0) ? -b : 1;
+		for( py=0; py<height; py++ ) {
+			/* Rows on the screen run the other way from rows in the data,
+			 * unless the picture is inverted
+			 */
+			sy = options.invert_physical ? y0+py : new_ny-1-(y0+py);
+			j_lo = sy*n;
+			j_hi = (j_lo+n > ny) ? ny : j_lo+n;
+			for( px=0; px<width; px++ ) {
+				i_lo = (x0+px)*n;
+				i_hi = (i_lo+n > nx) ? nx : i_lo+n;
+				hit = FALSE;
+				for( jj=j_lo; (jj<j_hi) && (! hit); jj++ )
+				for( ii=i_lo; (ii<i_hi) && (! hit); ii++ )
+					hit = OVERLAY_GET( ov, ii + jj*nx );
+				if( hit )
+					*(pixels + px + py*width) = *pixel_transform;
+				}
+			}
+		return;
+		}
+
+	a.x0     = x0;
+	a.y0     = y0;
+	a.width  = width;
+	a.height = height;
+	a.new_ny = new_ny;
+	a.pixels = pixels;
+	a.pix    = *pixel_transform;
+
+	/* The rows of the scaled image that we are drawing, and the points
+	 * whose lines could reach them
+	 */
+	if( options.invert_physical ) {
+		sy_lo = y0;
+		sy_hi = y0 + height - 1;
+		}
+	else
+		{
+		sy_lo = new_ny - y0 - height;
+		sy_hi = new_ny - y0 - 1;
+		}
+	i0 = (long)x0/b - 1;
+	i1 = (long)(x0+width-1)/b + 1;
+	j0 = sy_lo/b - 1;
+	j1 = sy_hi/b + 1;
+	if( i0 < 0 )
+		i0 = 0;
+	if( j0 < 0 )
+		j0 = 0;
+	if( i1 > (long)nx-1 )
+		i1 = nx-1;
+	if( j1 > (long)ny-1 )
+		j1 = ny-1;
+
+	for( j=j0; j<=j1; j++ )
+	for( i=i0; i<=i1; i++ ) {
+		if( ! OVERLAY_GET( ov, i + j*nx ))
+			continue;
+		cx = i*b + b/2;
+		cy = j*b + b/2;
+		overlay_plot( &a, cx, cy );
+
+		east  = (i < (long)nx-1) && OVERLAY_GET( ov, i+1 + j*nx );
+		west  = (i > 0)          && OVERLAY_GET( ov, i-1 + j*nx );
+		north = (j < (long)ny-1) && OVERLAY_GET( ov, i + (j+1)*nx );
+		if( east )
+			for( k=1; k<b; k++ )
+				overlay_plot( &a, cx+k, cy );
+		if( north )
+			for( k=1; k<b; k++ )
+				overlay_plot( &a, cx, cy+k );
+
+		/* Diagonal neighbors are only joined if they aren't already joined
+		 * through a point next to both, so corners stay one pixel wide
+		 */
+		if( (j < (long)ny-1) && (! north) ) {
+			if( (i < (long)nx-1) && (! east) && OVERLAY_GET( ov, i+1 + (j+1)*nx ))
+				for( k=1; k<b; k++ )
+					overlay_plot( &a, cx+k, cy+k );
+			if( (i > 0) && (! west) && OVERLAY_GET( ov, i-1 + (j+1)*nx ))
+				for( k=1; k<b; k++ )
+					overlay_plot( &a, cx-k, cy+k );
+			}
+		}
+}
+
+/*=========================================================================================
+ * Sets the pixel at (sx,sy) in the scaled image, with sy counting up from
+ * the first row of data, if it is in the area being drawn.
+ */
+	static void
+overlay_plot( OverlayDrawArea *a, long sx, long sy )
+{
+	long	dx, dy;
+
+	dx = sx - a->x0;
+	if( options.invert_physical )
+		dy = sy - a->y0;
+	else
+		dy = a->new_ny - 1 - sy - a->y0;
+	if( (dx < 0) || (dx >= a->width) || (dy < 0) || (dy >= a->height) )
+		return;
+	*(a->pixels + dx + dy*a->width) = a->pix;
+}
+
 /*=========================================================================================
  * This is called just once, when ncview starts up.  In particular,
  * it is NOT called every time we start a new overlay.
@@ -176,76 +591,33 @@ determine_overlay_base_dir( char *overlay_base_dir, int n )
 
 /******************************************************************************
  * This is the version when 2-D mapping is being used for the X and/or
- * Y coordinate
+ * Y coordinate.  The nearest cell to each point is found with the index
+ * in overlay_index.c.
  * NOTE: 'nvals' is the total number of data values in array data.  Since there are
  * two data values per location, nvals is TWICE the number of locations.
  */
 	void
-gen_overlay_internal_mapped( View *v, float *data, long nvals, int *overlay )
+gen_overlay_internal_mapped( View *v, float *data, long nvals, unsigned char *overlay )
 {
-	NCDim	*dim_x, *dim_y;
-	size_t	ii, jj, kk, x_size, y_size, cursor_place[MAX_NC_DIMS];
-	float	x, y, *dimval_x_2d, *dimval_y_2d;
-	nc_type	dimval_type;
-	double	tval, bnds_min, bnds_max;
-	char	cval[1024];
-	int	has_bnds;
+	OverlayIndex	*idx;
+	long		kk, npts, *cell;
 
-	dim_x = *(v->variable->dim + v->x_axis_id);
-	dim_y = *(v->variable->dim + v->y_axis_id);
+	idx = overlay_index_for_view( v );
 
-	x_size = *(v->variable->size + v->x_axis_id);
-	y_size = *(v->variable->size + v->y_axis_id);
-
-	/* Allocate space for 2d arrays that hold mapped X and Y coord vals */
-	dimval_x_2d = (float *)malloc( x_size*y_size*sizeof(float) );
-	dimval_y_2d = (float *)malloc( x_size*y_size*sizeof(float) );
-
-	if( (dimval_x_2d==NULL) || (dimval_y_2d==NULL) ) {
+	npts = nvals/2;
+	cell = (long *)malloc( npts*sizeof(long) );
+	if( cell == NULL ) {
 		in_error( "Malloc of overlay (distance) field failed\n" );
-		}
-	for( ii=0; ii<v->variable->n_dims; ii++ )
-		cursor_place[ii] = v->var_place[ii];
-
-	/* Step 1. Get temporary arrays that hold full 2-D X and Y values */
-	for( jj=0; jj<y_size; jj++ )
-	for( ii=0; ii<x_size; ii++ ) {
-		cursor_place[ v->x_axis_id ] = ii;
-		cursor_place[ v->y_axis_id ] = jj;
-
-		/* Get X value */
-		dimval_type = fi_dim_value( v->variable, v->x_axis_id, ii, &tval, cval,
-			&has_bnds, &bnds_min, &bnds_max, cursor_place );
-		if( dimval_type == NC_DOUBLE )
-			dimval_x_2d[ii + jj*x_size] = tval;
-		else
-			dimval_x_2d[ii + jj*x_size] = dim_x->values[ii];
-
-		/* Get Y value */
-		dimval_type = fi_dim_value( v->variable, v->y_axis_id, ii, &tval, cval,
-			&has_bnds, &bnds_min, &bnds_max, cursor_place );
-		if( dimval_type == NC_DOUBLE )
-			dimval_y_2d[ii + jj*x_size] = tval;
-		else
-			dimval_y_2d[ii + jj*x_size] = dim_y->values[jj];
+		return;
 		}
 
-	/* Step 2. For each point specified in the overlay file, get the CLOSEST
-	 * point in the 2-D X and Y arrays.
-	 */
-	for( kk=0; kk<nvals; kk+=2 ) {
-		x = data[kk];
-		y = data[kk+1];
+	overlay_index_query( idx, data, npts, cell );
 
-		/* printf( "pt %ld / %ld (x,y)=(%f,%f)\n", kk, nvals, x, y ); */
-		overlay_find_closest_pt( kk, x, y, dimval_x_2d, dimval_y_2d, x_size, y_size,
-			&ii, &jj );
-		*(overlay + jj*x_size + ii) = 1;
-		}
+	for( kk=0; kk<npts; kk++ )
+		if( cell[kk] >= 0 )
+			OVERLAY_SET( overlay, cell[kk] );
 
-	free(dimval_x_2d);
-	free(dimval_y_2d);
-	printf( "\n" );
+	free( cell );
 }
 
 /******************************************************************************
@@ -254,153 +626,420 @@ gen_overlay_internal_mapped( View *v, float *data, long nvals, int *overlay )
  * first X coordinate, data[1] is the first Y coordinate, data[2] is the
  * second X coordinate, etc.
  */
-	int *
+	unsigned char *
 gen_overlay_internal( View *v, float *data, long nvals )
 {
-	NCDim	*dim_x, *dim_y;
-	size_t	x_size, y_size, ii;
-	int	*overlay, x_is_mapped, y_is_mapped;
-	float	x, y;
-	long	i, j;
-
-	dim_x = *(v->variable->dim + v->x_axis_id);
-	dim_y = *(v->variable->dim + v->y_axis_id);
+	size_t	x_size, y_size;
+	unsigned char *overlay;
 
 	x_size = *(v->variable->size + v->x_axis_id);
 	y_size = *(v->variable->size + v->y_axis_id);
 
-	overlay = (int *)malloc( x_size*y_size*sizeof(int) );
+	overlay = (unsigned char *)calloc( OVERLAY_NBYTES( x_size*y_size ), 1 );
 	if( overlay == NULL ) {
 		in_error( "Malloc of overlay field failed\n" );
 		return( NULL );
 		}
-	for( ii=0; ii<x_size*y_size; ii++ )
-		*(overlay+ii) = 0;
+
+	gen_overlay_add_points( v, data, nvals, overlay );
+
+	return( overlay );
+}
+
+/******************************************************************************
+ * Sets the points of the overlay nearest to the 'nvals'/2 X, Y pairs in
+ * array 'data'.
+ */
+	static void
+gen_overlay_add_points( View *v, float *data, long nvals, unsigned char *overlay )
+{
+	NCDim	*dim_x, *dim_y;
+	size_t	x_size, y_size, ii;
+	int	x_is_mapped, y_is_mapped, x_monotonic, y_monotonic;
+	float	x, y;
+	long	i, j;
 
 	x_is_mapped = (v->variable->dim_map_info[ v->x_axis_id ] != NULL);
 	y_is_mapped = (v->variable->dim_map_info[ v->y_axis_id ] != NULL);
 	if( x_is_mapped || y_is_mapped ) {
-		printf( "Please wait, calculating overlays for mapped coordinates is time-consuming" );
 		gen_overlay_internal_mapped( v, data, nvals, overlay );
+		return;
 		}
-	else
-		{
-		for( ii=0; ii<nvals; ii+=2 ) {
-			x = data[ii];
-			y = data[ii+1];
-
-			i = gen_xform( x, x_size, dim_x->values );
-			if( i == -2 ) 
-				return( NULL );
-			j = gen_xform( y, y_size, dim_y->values );
-			if( j == -2 ) 
-				return( NULL );
-			if( (i > 0) && (j > 0)) 
-				*(overlay + j*x_size + i) = 1;
-			}
+
+	dim_x = *(v->variable->dim + v->x_axis_id);
+	dim_y = *(v->variable->dim + v->y_axis_id);
+
+	x_size = *(v->variable->size + v->x_axis_id);
+	y_size = *(v->variable->size + v->y_axis_id);
+
+	x_monotonic = gen_axis_monotonic( x_size, dim_x->values );
+	y_monotonic = gen_axis_monotonic( y_size, dim_y->values );
+	for( ii=0; ii<nvals; ii+=2 ) {
+		x = data[ii];
+		y = data[ii+1];
+
+		i = gen_xform( x, x_size, dim_x->values, x_monotonic );
+		j = gen_xform( y, y_size, dim_y->values, y_monotonic );
+		if( (i > 0) && (j > 0)) 
+			OVERLAY_SET( overlay, j*x_size + i );
 		}
+}
+
+/******************************************************************************
+ * Generate an overlay from data in an overlay file, which can be either an
+ * NCVIEW-OVERLAY text file or a binary one made from it by -convert_overlay.
+ */
+	unsigned char *
+gen_overlay( View *v, char *overlay_fname )
+{
+	char	err_mess[1024];
+	float	*data;
+	long	nvals;
+	unsigned char *overlay;
+
+	if( (overlay = gen_overlay_binary( v, overlay_fname )) != NULL )
+		return( overlay );
+
+	if( (nvals = overlay_read_text( overlay_fname, &data, err_mess, 1024 )) < 0 ) {
+		in_error( err_mess );
+		return( NULL );
+		}
+
+	overlay = gen_overlay_internal( v, data, nvals );
+	free( data );
 
 	return( overlay );
 }
 
 /******************************************************************************
- * Generate an overlay from data in an overlay file.
+ * Reads the points in an NCVIEW-OVERLAY text file into *data, which is
+ * allocated here, as X, Y pairs.  Returns the number of values read (twice
+ * the number of points), or -1 if the file can't be read, in which case
+ * err_mess says why.
  */
-	int *
-gen_overlay( View *v, char *overlay_fname )
+	static long
+overlay_read_text( char *overlay_fname, float **data, char *err_mess, int len )
 {
 	FILE	*f;
-	char	err_mess[1024], line[80], *id_string="NCVIEW-OVERLAY";
+	char	line[1024], *id_string="NCVIEW-OVERLAY";
 	float	x, y, version;
-	long	i, j;
-	size_t	x_size, y_size;
-	int	*overlay;
-	NCDim	*dim_x, *dim_y;
+	long	nvals, n_alloced;
 
 	/* Open the overlay file */
 	if( (f = fopen(overlay_fname, "r")) == NULL ) {
-		snprintf( err_mess, 1024, "Error: can't open overlay file named \"%s\"\n", 
+		snprintf( err_mess, len, "Error: can't open overlay file named \"%s\"\n", 
 			overlay_fname );
-		in_error( err_mess );
-		return( NULL );
+		return( -1 );
 		}
 
 	/* Make sure it is a valid overlay file
 	 */
-	if( fgets(line, 80, f) == NULL ) {
-		snprintf( err_mess, 1024, "Error trying to read overlay file named \"%s\"\n",
+	if( fgets(line, 1024, f) == NULL ) {
+		snprintf( err_mess, len, "Error trying to read overlay file named \"%s\"\n",
 			overlay_fname );
-		in_error( err_mess );
-		return( NULL );
+		fclose( f );
+		return( -1 );
 		}
-	for( i=0; i<strlen(id_string); i++ )
-		if( line[i] != id_string[i] ) {
-			snprintf( err_mess, 1024, "Error trying to read overlay file named \"%s\"\nFile does not start with \"%s version-num\"\n", 
-				overlay_fname, id_string );
-			in_error( err_mess );
-			return( NULL );
-			}
+	if( strncmp( line, id_string, strlen(id_string) ) != 0 ) {
+		snprintf( err_mess, len, "Error trying to read overlay file named \"%s\"\nFile does not start with \"%s version-num\"\n", 
+			overlay_fname, id_string );
+		fclose( f );
+		return( -1 );
+		}
+	version = 0.0;
 	sscanf( line, "%*s %f", &version );
 	if( (version < 0.95) || (version > 1.05)) {
-		snprintf( err_mess, 1024, "Error, overlay file has unknown version number: %f\nI am set up for version 1.0\n", version );
-		in_error( err_mess );
+		snprintf( err_mess, len, "Error, overlay file has unknown version number: %f\nI am set up for version 1.0\n", version );
+		fclose( f );
+		return( -1 );
+		}
+
+	/* Read in the overlay file -- skip lines with first char of #, 
+	 * they are comments.
+	 */
+	nvals     = 0L;
+	n_alloced = 8192L;
+	*data = (float *)malloc( n_alloced*sizeof(float) );
+	while( (*data != NULL) && (fgets(line, 1024, f) != NULL) ) {
+		if( (line[0] == '#') || (sscanf( line, "%f %f", &x, &y ) != 2) )
+			continue;
+		if( nvals+2 > n_alloced ) {
+			n_alloced *= 2;
+			*data = (float *)realloc( *data, n_alloced*sizeof(float) );
+			if( *data == NULL )
+				break;
+			}
+		(*data)[nvals++] = x;
+		(*data)[nvals++] = y;
+		}
+	fclose( f );
+
+	if( *data == NULL ) {
+		snprintf( err_mess, len, "Malloc of overlay points failed for file \"%s\"\n", overlay_fname );
+		return( -1 );
+		}
+
+	return( nvals );
+}
+
+/******************************************************************************
+ * Generate an overlay from a binary overlay file.  Returns NULL if the file
+ * isn't one.
+ */
+	static unsigned char *
+gen_overlay_binary( View *v, char *overlay_fname )
+{
+	int		fd;
+	struct stat	st;
+	void		*map;
+	OverlayBinHeader *hdr;
+	OverlayBinTile	*tile;
+	float		*pts, *data, xmin, xmax, ymin, ymax;
+	NCDim		*dim_x, *dim_y;
+	OverlayIndex	*idx;
+	size_t		x_size, y_size, ii;
+	unsigned long long k, nvals, n_tiles_used, avail;
+	unsigned char	*overlay;
+
+	if( (fd = open( overlay_fname, O_RDONLY )) < 0 )
+		return( NULL );
+	if( (fstat( fd, &st ) != 0) || (st.st_size < sizeof(OverlayBinHeader)) ) {
+		close( fd );
 		return( NULL );
 		}
+	map = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if( map == MAP_FAILED )
+		return( NULL );
 
-	dim_x = *(v->variable->dim + v->x_axis_id);
-	dim_y = *(v->variable->dim + v->y_axis_id);
+	/* The counts in the header are checked against the file size one at
+	 * a time, by division, so that a damaged header can't make the total
+	 * size wrap around
+	 */
+	hdr   = (OverlayBinHeader *)map;
+	avail = st.st_size - sizeof(OverlayBinHeader);
+	if( (strncmp( hdr->magic, OVERLAY_BIN_MAGIC, 8 ) != 0) || 
+	    (hdr->byte_order != OVERLAY_BIN_BYTE_ORDER) ||
+	    (hdr->n_tiles > avail/sizeof(OverlayBinTile)) ||
+	    (hdr->n_points > (avail - hdr->n_tiles*sizeof(OverlayBinTile))/(2*sizeof(float))) ||
+	    (avail != hdr->n_tiles*sizeof(OverlayBinTile) + hdr->n_points*2*sizeof(float)) ) {
+		if( options.debug && (strncmp( hdr->magic, OVERLAY_BIN_MAGIC, 8 ) == 0) )
+			printf( "gen_overlay_binary: %s was made on a different kind of machine or is damaged\n",
+				overlay_fname );
+		munmap( map, st.st_size );
+		return( NULL );
+		}
+	tile = (OverlayBinTile *)(hdr+1);
+	pts  = (float *)(tile + hdr->n_tiles);
 
+	/* The extent of the grid */
 	x_size = *(v->variable->size + v->x_axis_id);
 	y_size = *(v->variable->size + v->y_axis_id);
+	if( (v->variable->dim_map_info[ v->x_axis_id ] != NULL) || 
+	    (v->variable->dim_map_info[ v->y_axis_id ] != NULL) ) {
+		idx  = overlay_index_for_view( v );
+		xmin = idx->xmin;
+		xmax = idx->xmax;
+		ymin = idx->ymin;
+		ymax = idx->ymax;
+		}
+	else
+		{
+		dim_x = *(v->variable->dim + v->x_axis_id);
+		dim_y = *(v->variable->dim + v->y_axis_id);
+		xmin = xmax = *(dim_x->values);
+		for( ii=1; ii<x_size; ii++ ) {
+			xmin = (*(dim_x->values+ii) < xmin) ? *(dim_x->values+ii) : xmin;
+			xmax = (*(dim_x->values+ii) > xmax) ? *(dim_x->values+ii) : xmax;
+			}
+		ymin = ymax = *(dim_y->values);
+		for( ii=1; ii<y_size; ii++ ) {
+			ymin = (*(dim_y->values+ii) < ymin) ? *(dim_y->values+ii) : ymin;
+			ymax = (*(dim_y->values+ii) > ymax) ? *(dim_y->values+ii) : ymax;
+			}
+		}
 
-	overlay = (int *)malloc( x_size*y_size*sizeof(int) );
-	if( overlay == NULL ) {
+	/* Gather the points of the tiles that overlap it */
+	nvals = 0L;
+	for( k=0; k<hdr->n_tiles; k++ )
+		if( (tile[k].xmax >= xmin) && (tile[k].xmin <= xmax) &&
+		    (tile[k].ymax >= ymin) && (tile[k].ymin <= ymax) &&
+		    (tile[k].n <= hdr->n_points) && (tile[k].first <= hdr->n_points - tile[k].n) )
+			nvals += 2*tile[k].n;
+
+	data = (float *)malloc( (nvals > 0 ? nvals : 1)*sizeof(float) );
+	overlay = (unsigned char *)calloc( OVERLAY_NBYTES( x_size*y_size ), 1 );
+	if( (data == NULL) || (overlay == NULL) ) {
 		in_error( "Malloc of overlay field failed\n" );
+		munmap( map, st.st_size );
 		return( NULL );
 		}
-	for( i=0; i<x_size*y_size; i++ )
-		*(overlay+i) = 0;
 
-	/* Read in the overlay file -- skip lines with first char of #, 
-	 * they are comments.
-	 */
-	while( fgets(line, 80, f) != NULL ) 
-		if( line[0] != '#' ) {
-			sscanf( line, "%f %f", &x, &y );
-			i = gen_xform( x, x_size, dim_x->values );
-			if( i == -2 ) 
-				return( NULL );
-			j = gen_xform( y, y_size, dim_y->values );
-			if( j == -2 ) 
-				return( NULL );
-			if( (i > 0) && (j > 0)) 
-				*(overlay + j*x_size + i) = 1;
+	nvals = 0L;
+	n_tiles_used = 0L;
+	for( k=0; k<hdr->n_tiles; k++ )
+		if( (tile[k].xmax >= xmin) && (tile[k].xmin <= xmax) &&
+		    (tile[k].ymax >= ymin) && (tile[k].ymin <= ymax) &&
+		    (tile[k].n <= hdr->n_points) && (tile[k].first <= hdr->n_points - tile[k].n) ) {
+			memcpy( data + nvals, pts + 2*tile[k].first, 2*tile[k].n*sizeof(float) );
+			nvals += 2*tile[k].n;
+			n_tiles_used++;
 			}
 
+	if( options.debug )
+		printf( "gen_overlay_binary: using %llu of %llu points, in %llu of %u tiles, of %s\n",
+			nvals/2, hdr->n_points, n_tiles_used, hdr->n_tiles, overlay_fname );
+
+	munmap( map, st.st_size );
+
+	gen_overlay_add_points( v, data, nvals, overlay );
+	free( data );
+
 	return( overlay );
 }
 
+/******************************************************************************
+ * Converts an NCVIEW-OVERLAY text file to a binary overlay file, which is
+ * quicker to read.  This is done for -convert_overlay, before anything else
+ * is set up, so errors just go to stderr.  Returns 0 on success, -1 on failure.
+ */
+	int
+overlay_convert( char *text_fname, char *bin_fname )
+{
+	char		err_mess[1024];
+	float		*data, *sorted, x, y;
+	long		nvals, npts, k, tx, ty, nt_x, nt_y, t, *tile_of;
+	OverlayBinHeader hdr;
+	OverlayBinTile	*tile;
+	FILE		*f;
+	int		ok;
+
+	if( (nvals = overlay_read_text( text_fname, &data, err_mess, 1024 )) < 0 ) {
+		fprintf( stderr, "%s", err_mess );
+		return( -1 );
+		}
+	npts = nvals/2;
+
+	memset( &hdr, 0, sizeof(hdr) );
+	strncpy( hdr.magic, OVERLAY_BIN_MAGIC, 8 );
+	hdr.byte_order = OVERLAY_BIN_BYTE_ORDER;
+	hdr.n_points   = npts;
+	for( k=0; k<npts; k++ ) {
+		x = data[2*k];
+		y = data[2*k+1];
+		if( (k == 0) || (x < hdr.xmin) ) hdr.xmin = x;
+		if( (k == 0) || (x > hdr.xmax) ) hdr.xmax = x;
+		if( (k == 0) || (y < hdr.ymin) ) hdr.ymin = y;
+		if( (k == 0) || (y > hdr.ymax) ) hdr.ymax = y;
+		}
+
+	/* Square-ish grid of tiles with about OVERLAY_BIN_TILE_POINTS in each */
+	nt_x = (long)sqrt( (double)npts / (double)OVERLAY_BIN_TILE_POINTS );
+	if( nt_x < 1 )
+		nt_x = 1;
+	if( nt_x > OVERLAY_BIN_MAX_TILES )
+		nt_x = OVERLAY_BIN_MAX_TILES;
+	nt_y = nt_x;
+	hdr.n_tiles = nt_x*nt_y;
+
+	tile    = (OverlayBinTile *)calloc( hdr.n_tiles, sizeof(OverlayBinTile) );
+	tile_of = (long *)malloc( (npts > 0 ? npts : 1)*sizeof(long) );
+	sorted  = (float *)malloc( (nvals > 0 ? nvals : 1)*sizeof(float) );
+	if( (tile == NULL) || (tile_of == NULL) || (sorted == NULL) ) {
+		fprintf( stderr, "ncview: overlay_convert: failed to allocate space for %ld points\n", npts );
+		return( -1 );
+		}
+
+	/* Count the points in each tile, then put them in order by tile */
+	for( k=0; k<npts; k++ ) {
+		tx = (hdr.xmax > hdr.xmin) ? (long)((data[2*k]   - hdr.xmin) / (hdr.xmax - hdr.xmin) * nt_x) : 0;
+		ty = (hdr.ymax > hdr.ymin) ? (long)((data[2*k+1] - hdr.ymin) / (hdr.ymax - hdr.ymin) * nt_y) : 0;
+		tx = (tx >= nt_x) ? nt_x-1 : tx;
+		ty = (ty >= nt_y) ? nt_y-1 : ty;
+		t  = tx + ty*nt_x;
+		tile_of[k] = t;
+		if( tile[t].n == 0 ) {
+			tile[t].xmin = tile[t].xmax = data[2*k];
+			tile[t].ymin = tile[t].ymax = data[2*k+1];
+			}
+		tile[t].xmin = (data[2*k]   < tile[t].xmin) ? data[2*k]   : tile[t].xmin;
+		tile[t].xmax = (data[2*k]   > tile[t].xmax) ? data[2*k]   : tile[t].xmax;
+		tile[t].ymin = (data[2*k+1] < tile[t].ymin) ? data[2*k+1] : tile[t].ymin;
+		tile[t].ymax = (data[2*k+1] > tile[t].ymax) ? data[2*k+1] : tile[t].ymax;
+		tile[t].n++;
+		}
+	for( t=1; t<hdr.n_tiles; t++ )
+		tile[t].first = tile[t-1].first + tile[t-1].n;
+	for( t=0; t<hdr.n_tiles; t++ )
+		tile[t].n = 0;
+	for( k=0; k<npts; k++ ) {
+		t = tile_of[k];
+		sorted[ 2*(tile[t].first + tile[t].n)     ] = data[2*k];
+		sorted[ 2*(tile[t].first + tile[t].n) + 1 ] = data[2*k+1];
+		tile[t].n++;
+		}
+
+	ok = FALSE;
+	if( (f = fopen( bin_fname, "w" )) == NULL )
+		fprintf( stderr, "Error, can't open \"%s\" to write the binary overlay to\n", bin_fname );
+	else
+		{
+		ok = (fwrite( &hdr, sizeof(hdr), 1, f ) == 1) &&
+		     (fwrite( tile, sizeof(OverlayBinTile), hdr.n_tiles, f ) == hdr.n_tiles) &&
+		     (fwrite( sorted, sizeof(float), nvals, f ) == nvals);
+		ok = (fclose( f ) == 0) && ok;
+		if( ! ok )
+			fprintf( stderr, "Error writing the binary overlay to \"%s\"\n", bin_fname );
+		else
+			printf( "Wrote %ld points in %ldx%ld tiles to %s\n", npts, nt_x, nt_y, bin_fname );
+		}
+
+	free( data );
+	free( sorted );
+	free( tile );
+	free( tile_of );
+
+	return( ok ? 0 : -1 );
+}
+
+/******************************************************************************
+ * Returns TRUE if dimvals only go up, or only go down, so gen_xform can
+ * search them by halves.
+ */
+	static int
+gen_axis_monotonic( int n, float *dimvals )
+{
+	int	i, reversed;
+
+	reversed = (*dimvals > *(dimvals+n-1));
+	for( i=1; i<n; i++ )
+		if( reversed ? (*(dimvals+i) > *(dimvals+i-1)) : (*(dimvals+i) < *(dimvals+i-1)) )
+			return( FALSE );
+	return( TRUE );
+}
+
 /******************************************************************************
  * Given the (dimensional) value from the overlay file, convert it to 
  * the nearest index along the proper dimension that the point corresponds to.
- * 'n' is the length of array dimvals.
+ * 'n' is the length of array dimvals.  'monotonic' is what gen_axis_monotonic
+ * said about dimvals.
  *
  * For example, 'value' might be 160.0, and dimvals might go from 0.0 to 359.0
  * by 1.0, in which case n=360.  Then, the returned value is the location in
  * array dimvals that is closest to 160.0, in this case, it will be 160.
  */
 	int
-gen_xform( float value, int n, float *dimvals )
+gen_xform( float value, int n, float *dimvals, int monotonic )
 {
 	float	min_dist, dist;
-	int	i, min_place;
+	int	i, min_place, lo, hi, mid, reversed;
 
 	min_dist  = 1.0e35;
 	min_place = 0;
 
 	/* See if off ends of dimvalues ... remember that it can be reversed */
-	if( *dimvals > *(dimvals+n-1) ) {
-		/* reversed */
+	reversed = (*dimvals > *(dimvals+n-1));
+	if( reversed ) {
 		if( value > *dimvals )
 			return( -1 );
 		if( value < *(dimvals+n-1) )
@@ -413,7 +1052,30 @@ gen_xform( float value, int n, float *dimvals )
 		if( value > *(dimvals+n-1) )
 			return( -1 );
 		}
-	
+
+	if( monotonic ) {
+		/* Find the first place that is not before value, then see if the
+		 * place just before it is closer.  Ties go to the lower index,
+		 * same as the search below.
+		 */
+		lo = 0;
+		hi = n-1;
+		while( lo < hi ) {
+			mid = (lo+hi)/2;
+			if( reversed ? (*(dimvals+mid) > value) : (*(dimvals+mid) < value) )
+				lo = mid+1;
+			else
+				hi = mid;
+			}
+		min_place = lo;
+		if( (lo > 0) && (fabs(*(dimvals+lo-1) - value) <= fabs(*(dimvals+lo) - value)) ) {
+			min_place = lo-1;
+			while( (min_place > 0) && (*(dimvals+min_place-1) == *(dimvals+min_place)) )
+				min_place--;
+			}
+		return( min_place );
+		}
+
 	for( i=0; i<n; i++ ) {
 		dist = fabs(*(dimvals+i) - value);
 		if( dist < min_dist ) {
@@ -452,237 +1114,3 @@ overlay_custom_n( void )
 {
 	return( OVERLAY_CUSTOM );
 }
-
-/****************************************************************************************
- * Since distances on a sphere are monotonic with no local minima or maxima, we simply
- * follow the downhill direction until we reach a minimum.
- * Indexing:
- *
- *	0 1 2
- * 	3 4 5
- * 	6 7 8
- * |
- * |
- * (0,0) -----
- *
- */
-	void
-overlay_find_closest_pt_inner( size_t point_number, size_t init_guess_idxx, size_t init_guess_idxy, 
-	float locx, float locy, float *xvals, float *yvals, size_t nx, size_t ny, size_t *idxx, size_t *idxy )
-{
-	float	dist[9], dx, dy, mindist, tdist[9], prev_d4;
-	long	i, j, nsteps, xx;
-	long	have_calc[9], index, minloc, ox, oy, isrc, jsrc, idx_src, idx_dest, debug;
-	long	curx, cury, i2use, j2use, i0, j0;
-	int	n_wrapped_x, n_wrapped_y;
-	
-	debug  = 0;
-	nsteps = 0L;
-	n_wrapped_x = 0;
-	n_wrapped_y = 0;
-
-	if( debug ) {
-		i0 = 68;
-		j0 = 46;
-		for( j=j0; j<j0+5; j++ ) {
-			for( i=i0; i<i0+5; i++ ) {
-				index = i + j*nx;
-				printf( "(%3ld,%3ld)=(%f,%f) ", i, j, xvals[index], yvals[index] );
-				}
-			printf( "\n" );
-			}
-		}
-
-	curx = init_guess_idxx;
-	cury = init_guess_idxy;
-
-	for( i=0; i<9; i++ )
-		have_calc[i] = 0;
-
-	minloc = -1;
-	while( minloc != 4 ) {
-		nsteps++;
-		mindist = 1.e31;
-		for( j=-1; j<=1; j++ )
-		for( i=-1; i<=1; i++ ) {
-			index = (i+1) + (-j+1)*3;
-			if( ! have_calc[index] ) {
-				if( (curx == 0) && (i == -1))
-					i2use = nx-1;
-				else if( (curx == nx-1) && (i == 1))
-					i2use = 0;
-				else
-					i2use = curx + i;
-
-				if( (cury == 0) && (j == -1))
-					j2use = ny-1;
-				else if( (cury == ny-1) && (j == 1))
-					j2use = 0;
-				else
-					j2use = cury + j;
-				xx = i2use + j2use*nx;
-				dx = locx - xvals[xx];
-				if( dx != dx ) {
-					fprintf( stderr, "Error, bad dx  locx=%f  index_xx=%ld  xvals[index]=%f\n", 
-						locx, xx, xvals[xx] );
-					exit(-1);
-					}
-				dy = locy - yvals[xx];
-				if( dy != dy ) {
-					fprintf( stderr, "Error, bad dy  locy=%f  index_xx=%ld  yvals[index]=%f\n", 
-						locy, xx, yvals[xx] );
-					exit(-1);
-					}
-				dist[index] = dx*dx + dy*dy;	/* don't bother with square root, takes time and won't affect minimum finding */
-				}
-			if( debug ) 
-				printf( "calculating for index=%ld, i2use,j2use=%ld,%ld  xx=%ld  dx,dy=%f,%f  dist=%f\n", 
-					index, i2use, j2use, xx, dx, dy, dist[index] );
-				
-			if( dist[index] < mindist ) {
-				mindist = dist[index];
-				minloc  = index;
-				}
-			}
-
-		if( debug ) {
-			printf( "cur loc=(%ld,%ld)  minloc=%ld\n", curx, cury, minloc );
-			for( j=2; j>=0; j-- ) {
-				for( i=0; i<3; i++ ) {
-					index = i + (2-j)*3;
-					if( index == minloc )
-						printf( ">%f< ", dist[index] );
-					else
-						printf( " %f  ", dist[index] );
-					}
-				printf( "\n" );
-				}
-				
-			}
-
-		prev_d4 = dist[4];
-
-		/* Now do the shifting towards the downhill direction 
-		 *
-		 *	0 1 2
-		 * 	3 4 5
-		 * 	6 7 8
-		 * |
-		 * |
-		 * (0,0) -----
-		 */
-		for( i=0; i<9; i++ )
-			have_calc[i] = 0;
-		switch( minloc ) {
- 			case 0: ox=-1; oy=1;  break;
-			case 1: ox=0;  oy=1;  break;
-			case 2: ox=1;  oy=1;  break;
-			case 3: ox=-1; oy=0;  break;
-			case 4: ox=0;  oy=0;  break;
-			case 5: ox=1;  oy=0;  break;
-			case 6: ox=-1; oy=-1; break;
-			case 7: ox=0;  oy=-1; break;
-			case 8: ox=1;  oy=-1; break;
-			default:
-				fprintf( stderr, "coding error in overlay.c, minloc=%ld\n", minloc );
-				exit(-1);
-			}
-
-		/* Update current x,y position */
-		if( (curx == 0) && (ox == -1)) {
-			n_wrapped_x++;
-			curx = nx-1;
-			}
-		else if( (curx == nx-1) && (ox == 1)) {
-			n_wrapped_x++;
-			curx = 0;
-			}
-		else
-			curx = curx + ox;
-
-		if( (cury == 0) && (oy == -1)) {
-			n_wrapped_y++;
-			cury = ny-1;
-			}
-		else if( (cury == ny-1) && (oy == 1)) {
-			cury = 0;
-			n_wrapped_y++;
-			}
-		else
-			cury = cury + oy;
-		if( (curx<0) || (cury<0) || (curx>=nx) || (cury>=ny)) {
-			fprintf( stderr, "Error, alg fails, cursor off array; cursor=(%ld,%ld)  nx=%ld  ny=%ld\n", curx, cury, nx, ny);
-			exit(-1);
-			}
-		if( (n_wrapped_x > 2) || (n_wrapped_y > 2)) {
-			/* Give up */
-			*idxx = 0;
-			*idxy = 0;
-			return;
-			}
-
-		/* Shift the distance array appropriately */
-		for( i=-1; i<=1; i++ )
-		for( j=-1; j<=1; j++ ) {
-			idx_dest = (i+1) + (-j+1)*3;
-			isrc = i + ox;
-			jsrc = j + oy;
-			if( (isrc>=-1) && (isrc<=1) && (jsrc>=-1) && (jsrc<=1)) {
-				idx_src = (isrc+1) + (-jsrc+1)*3;
-				if( (idx_src<0) || (idx_src>8)) {
-					fprintf( stderr, "Error, alg failed! overlay.c while shifting\n" );
-					exit(-1);
-					}
-				tdist[idx_dest] = dist[idx_src];
-				have_calc[idx_dest] = 1;
-				}
-			}
-
-		for( i=0; i<9; i++ )
-			dist[i] = tdist[i];
-
-		if( dist[4] > prev_d4 ) {
-			fprintf( stderr, "error, alg fails; prev center dist=%f  new=%f  should always be getting closer!\n",
-				prev_d4, dist[4] );
-			exit(-1);
-			}
-		}
-
-	*idxx = curx;
-	*idxy = cury;
-
-	/* printf( "nsteps=%ld\n", nsteps ); */
-}
-
-/******************************************************************************************
- * Given a location (locx, locy) and an array of values (xvals(nx,ny), yvals(nx,ny)), this
- * calculates the index into the xvals and yvals array such that the distance between
- * (locx,locy) and (xvals(idxx,idxy), yvals(idxx,idxy)) is minimized.
- */
- 	void
-overlay_find_closest_pt( size_t point_number, float locx, float locy, float *xvals, float *yvals, size_t nx, size_t ny,
-		size_t *idxx, size_t *idxy )
-{
-	size_t	init_guess_idxx, init_guess_idxy;
-	static	int have_been_here_before = 0;
-	static	size_t last_idxx, last_idxy;
-
-	if( have_been_here_before ) {
-		init_guess_idxx = last_idxx;
-		init_guess_idxy = last_idxy;
-		}
-	else
-		{
-		init_guess_idxx = nx/2;
-		init_guess_idxy = ny/2;
-		}
-
-	overlay_find_closest_pt_inner( point_number, init_guess_idxx, init_guess_idxy, locx, locy, xvals, yvals,
-		nx, ny, idxx, idxy );
-
-	have_been_here_before = 1;
-	last_idxx = *idxx;
-	last_idxy = *idxy;
-}
-
-
@@ -0,0 +1,435 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Placing overlay points on mapped (curvilinear) grids.  For each point of
+ * a coastline we want the grid cell whose X and Y values are closest to
+ * it.  Rather than searching the grid for each point, the cells are sorted
+ * once into a uniform grid of buckets over the X-Y plane, about two cells
+ * to a bucket, and each point then only looks at the buckets around it,
+ * in rings, until nothing further out could be closer.  The index for the
+ * last grid used is kept, so turning overlays off and on, or changing to
+ * another variable on the same grid, doesn't build it again.  Points are
+ * looked up in bands spread over threads.
+ *
+ * Distances are measured in the X-Y plane, as before, so this works for
+ * any mapped coordinates, not just longitude and latitude.  A point is
+ * only placed if it is within two cell widths of the cell it lands on,
+ * so coastlines outside a regional grid don't pile up along its edges.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+extern Options  options;
+
+/* Fewer points than this are always looked up in a single thread */
+#define OVERLAY_THREAD_MIN_POINTS	16384L
+#define OVERLAY_MAX_THREADS		16
+
+/* Cells with X or Y values beyond this are taken to be missing */
+#define OVERLAY_BAD_COORD		1.0e10
+
+/* One band of points to look up, possibly in its own thread */
+typedef struct {
+	OverlayIndex	*idx;
+	float		*pts;
+	long		k_start, k_end, *cell;
+} OverlayQuery;
+
+static OverlayIndex	*cur_index = NULL;
+
+static OverlayIndex *overlay_index_build( View *v, char *x_name, char *y_name );
+static void	overlay_index_free( OverlayIndex *idx );
+static long	overlay_index_nearest( OverlayIndex *idx, float x, float y );
+static void	overlay_query_band( OverlayQuery *q );
+static int	overlay_n_threads( long npts );
+#ifdef HAVE_PTHREAD
+static void	*overlay_query_band_thread( void *arg );
+#endif
+
+/*============================================================================*/
+/* Returns the index for the grid of the view's variable, building it if
+ * the grid isn't the one we have an index for already.
+ */
+	OverlayIndex *
+overlay_index_for_view( View *v )
+{
+	NCDim_map_info	*dmi_x, *dmi_y;
+	char		*x_name, *y_name;
+	size_t		nx, ny;
+
+	dmi_x = v->variable->dim_map_info[ v->x_axis_id ];
+	dmi_y = v->variable->dim_map_info[ v->y_axis_id ];
+	x_name = (dmi_x != NULL) ? dmi_x->coord_var_name : v->variable->dim[ v->x_axis_id ]->name;
+	y_name = (dmi_y != NULL) ? dmi_y->coord_var_name : v->variable->dim[ v->y_axis_id ]->name;
+	nx = *(v->variable->size + v->x_axis_id);
+	ny = *(v->variable->size + v->y_axis_id);
+
+	if( (cur_index != NULL) && (cur_index->nx == nx) && (cur_index->ny == ny) &&
+	    (strcmp( cur_index->x_name, x_name ) == 0) && (strcmp( cur_index->y_name, y_name ) == 0) ) {
+		if( options.debug )
+			printf( "overlay_index_for_view: reusing index for grid %s,%s\n", x_name, y_name );
+		return( cur_index );
+		}
+
+	if( cur_index != NULL )
+		overlay_index_free( cur_index );
+	cur_index = overlay_index_build( v, x_name, y_name );
+
+	return( cur_index );
+}
+
+/*============================================================================*/
+/* For each of the npts points in pts (x0, y0, x1, y1, ...), puts the index
+ * (i + j*nx) of the nearest grid cell in cell, or -1 if the point is not
+ * on the grid.
+ */
+	void
+overlay_index_query( OverlayIndex *idx, float *pts, long npts, long *cell )
+{
+	OverlayQuery	band[OVERLAY_MAX_THREADS];
+	long		per_thread;
+	int		i, n_threads;
+#ifdef HAVE_PTHREAD
+	pthread_t	threads[OVERLAY_MAX_THREADS];
+	int		started[OVERLAY_MAX_THREADS];
+#endif
+
+	n_threads  = overlay_n_threads( npts );
+	per_thread = (npts + n_threads - 1)/n_threads;
+
+	for( i=0; i<n_threads; i++ ) {
+		band[i].idx     = idx;
+		band[i].pts     = pts;
+		band[i].cell    = cell;
+		band[i].k_start = i*per_thread;
+		band[i].k_end   = (i+1)*per_thread;
+		if( band[i].k_end > npts )
+			band[i].k_end = npts;
+		}
+
+#ifdef HAVE_PTHREAD
+	/* The calling thread does the first band itself.  If a thread
+	 * can't be started, its band is done here too.
+	 */
+	for( i=1; i<n_threads; i++ )
+		started[i] = (pthread_create( &(threads[i]), NULL, overlay_query_band_thread, &(band[i]) ) == 0);
+	overlay_query_band( &(band[0]) );
+	for( i=1; i<n_threads; i++ ) {
+		if( started[i] )
+			pthread_join( threads[i], NULL );
+		else
+			overlay_query_band( &(band[i]) );
+		}
+#else
+	for( i=0; i<n_threads; i++ )
+		overlay_query_band( &(band[i]) );
+#endif
+}
+
+/*============================================================================*/
+/* Gets the 2-D X and Y values of every cell, and sorts the cells into
+ * buckets.
+ */
+	static OverlayIndex *
+overlay_index_build( View *v, char *x_name, char *y_name )
+{
+	OverlayIndex	*idx;
+	NCDim		*dim_x, *dim_y;
+	size_t		ii, jj, nx, ny, cursor_place[MAX_NC_DIMS];
+	long		k, b, n_good, nb, bx, by, *fill;
+	nc_type		dimval_type;
+	double		tval, bnds_min, bnds_max, t_start;
+	char		cval[1024];
+	int		has_bnds, first;
+	float		x, y, w, h;
+
+	t_start = util_time_msec();
+
+	dim_x = *(v->variable->dim + v->x_axis_id);
+	dim_y = *(v->variable->dim + v->y_axis_id);
+	nx = *(v->variable->size + v->x_axis_id);
+	ny = *(v->variable->size + v->y_axis_id);
+
+	idx = (OverlayIndex *)malloc( sizeof( OverlayIndex ));
+	if( idx == NULL ) {
+		fprintf( stderr, "ncview: overlay_index_build: failed to allocate index\n" );
+		exit( -1 );
+		}
+	strncpy( idx->x_name, x_name, MAX_NC_NAME-1 );
+	idx->x_name[MAX_NC_NAME-1] = '\0';
+	strncpy( idx->y_name, y_name, MAX_NC_NAME-1 );
+	idx->y_name[MAX_NC_NAME-1] = '\0';
+	idx->nx = nx;
+	idx->ny = ny;
+	idx->xvals   = (float *)malloc( nx*ny*sizeof(float) );
+	idx->yvals   = (float *)malloc( nx*ny*sizeof(float) );
+	idx->cell_id = (long  *)malloc( nx*ny*sizeof(long) );
+	if( (idx->xvals == NULL) || (idx->yvals == NULL) || (idx->cell_id == NULL) ) {
+		fprintf( stderr, "ncview: overlay_index_build: failed to allocate space for %ldx%ld grid\n",
+			(long)nx, (long)ny );
+		exit( -1 );
+		}
+
+	for( ii=0; ii<v->variable->n_dims; ii++ )
+		cursor_place[ii] = v->var_place[ii];
+
+	/* Get the full 2-D X and Y values, and their extent */
+	first  = TRUE;
+	n_good = 0L;
+	for( jj=0; jj<ny; jj++ )
+	for( ii=0; ii<nx; ii++ ) {
+		cursor_place[ v->x_axis_id ] = ii;
+		cursor_place[ v->y_axis_id ] = jj;
+
+		dimval_type = fi_dim_value( v->variable, v->x_axis_id, ii, &tval, cval,
+			&has_bnds, &bnds_min, &bnds_max, cursor_place );
+		x = (dimval_type == NC_DOUBLE) ? tval : dim_x->values[ii];
+
+		dimval_type = fi_dim_value( v->variable, v->y_axis_id, jj, &tval, cval,
+			&has_bnds, &bnds_min, &bnds_max, cursor_place );
+		y = (dimval_type == NC_DOUBLE) ? tval : dim_y->values[jj];
+
+		idx->xvals[ii + jj*nx] = x;
+		idx->yvals[ii + jj*nx] = y;
+
+		if( (x != x) || (y != y) || (fabs(x) > OVERLAY_BAD_COORD) || (fabs(y) > OVERLAY_BAD_COORD) )
+			continue;
+		if( first || (x < idx->xmin) ) idx->xmin = x;
+		if( first || (x > idx->xmax) ) idx->xmax = x;
+		if( first || (y < idx->ymin) ) idx->ymin = y;
+		if( first || (y > idx->ymax) ) idx->ymax = y;
+		first = FALSE;
+		n_good++;
+		}
+
+	if( n_good == 0L ) {
+		idx->xmin = idx->xmax = idx->ymin = idx->ymax = 0.0;
+		}
+
+	/* About two cells to a bucket, with the buckets about as many
+	 * across as down as the grid's extent is wide as it is high.
+	 */
+	w = idx->xmax - idx->xmin;
+	h = idx->ymax - idx->ymin;
+	if( w <= 0.0 ) w = 1.0;
+	if( h <= 0.0 ) h = 1.0;
+	nb = n_good/2 + 1;
+	idx->nbx = (long)(sqrt( (double)nb * w / h ) + 0.5);
+	if( idx->nbx < 1 )  idx->nbx = 1;
+	if( idx->nbx > nb ) idx->nbx = nb;
+	idx->nby = nb / idx->nbx;
+	if( idx->nby < 1 )  idx->nby = 1;
+	idx->bw = w / idx->nbx;
+	idx->bh = h / idx->nby;
+
+	/* Counting sort of the good cells by bucket */
+	nb = idx->nbx * idx->nby;
+	idx->bucket_start = (long *)malloc( (nb+1)*sizeof(long) );
+	fill              = (long *)malloc( (nb+1)*sizeof(long) );
+	if( (idx->bucket_start == NULL) || (fill == NULL) ) {
+		fprintf( stderr, "ncview: overlay_index_build: failed to allocate %ld buckets\n", nb );
+		exit( -1 );
+		}
+	for( b=0; b<=nb; b++ )
+		idx->bucket_start[b] = 0L;
+
+	for( k=0; k<(long)(nx*ny); k++ ) {
+		x = idx->xvals[k];
+		y = idx->yvals[k];
+		if( (x != x) || (y != y) || (fabs(x) > OVERLAY_BAD_COORD) || (fabs(y) > OVERLAY_BAD_COORD) )
+			continue;
+		bx = (long)((x - idx->xmin) / idx->bw);
+		by = (long)((y - idx->ymin) / idx->bh);
+		if( bx >= idx->nbx ) bx = idx->nbx - 1;
+		if( by >= idx->nby ) by = idx->nby - 1;
+		idx->bucket_start[ bx + by*idx->nbx + 1 ]++;
+		}
+	for( b=0; b<nb; b++ )
+		idx->bucket_start[b+1] += idx->bucket_start[b];
+	for( b=0; b<nb; b++ )
+		fill[b] = idx->bucket_start[b];
+
+	for( k=0; k<(long)(nx*ny); k++ ) {
+		x = idx->xvals[k];
+		y = idx->yvals[k];
+		if( (x != x) || (y != y) || (fabs(x) > OVERLAY_BAD_COORD) || (fabs(y) > OVERLAY_BAD_COORD) )
+			continue;
+		bx = (long)((x - idx->xmin) / idx->bw);
+		by = (long)((y - idx->ymin) / idx->bh);
+		if( bx >= idx->nbx ) bx = idx->nbx - 1;
+		if( by >= idx->nby ) by = idx->nby - 1;
+		idx->cell_id[ fill[ bx + by*idx->nbx ]++ ] = k;
+		}
+	free( fill );
+
+	if( options.debug )
+		printf( "overlay_index_build: grid %s,%s of %ldx%ld (%ld good cells) in %ldx%ld buckets, %.1f ms\n",
+			x_name, y_name, (long)nx, (long)ny, n_good, idx->nbx, idx->nby,
+			util_time_msec() - t_start );
+
+	return( idx );
+}
+
+/*============================================================================*/
+	static void
+overlay_index_free( OverlayIndex *idx )
+{
+	free( idx->xvals );
+	free( idx->yvals );
+	free( idx->cell_id );
+	free( idx->bucket_start );
+	free( idx );
+}
+
+/*============================================================================*/
+/* Returns the cell nearest (x,y), or -1 if it isn't on the grid.  Buckets
+ * are searched in rings around the one the point is in.  Once ring r has
+ * been searched, everything further out is at least r bucket sizes away,
+ * so we can stop as soon as the best so far is closer than that.
+ */
+	static long
+overlay_index_nearest( OverlayIndex *idx, float x, float y )
+{
+	long	bx, by, r, rmax, i, j, step, b, c, k, best, ci, cj, ni, nj, nb_k;
+	float	dx, dy, d, best_d, reach, near_d;
+
+	if( (x < idx->xmin - idx->bw) || (x > idx->xmax + idx->bw) ||
+	    (y < idx->ymin - idx->bh) || (y > idx->ymax + idx->bh) )
+		return( -1L );
+
+	bx = (long)((x - idx->xmin) / idx->bw);
+	by = (long)((y - idx->ymin) / idx->bh);
+	if( bx < 0 ) bx = 0;
+	if( by < 0 ) by = 0;
+	if( bx >= idx->nbx ) bx = idx->nbx - 1;
+	if( by >= idx->nby ) by = idx->nby - 1;
+
+	reach = (idx->bw < idx->bh) ? idx->bw : idx->bh;
+	rmax  = (idx->nbx > idx->nby) ? idx->nbx : idx->nby;
+	best   = -1L;
+	best_d = 0.0;
+	for( r=0; r<=rmax; r++ ) {
+		for( j=by-r; j<=by+r; j++ ) {
+			if( (j < 0) || (j >= idx->nby) )
+				continue;
+			/* Rows inside the ring only have its two ends */
+			step = ((j == by-r) || (j == by+r) || (r == 0)) ? 1 : 2*r;
+			for( i=bx-r; i<=bx+r; i+=step ) {
+				if( (i < 0) || (i >= idx->nbx) )
+					continue;
+				b = i + j*idx->nbx;
+				for( c=idx->bucket_start[b]; c<idx->bucket_start[b+1]; c++ ) {
+					k  = idx->cell_id[c];
+					dx = x - idx->xvals[k];
+					dy = y - idx->yvals[k];
+					d  = dx*dx + dy*dy;
+					if( (best < 0) || (d < best_d) ) {
+						best   = k;
+						best_d = d;
+						}
+					}
+				}
+			}
+		if( (best >= 0) && (best_d <= (r*reach)*(r*reach)) )
+			break;
+		}
+
+	if( best < 0 )
+		return( -1L );
+
+	/* Only take it if it's within two cell widths, going by the
+	 * distance from the cell to its neighbors.
+	 */
+	ci = best % (long)idx->nx;
+	cj = best / (long)idx->nx;
+	near_d = 0.0;
+	for( nj=cj-1; nj<=cj+1; nj++ )
+	for( ni=ci-1; ni<=ci+1; ni++ ) {
+		if( (ni < 0) || (nj < 0) || (ni >= (long)idx->nx) || (nj >= (long)idx->ny) )
+			continue;
+		nb_k = ni + nj*(long)idx->nx;
+		dx = idx->xvals[nb_k] - idx->xvals[best];
+		dy = idx->yvals[nb_k] - idx->yvals[best];
+		d  = dx*dx + dy*dy;
+		if( (d == d) && (d < OVERLAY_BAD_COORD) && (d > near_d) )
+			near_d = d;
+		}
+	if( (near_d > 0.0) && (best_d > 4.0*near_d) )
+		return( -1L );
+
+	return( best );
+}
+
+/*============================================================================*/
+	static void
+overlay_query_band( OverlayQuery *q )
+{
+	long	k;
+
+	for( k=q->k_start; k<q->k_end; k++ )
+		q->cell[k] = overlay_index_nearest( q->idx, q->pts[2*k], q->pts[2*k+1] );
+}
+
+#ifdef HAVE_PTHREAD
+/*============================================================================*/
+	static void *
+overlay_query_band_thread( void *arg )
+{
+	overlay_query_band( (OverlayQuery *)arg );
+	return( NULL );
+}
+#endif
+
+/*============================================================================*/
+/* How many threads to look the points up in.  options.n_threads of 0 means
+ * pick based on the number of processors.
+ */
+	static int
+overlay_n_threads( long npts )
+{
+	long	n;
+
+#ifdef HAVE_PTHREAD
+	if( npts < OVERLAY_THREAD_MIN_POINTS )
+		return( 1 );
+
+	n = options.n_threads;
+	if( n <= 0 ) {
+		n = sysconf( _SC_NPROCESSORS_ONLN );
+		if( n > 8 )
+			n = 8;
+		}
+	if( n > OVERLAY_MAX_THREADS )
+		n = OVERLAY_MAX_THREADS;
+	if( n < 1 )
+		n = 1;
+	return( (int)n );
+#else
+	return( 1 );
+#endif
+}
@@ -0,0 +1,257 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Progressive display of slow reads (-progressive N).  With compressed
+ * data or files on a network disk, reading a big slice can take seconds.
+ * Instead, we first read only every N'th point along X and Y, and show
+ * that with each point filling its NxN block, with the view's data status
+ * VDS_PREVIEW.  The full slice is then read a band of rows at a time from
+ * an Xt work procedure, so the interface keeps running, and is shown when
+ * it is all in.  Reading anything else into the view (a new frame, a new
+ * variable, and so forth) calls fill_view_data, which cancels the
+ * refinement.  Not used while animating, where each frame is replaced
+ * before it could be refined anyway.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+/* Slices smaller than this are quick enough to just read */
+#define PROGRESSIVE_MIN_POINTS		65536L
+
+/* About how many points to read each time the work procedure runs */
+#define PROGRESSIVE_CHUNK_POINTS	262144L
+
+extern Options  options;
+extern View	*view;
+
+/* The refinement under way */
+static struct {
+	int	pending;
+	NCVar	*var;
+	size_t	*place;			/* where the view was in var when we started */
+	size_t	nx, ny, next_row, n_rows;
+	float	*data;			/* full resolution slice, as it comes in */
+} refine = { FALSE, NULL, NULL, 0L, 0L, 0L, 0L, NULL };
+
+static Boolean	progressive_refine( XtPointer client_data );
+static void	progressive_free( void );
+
+/*============================================================================*/
+/* Returns TRUE if the slice of the view should be shown progressively.  The
+ * caller also has to know the whole slice is wanted (no shrinking by
+ * reading only some of it).
+ */
+	int
+progressive_wanted( View *v )
+{
+	int	button;
+	size_t	nx, ny;
+
+	if( (options.progressive_stride <= 1) || options.dump_frames ||
+	    (options.stream_file != NULL) || options.render->doit ||
+	    (v != view) || (v->data_status == VDS_EDITED) )
+		return( FALSE );
+
+	button = which_button_pressed();
+	if( (button == BUTTON_FASTFORWARD) || (button == BUTTON_REWIND) )
+		return( FALSE );
+
+	nx = *(v->variable->size + v->x_axis_id);
+	ny = *(v->variable->size + v->y_axis_id);
+	return( nx*ny >= PROGRESSIVE_MIN_POINTS );
+}
+
+/*============================================================================*/
+/* Reads the preview of the current slice of the view into v->data, and
+ * starts reading the rest of it in the background.
+ */
+	void
+progressive_start( View *v )
+{
+	size_t	*start, *count, nx, ny, cnx, cny, i, j, s;
+	ptrdiff_t *stride;
+	float	*coarse;
+	int	k;
+	double	t_start;
+
+	progressive_cancel();
+
+	s  = options.progressive_stride;
+	nx = *(v->variable->size + v->x_axis_id);
+	ny = *(v->variable->size + v->y_axis_id);
+	cnx = (nx + s - 1)/s;
+	cny = (ny + s - 1)/s;
+
+	start  = (size_t *)malloc( v->variable->n_dims * sizeof( size_t ));
+	count  = (size_t *)malloc( v->variable->n_dims * sizeof( size_t ));
+	stride = (ptrdiff_t *)malloc( v->variable->n_dims * sizeof( ptrdiff_t ));
+	coarse = (float *)malloc( cnx*cny*sizeof(float) );
+	refine.data = (float *)malloc( nx*ny*sizeof(float) );
+	if( (start == NULL) || (count == NULL) || (stride == NULL) || (coarse == NULL) || (refine.data == NULL) ) {
+		fprintf( stderr, "ncview: progressive_start: failed to allocate space for %ldx%ld slice\n",
+			(long)nx, (long)ny );
+		exit( -1 );
+		}
+
+	for( k=0; k<v->variable->n_dims; k++ ) {
+		*(start+k)  = *(v->var_place+k);
+		*(count+k)  = 1;
+		*(stride+k) = 1;
+		}
+	*(count+v->x_axis_id)  = cnx;
+	*(count+v->y_axis_id)  = cny;
+	*(stride+v->x_axis_id) = s;
+	*(stride+v->y_axis_id) = s;
+
+	t_start = util_time_msec();
+	fi_get_data_strided( v->variable, start, count, stride, coarse );
+	timing_add( TIMING_READ, t_start );
+
+	/* Each point we read stands for the block it starts */
+	for( j=0; j<ny; j++ )
+	for( i=0; i<nx; i++ )
+		*((float *)v->data + i + j*nx) = *(coarse + i/s + (j/s)*cnx);
+
+	v->data_stride = 1;
+	v->data_status = VDS_PREVIEW;
+
+	refine.var      = v->variable;
+	refine.place    = start;
+	refine.nx       = nx;
+	refine.ny       = ny;
+	refine.next_row = 0L;
+	refine.n_rows   = PROGRESSIVE_CHUNK_POINTS / nx;
+	if( refine.n_rows < 1 )
+		refine.n_rows = 1;
+	refine.pending  = TRUE;
+
+	if( options.debug )
+		printf( "progressive_start: showing every %ld'th point of %s, reading the rest %ld rows at a time\n",
+			(long)s, v->variable->name, (long)refine.n_rows );
+
+	in_workproc_set( WORKPROC_REFINE, (XtWorkProc)progressive_refine, NULL );
+
+	free( count );
+	free( stride );
+	free( coarse );
+}
+
+/*============================================================================*/
+/* Returns TRUE if the full slice is still being read */
+	int
+progressive_pending( void )
+{
+	return( refine.pending );
+}
+
+/*============================================================================*/
+/* Stops reading the full slice, if we are */
+	void
+progressive_cancel( void )
+{
+	if( ! refine.pending )
+		return;
+
+	if( options.debug )
+		printf( "progressive_cancel: dropping refinement of %s at row %ld of %ld\n",
+			refine.var->name, (long)refine.next_row, (long)refine.ny );
+	in_workproc_clear( WORKPROC_REFINE );
+	progressive_free();
+}
+
+/*============================================================================*/
+/* The work procedure.  Reads the next band of rows, and when they are all
+ * in, puts the full slice in the view and redraws it.  Returns True when
+ * there is nothing more to do.
+ */
+	static Boolean
+progressive_refine( XtPointer client_data )
+{
+	size_t	*count, n_rows;
+	int	k;
+	double	t_start;
+
+	if( ! refine.pending )
+		return( True );
+
+	/* Should have been cancelled, but make sure the view hasn't moved on */
+	if( (view == NULL) || (view->variable != refine.var) || (view->data_status != VDS_PREVIEW) ) {
+		progressive_free();
+		return( True );
+		}
+	for( k=0; k<refine.var->n_dims; k++ )
+		if( (k != view->x_axis_id) && (k != view->y_axis_id) &&
+		    (*(view->var_place+k) != *(refine.place+k)) ) {
+			progressive_free();
+			return( True );
+			}
+
+	if( refine.next_row < refine.ny ) {
+		n_rows = refine.n_rows;
+		if( refine.next_row + n_rows > refine.ny )
+			n_rows = refine.ny - refine.next_row;
+
+		count = (size_t *)malloc( refine.var->n_dims * sizeof( size_t ));
+		for( k=0; k<refine.var->n_dims; k++ )
+			*(count+k) = 1;
+		*(count+view->x_axis_id) = refine.nx;
+		*(count+view->y_axis_id) = n_rows;
+		*(refine.place+view->y_axis_id) = refine.next_row;
+
+		t_start = util_time_msec();
+		fi_get_data( refine.var, refine.place, count, refine.data + refine.next_row*refine.nx );
+		timing_add( TIMING_READ, t_start );
+
+		*(refine.place+view->y_axis_id) = 0L;
+		free( count );
+
+		refine.next_row += n_rows;
+		if( refine.next_row < refine.ny )
+			return( False );
+		}
+
+	if( options.debug )
+		printf( "progressive_refine: have all of %s, redrawing\n", refine.var->name );
+
+	/* If the view is busy being drawn (say, a dialog is up), give up; the
+	 * preview is then read again in full the next time it is drawn.
+	 */
+	view_set_refined_data( refine.data );
+	progressive_free();
+
+	return( True );
+}
+
+/*============================================================================*/
+	static void
+progressive_free( void )
+{
+	if( refine.place != NULL )
+		free( refine.place );
+	if( refine.data != NULL )
+		free( refine.data );
+	refine.place   = NULL;
+	refine.data    = NULL;
+	refine.pending = FALSE;
+}
@@ -0,0 +1,389 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Pyramids of shrunken versions of big 2-D fields (-pyramid DIR).  When a
+ * large slice is shrunk by averaging, the first time we read the whole
+ * thing as usual, but then also write a sidecar file in DIR holding the
+ * slice averaged over 2x2, 4x4, 8x8, ... blocks.  After that, shrinking
+ * that slice by N reads the level for the largest power of two that
+ * divides N from the sidecar, which is memory mapped, so only that level
+ * is read in; contract_data then averages it the rest of the way.  The
+ * sidecars last between sessions.  Their names are a hash of the
+ * variable, the slice, and the name, size, and modification time of the
+ * file the slice is in, so a changed file gets a new sidecar.
+ *
+ * Block means follow contract_data: any missing point makes the block
+ * missing, and blocks hanging off the right or top edge repeat the last
+ * row or column.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+#include <sys/mman.h>
+
+/* Slices smaller than this are quick enough to just read */
+#define PYRAMID_MIN_POINTS	(1024L*1024L)
+
+#define PYRAMID_MAX_LEVELS	24
+#define PYRAMID_MAGIC		"NCVPYR1"
+
+extern Options  options;
+
+/* At the start of each sidecar file.  Level k is ceil(nx/2^k) by
+ * ceil(ny/2^k) floats starting at byte offset[k]; level 0, the data
+ * itself, is not kept.
+ */
+typedef struct {
+	char		magic[8];
+	unsigned long long key;
+	long		nx, ny;
+	int		n_levels;
+	float		fill_value;
+	long		offset[PYRAMID_MAX_LEVELS+1];
+} PyramidHeader;
+
+/* The sidecar now mapped in */
+static char		map_path[2048] = "";
+static void		*map_addr = NULL;
+static size_t		map_len = 0L;
+
+/* Set if a sidecar could not be written, or could not be read right after
+ * it was written, so we don't keep trying
+ */
+static int		pyramid_failed = FALSE;
+
+/* Set by pyramid_build until the next pyramid_read */
+static int		just_built = FALSE;
+
+static unsigned long long pyramid_key( View *v, char *path, size_t len );
+static int		pyramid_n_levels( long nx, long ny );
+static float		*pyramid_reduce( float *src, size_t nx, size_t ny, float fill_value );
+static PyramidHeader	*pyramid_map( char *path );
+static int		pyramid_read_level( View *v, int stride );
+
+/*============================================================================*/
+/* The reduction, in points along X and Y, of the pyramid level we would
+ * like in v->data for the current blowup: the largest power of two that
+ * divides the shrink factor.  Returns 1 if the pyramid can't be used.
+ */
+	int
+pyramid_stride_wanted( View *v )
+{
+	int	n, s, k;
+	long	nx, ny;
+
+	if( (options.pyramid_dir == NULL) || pyramid_failed || (options.blowup >= -1) )
+		return( 1 );
+
+	nx = *(v->variable->size + v->x_axis_id);
+	ny = *(v->variable->size + v->y_axis_id);
+	if( nx*ny < PYRAMID_MIN_POINTS )
+		return( 1 );
+
+	n = -options.blowup;
+	s = 1;
+	for( k=0; k<pyramid_n_levels( nx, ny ); k++ ) {
+		if( (n % (s*2)) != 0 )
+			break;
+		s *= 2;
+		}
+	return( s );
+}
+
+/*============================================================================*/
+/* Puts the pyramid level reduced by 'stride' for the current slice of the
+ * view into v->data.  Returns 0 on success, or -1 if there is no sidecar
+ * for this slice yet.
+ */
+	int
+pyramid_read( View *v, int stride )
+{
+	int		err;
+
+	err = pyramid_read_level( v, stride );
+
+	/* If we can't read what we just wrote, the same will happen every
+	 * time, so give up on pyramids
+	 */
+	if( (err != 0) && just_built ) {
+		fprintf( stderr, "ncview: can't read back the pyramid file just written; not using pyramids\n" );
+		pyramid_failed = TRUE;
+		}
+	just_built = FALSE;
+
+	return( err );
+}
+
+/*============================================================================*/
+/* Does the work of pyramid_read */
+	static int
+pyramid_read_level( View *v, int stride )
+{
+	char		path[2048];
+	unsigned long long key;
+	PyramidHeader	*hdr;
+	int		k;
+	size_t		nx, ny;
+
+	key = pyramid_key( v, path, 2048 );
+	if( (hdr = pyramid_map( path )) == NULL )
+		return( -1 );
+
+	for( k=0; (1<<k) < stride; k++ )
+		;
+	if( (hdr->key != key) ||
+	    (hdr->nx != *(v->variable->size + v->x_axis_id)) ||
+	    (hdr->ny != *(v->variable->size + v->y_axis_id)) ||
+	    (k < 1) || (k > hdr->n_levels) || ((1<<k) != stride) ) {
+		if( options.debug )
+			printf( "pyramid_read: sidecar %s doesn't match, ignoring it\n", path );
+		return( -1 );
+		}
+
+	nx = (hdr->nx + stride - 1)/stride;
+	ny = (hdr->ny + stride - 1)/stride;
+	if( hdr->offset[k] + nx*ny*sizeof(float) > map_len ) {
+		fprintf( stderr, "ncview: pyramid file %s is truncated; ignoring it\n", path );
+		return( -1 );
+		}
+
+	if( options.debug )
+		printf( "pyramid_read: level %d (%ldx%ld) from %s\n", k, (long)nx, (long)ny, path );
+	memcpy( v->data, (char *)map_addr + hdr->offset[k], nx*ny*sizeof(float) );
+	return( 0 );
+}
+
+/*============================================================================*/
+/* Writes the sidecar for the current slice of the view, whose full
+ * resolution data must be in v->data.  Returns 0 on success, -1 on error.
+ */
+	int
+pyramid_build( View *v )
+{
+	char		path[2048], tmp_path[2100];
+	PyramidHeader	hdr;
+	FILE		*f;
+	float		*level, *prev;
+	size_t		nx, ny, n;
+	int		k, err;
+
+	if( v->data_stride != 1 )
+		return( -1 );
+
+	memset( &hdr, 0, sizeof(hdr) );
+	strcpy( hdr.magic, PYRAMID_MAGIC );
+	hdr.key        = pyramid_key( v, path, 2048 );
+	hdr.nx         = *(v->variable->size + v->x_axis_id);
+	hdr.ny         = *(v->variable->size + v->y_axis_id);
+	hdr.n_levels   = pyramid_n_levels( hdr.nx, hdr.ny );
+	hdr.fill_value = v->variable->fill_value;
+	hdr.offset[1]  = sizeof(hdr);
+	for( k=2; k<=hdr.n_levels; k++ ) {
+		nx = (hdr.nx + (1L<<(k-1)) - 1) >> (k-1);
+		ny = (hdr.ny + (1L<<(k-1)) - 1) >> (k-1);
+		hdr.offset[k] = hdr.offset[k-1] + nx*ny*sizeof(float);
+		}
+
+	mkdir( options.pyramid_dir, 0755 );
+	snprintf( tmp_path, 2100, "%s.%d", path, (int)getpid() );
+	if( (f = fopen( tmp_path, "wb" )) == NULL ) {
+		fprintf( stderr, "ncview: can't write pyramid file %s; not using pyramids\n", tmp_path );
+		pyramid_failed = TRUE;
+		return( -1 );
+		}
+
+	if( options.debug )
+		printf( "pyramid_build: writing %d levels for %s to %s\n", hdr.n_levels, v->variable->name, path );
+	TRACE_BEGIN( "pyramid_build", v->variable->name );
+
+	err = (fwrite( &hdr, sizeof(hdr), 1, f ) != 1);
+	prev = (float *)v->data;
+	nx   = hdr.nx;
+	ny   = hdr.ny;
+	for( k=1; (k<=hdr.n_levels) && (! err); k++ ) {
+		level = pyramid_reduce( prev, nx, ny, hdr.fill_value );
+		if( prev != (float *)v->data )
+			free( prev );
+		nx = (nx+1)/2;
+		ny = (ny+1)/2;
+		n  = nx*ny;
+		err = (fwrite( level, sizeof(float), n, f ) != n);
+		prev = level;
+		}
+	if( prev != (float *)v->data )
+		free( prev );
+	if( fclose( f ) != 0 )
+		err = TRUE;
+
+	TRACE_END( "pyramid_build" );
+
+	/* Only let others see it once it is complete */
+	if( err || (rename( tmp_path, path ) != 0)) {
+		fprintf( stderr, "ncview: error writing pyramid file %s; not using pyramids\n", tmp_path );
+		unlink( tmp_path );
+		pyramid_failed = TRUE;
+		return( -1 );
+		}
+
+	/* Any old version of it that we have mapped in is stale */
+	if( (map_addr != NULL) && (strcmp( path, map_path ) == 0)) {
+		munmap( map_addr, map_len );
+		map_addr = NULL;
+		}
+
+	just_built = TRUE;
+	return( 0 );
+}
+
+/*============================================================================*/
+/* Number of levels above the data itself; the last is 1x1 */
+	static int
+pyramid_n_levels( long nx, long ny )
+{
+	int	k;
+
+	for( k=0; ((nx > 1) || (ny > 1)) && (k < PYRAMID_MAX_LEVELS); k++ ) {
+		nx = (nx+1)/2;
+		ny = (ny+1)/2;
+		}
+	return( k );
+}
+
+/*============================================================================*/
+/* Averages src over 2x2 blocks, the same way contract_data does */
+	static float *
+pyramid_reduce( float *src, size_t nx, size_t ny, float fill_value )
+{
+	size_t	i, j, ii, jj, io, jo, new_nx, new_ny;
+	float	*dst, val;
+	double	sum;
+	int	missing;
+
+	new_nx = (nx+1)/2;
+	new_ny = (ny+1)/2;
+	dst = (float *)malloc( new_nx*new_ny*sizeof(float) );
+	if( dst == NULL ) {
+		fprintf( stderr, "ncview: pyramid_reduce: failed to allocate %ldx%ld level\n", (long)new_nx, (long)new_ny );
+		exit( -1 );
+		}
+
+	for( j=0; j<new_ny; j++ )
+	for( i=0; i<new_nx; i++ ) {
+		sum     = 0.0;
+		missing = FALSE;
+		for( jj=0; jj<2; jj++ )
+		for( ii=0; ii<2; ii++ ) {
+			io = 2*i + ii;
+			jo = 2*j + jj;
+			if( io >= nx )
+				io = nx-1;
+			if( jo >= ny )
+				jo = ny-1;
+			val = *(src + io + jo*nx);
+			if( close_enough( val, fill_value ))
+				missing = TRUE;
+			sum += val;
+			}
+		*(dst + i + j*new_nx) = missing ? fill_value : (float)(sum*0.25);
+		}
+
+	return( dst );
+}
+
+/*============================================================================*/
+/* Maps in the sidecar file, unless it already is.  Returns a pointer to
+ * its header, or NULL if there is no such file.
+ */
+	static PyramidHeader *
+pyramid_map( char *path )
+{
+	int		fd;
+	struct stat	st;
+	void		*addr;
+
+	if( (map_addr != NULL) && (strcmp( path, map_path ) == 0))
+		return( (PyramidHeader *)map_addr );
+
+	if( (fd = open( path, O_RDONLY )) < 0 )
+		return( NULL );
+	if( (fstat( fd, &st ) != 0) || ((size_t)st.st_size < sizeof(PyramidHeader)) ) {
+		close( fd );
+		return( NULL );
+		}
+	addr = mmap( NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	close( fd );
+	if( addr == MAP_FAILED )
+		return( NULL );
+	if( strncmp( ((PyramidHeader *)addr)->magic, PYRAMID_MAGIC, 8 ) != 0 ) {
+		munmap( addr, (size_t)st.st_size );
+		return( NULL );
+		}
+
+	if( map_addr != NULL )
+		munmap( map_addr, map_len );
+	map_addr = addr;
+	map_len  = (size_t)st.st_size;
+	strncpy( map_path, path, 2047 );
+	map_path[2047] = '\0';
+
+	return( (PyramidHeader *)map_addr );
+}
+
+/*============================================================================*/
+/* Works out the key that identifies the current slice of the view, and
+ * the name of the sidecar file for it.
+ */
+	static unsigned long long
+pyramid_key( View *v, char *path, size_t len )
+{
+	unsigned long long h;
+	FDBlist		*fdb;
+	struct stat	st;
+	int		i;
+
+	h = UTIL_HASH_INIT;
+
+	h = util_hash_bytes( h, v->variable->name, strlen( v->variable->name ));
+	h = util_hash_bytes( h, &(v->x_axis_id), sizeof(int) );
+	h = util_hash_bytes( h, &(v->y_axis_id), sizeof(int) );
+	for( i=0; i<v->variable->n_dims; i++ )
+		if( (i != v->x_axis_id) && (i != v->y_axis_id) )
+			h = util_hash_bytes( h, v->var_place+i, sizeof(size_t) );
+	h = util_hash_bytes( h, &(v->variable->fill_value), sizeof(float) );
+	h = util_hash_bytes( h, &(options.scale),  sizeof(float) );
+	h = util_hash_bytes( h, &(options.offset), sizeof(float) );
+
+	/* The file that this slice comes from */
+	fdb = v->variable->first_file;
+	if( v->variable->is_virtual )
+		fdb = timestep_fdb( v->variable, *(v->var_place) );
+	h = util_hash_bytes( h, fdb->filename, strlen( fdb->filename ));
+	if( stat( fdb->filename, &st ) == 0 ) {
+		h = util_hash_bytes( h, &(st.st_size),  sizeof(st.st_size) );
+		h = util_hash_bytes( h, &(st.st_mtime), sizeof(st.st_mtime) );
+		}
+
+	snprintf( path, len, "%s/ncview_%016llx.pyr", options.pyramid_dir, h );
+	return( h );
+}
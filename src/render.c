@@ -0,0 +1,774 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Rendering frames straight to PNG files, with no X display at all
+ * (ncview -render VAR ...).  This is meant for making movies on machines
+ * that have the data but no display.  The frames go through the same
+ * steps as when they are shown on the screen (fill_view_data, then
+ * data_to_pixels with the same colormaps), so they look the same.
+ *
+ * The frames can be spread across several worker processes with -procs N.
+ * Each worker opens the files itself, since netCDF file handles can't be
+ * shared between processes, and takes every N'th frame.
+ *
+ * Compressing the PNG files takes longer than making the frames, so the
+ * files are written by a pool of encoder threads (png_queue_frame), which
+ * is also used when dumping frames from the display with -frames.
+ *
+ * With -stream, the frames go out as one video stream instead of PNG
+ * files (see stream.c).  When there are several workers, each sends its
+ * frames back to the main process through a pipe, and the main process
+ * puts them in order on the stream.  Each message on a pipe is a size_t
+ * length followed by that many bytes; a length of zero means a frame that
+ * could not be rendered.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+#include <sys/wait.h>
+#include <errno.h>
+
+#ifdef HAVE_PNG
+#include <png.h>
+#include <setjmp.h>
+#endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+extern Options  options;
+extern Cmaplist	*colormap_list;
+
+#ifdef HAVE_PNG
+/* Frames waiting to be written by the PNG encoder threads.  Queueing a
+ * frame blocks when the queue is full, so the drawing can't get more
+ * than this far ahead of the encoders.
+ */
+#define PNG_QUEUE_LEN		16
+#define PNG_MAX_THREADS		16
+
+typedef struct {
+	char		*filename;
+	unsigned char	*data;
+	size_t		width, height;
+	png_color	palette[256];
+	int		n_palette;
+} PNGJob;
+
+static int	png_encode( char *filename, unsigned char *data, size_t width, size_t height,
+			png_color *palette, int n_palette );
+static void	png_set_palette( png_color *palette, XColor *color_list, int n_palette );
+
+static int		png_n_errors = 0, png_n_threads = 0;
+
+#ifdef HAVE_PTHREAD
+static PNGJob		*png_queue[PNG_QUEUE_LEN];
+static int		png_queue_head = 0, png_queue_count = 0, png_shutting_down = 0;
+static pthread_t	png_threads[PNG_MAX_THREADS];
+static pthread_mutex_t	png_lock      = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	png_not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t	png_not_full  = PTHREAD_COND_INITIALIZER;
+
+static void	png_start_threads( void );
+static void	*png_encoder_thread( void *arg );
+#endif
+#endif
+
+static int 	render_worker( int worker, int n_workers, Stringlist *input_files,
+			FILE *stream, int to_pipe );
+static XColor	*render_find_colormap( char *name, char **found_name );
+static int	render_send( FILE *f, int to_pipe, void *buf, size_t len );
+static int	render_relay( FILE **pipes, int n_pipes, FILE *stream );
+
+/*============================================================================*/
+/* Renders the frames asked for on the command line; returns the exit
+ * status for the program.
+ */
+	int
+render_main( Stringlist *input_files )
+{
+	int	i, j, n_procs, n_failed, status, fds[2], *write_fds;
+	pid_t	pid, *pids;
+	FILE	*stream, **pipes;
+
+#ifndef HAVE_PNG
+	/* Frames sent to a -stream don't go through libpng */
+	if( options.stream_file == NULL ) {
+		fprintf( stderr, "ncview: -render needs PNG support to write frame files, but this copy of ncview was compiled without it; use -stream instead\n" );
+		return( -1 );
+		}
+#endif
+
+	if( options.render->var_name == NULL ) {
+		fprintf( stderr, "ncview: -render must be followed by the name of the variable to render\n" );
+		return( -1 );
+		}
+
+	if( (options.render->outdir != NULL) && (mkdir( options.render->outdir, 0777 ) != 0) &&
+	    (errno != EEXIST)) {
+		fprintf( stderr, "ncview: can't make output directory \"%s\"\n", options.render->outdir );
+		return( -1 );
+		}
+
+	/* Without a display we always work with colormap indices, the way we
+	 * do on a TrueColor display
+	 */
+	options.display_type = TrueColor;
+
+	stream = NULL;
+	if( options.stream_file != NULL ) {
+		if( (stream = stream_open( options.stream_file )) == NULL )
+			return( -1 );
+		}
+
+	n_procs = options.render->n_procs;
+	if( n_procs <= 1 ) {
+		n_failed = render_worker( 0, 1, input_files, stream, FALSE );
+		if( stream != NULL )
+			fclose( stream );
+		return( (n_failed == 0) ? 0 : -1 );
+		}
+
+	pipes     = NULL;
+	write_fds = NULL;
+	if( stream != NULL ) {
+		pipes     = (FILE **)malloc( n_procs * sizeof(FILE *) );
+		write_fds = (int *)malloc( n_procs * sizeof(int) );
+		for( i=0; i<n_procs; i++ ) {
+			if( (pipe( fds ) != 0) || ((pipes[i] = fdopen( fds[0], "rb" )) == NULL)) {
+				fprintf( stderr, "ncview: failed to make pipe for render worker %d\n", i );
+				exit( -1 );
+				}
+			write_fds[i] = fds[1];
+			}
+		}
+
+	/* Start the workers before any files are opened, so that none of
+	 * them share a netCDF file handle.
+	 */
+	pids = (pid_t *)malloc( n_procs * sizeof(pid_t) );
+	fflush( NULL );
+	for( i=0; i<n_procs; i++ ) {
+		pid = fork();
+		if( pid < 0 ) {
+			fprintf( stderr, "ncview: failed to start render worker process %d\n", i );
+			exit( -1 );
+			}
+		if( pid == 0 ) {
+			timing_detach();
+			if( stream == NULL )
+				exit( render_worker( i, n_procs, input_files, NULL, FALSE ) == 0 ? 0 : 1 );
+			for( j=0; j<n_procs; j++ ) {
+				close( fileno( pipes[j] ));
+				if( j != i )
+					close( write_fds[j] );
+				}
+			close( fileno( stream ));
+			exit( render_worker( i, n_procs, input_files,
+				fdopen( write_fds[i], "wb" ), TRUE ) == 0 ? 0 : 1 );
+			}
+		pids[i] = pid;
+		}
+
+	n_failed = 0;
+	if( stream != NULL ) {
+		for( i=0; i<n_procs; i++ )
+			close( write_fds[i] );
+		if( render_relay( pipes, n_procs, stream ) != 0 )
+			n_failed++;
+		/* Closing our ends lets any worker still writing finish with an error */
+		for( i=0; i<n_procs; i++ )
+			fclose( pipes[i] );
+		fclose( stream );
+		free( pipes );
+		free( write_fds );
+		}
+
+	for( i=0; i<n_procs; i++ ) {
+		if( (waitpid( pids[i], &status, 0 ) < 0) || (! WIFEXITED(status)) || (WEXITSTATUS(status) != 0) ) {
+			fprintf( stderr, "ncview: render worker %d failed\n", i );
+			n_failed++;
+			}
+		}
+	free( pids );
+
+	return( (n_failed == 0) ? 0 : -1 );
+}
+
+/*============================================================================*/
+/* Renders every n_workers'th frame, starting with frame number 'worker'
+ * of the ones asked for.  If stream is NULL the frames are written to PNG
+ * files; otherwise they are converted and written to the stream, with
+ * each one sent as a message if to_pipe is TRUE.  Returns the number of
+ * frames that could not be written.
+ */
+	static int
+render_worker( int worker, int n_workers, Stringlist *input_files, FILE *stream, int to_pipe )
+{
+	NCVar	*var;
+	View	*v;
+	XColor	*color_list;
+	char	*cmap_name, filename[2048], hdr[256];
+	long	first, last, stride, place, seq, size;
+	size_t	x_size, y_size, width, height, nbytes;
+	int	n_done, n_failed, n_unwritten, hdr_len;
+	float	min, max;
+	unsigned char *frame;
+
+	initialize_file_interface( input_files );
+
+	if( (var = get_var( options.render->var_name )) == NULL ) {
+		fprintf( stderr, "ncview: -render: no variable named \"%s\" found in the files\n",
+			options.render->var_name );
+		return( -1 );
+		}
+
+	TRACE_BEGIN( "initialize_colormaps", NULL );
+	initialize_colormaps();
+	TRACE_END( "initialize_colormaps" );
+	if( (color_list = render_find_colormap( options.render->colormap, &cmap_name )) == NULL ) {
+		fprintf( stderr, "ncview: -render: no colormap named \"%s\"\n", options.render->colormap );
+		return( -1 );
+		}
+
+	v = view_new_offscreen( var );
+	if( v->y_axis_id == -1 ) {
+		fprintf( stderr, "ncview: -render: variable \"%s\" is not at least two dimensional\n", var->name );
+		return( -1 );
+		}
+
+	/* Set the data range.  This is the same calculation in every worker,
+	 * so they all get the same answer.
+	 */
+	if( options.render->have_range ) {
+		var->user_min = options.render->min;
+		var->user_max = options.render->max;
+		var->have_set_range = TRUE;
+		}
+	else
+		{
+		TRACE_BEGIN( "init_min_max", var->name );
+		init_min_max( var );
+		TRACE_END( "init_min_max" );
+		}
+
+	/* data_to_pixels would ask the user what to do about a range of
+	 * zero; there is nobody to ask, so just widen it
+	 */
+	if( var->user_min == var->user_max ) {
+		if( var->user_min == 0.0 ) {
+			var->user_min = -1.0;
+			var->user_max =  1.0;
+			}
+		else
+			{
+			min = var->user_min - 0.1*fabs(var->user_min);
+			max = var->user_max + 0.1*fabs(var->user_max);
+			var->user_min = min;
+			var->user_max = max;
+			}
+		}
+
+	if( v->scan_axis_id == -1 )
+		size = 1L;
+	else
+		size = (long)*(var->size + v->scan_axis_id);
+
+	first  = options.render->first;
+	last   = options.render->last;
+	stride = options.render->stride;
+	if( first < 1 )
+		first = 1;
+	if( (last <= 0) || (last > size) )
+		last = size;
+	if( stride < 1 )
+		stride = 1;
+
+	x_size = *(var->size + v->x_axis_id);
+	y_size = *(var->size + v->y_axis_id);
+	view_get_scaled_size( options.blowup, x_size, y_size, &width, &height );
+
+	if( worker == 0 ) {
+		printf( "rendering %s frames %ld to %ld (step %ld) at %ldx%ld with colormap %s, range %g to %g, using %d process%s\n",
+			var->name, first, last, stride, (long)width, (long)height, cmap_name,
+			var->user_min, var->user_max, n_workers, (n_workers == 1) ? "" : "es" );
+		if( stream != NULL ) {
+			hdr_len = stream_header( hdr, 256, options.stream_format, width, height, options.stream_fps );
+			if( options.stream_format == STREAM_RGB )
+				printf( "stream is raw rgb24, %ldx%ld at %d frames/sec\n",
+					(long)width, (long)height, options.stream_fps );
+			if( render_send( stream, to_pipe, hdr, hdr_len ) != 0 )
+				return( -1 );
+			}
+		}
+
+	n_done   = 0;
+	n_failed = 0;
+	seq      = 0;
+	for( place=first-1; place<last; place += stride ) {
+		if( (seq % n_workers) == worker ) {
+
+			if( view_render_offscreen( v, (size_t)place ) != 0 ) {
+				fprintf( stderr, "ncview: -render: failed to render frame %ld of %s\n", place+1, var->name );
+				n_failed++;
+				if( to_pipe && (render_send( stream, to_pipe, NULL, 0L ) != 0))
+					return( -1 );
+				}
+			else if( stream != NULL ) {
+				frame = stream_convert( v->pixels, width, height, color_list,
+					options.n_colors+options.n_extra_colors, options.stream_format, &nbytes );
+				if( render_send( stream, to_pipe, frame, nbytes ) != 0 ) {
+					fprintf( stderr, "ncview: -render: error writing frame %ld to the stream\n", place+1 );
+					return( -1 );
+					}
+				n_done++;
+				timing_frame_done( var->name, place );
+				}
+			else
+				{
+				/* Files are numbered in sequence from 0 so they can go straight into a movie encoder */
+				if( options.render->outdir == NULL )
+					snprintf( filename, 2047, "frame.%05ld.png", seq );
+				else
+					snprintf( filename, 2047, "%s/frame.%05ld.png", options.render->outdir, seq );
+
+#ifdef HAVE_PNG
+				png_queue_frame( filename, v->pixels, width, height, color_list,
+						options.n_colors+options.n_extra_colors );
+#endif
+				n_done++;
+
+				timing_frame_done( var->name, place );
+				if( options.debug )
+					printf( "worker %d: frame %ld -> %s\n", worker, place+1, filename );
+				}
+			}
+		seq++;
+		}
+
+	if( (stream != NULL) && (fflush( stream ) != 0)) {
+		fprintf( stderr, "ncview: -render: error writing to the stream\n" );
+		return( -1 );
+		}
+
+#ifdef HAVE_PNG
+	/* Wait for the last frames to be written */
+	if( stream == NULL ) {
+		n_unwritten = png_queue_finish();
+		n_failed += n_unwritten;
+		n_done   -= n_unwritten;
+		}
+#endif
+
+	printf( "render worker %d: wrote %d frames", worker, n_done );
+	if( n_failed > 0 )
+		printf( ", %d failed", n_failed );
+	printf( "\n" );
+
+	return( n_failed );
+}
+
+/*============================================================================*/
+/* Writes len bytes to f, preceded by the length if f is the pipe back
+ * to the main process.  Returns 0 on success, -1 on a write error.
+ */
+	static int
+render_send( FILE *f, int to_pipe, void *buf, size_t len )
+{
+	if( to_pipe && (fwrite( &len, sizeof(size_t), 1, f ) != 1))
+		return( -1 );
+	if( (len > 0) && (fwrite( buf, 1, len, f ) != len))
+		return( -1 );
+	return( 0 );
+}
+
+/*============================================================================*/
+/* In the main process, copies the messages from the workers' pipes to
+ * the stream in frame order: first the header from worker 0, then the
+ * frames round-robin.  The first worker to run out marks the end.
+ * Returns 0 on success, -1 if the stream can't be written.
+ */
+	static int
+render_relay( FILE **pipes, int n_pipes, FILE *stream )
+{
+	long	seq;
+	size_t	len, buf_size;
+	char	*buf;
+	FILE	*f;
+
+	buf      = NULL;
+	buf_size = 0L;
+	for( seq=-1; ; seq++ ) {
+		f = (seq < 0) ? pipes[0] : pipes[seq % n_pipes];	/* seq -1 is the header */
+		if( fread( &len, sizeof(size_t), 1, f ) != 1 )
+			break;
+		if( len > buf_size ) {
+			if( buf != NULL )
+				free( buf );
+			buf = (char *)malloc( len );
+			if( buf == NULL ) {
+				fprintf( stderr, "ncview: render_relay: failed to allocate %ld bytes\n", (long)len );
+				exit( -1 );
+				}
+			buf_size = len;
+			}
+		if( fread( buf, 1, len, f ) != len )
+			break;
+		if( (len > 0) && (fwrite( buf, 1, len, stream ) != len)) {
+			fprintf( stderr, "ncview: -render: error writing to the stream\n" );
+			if( buf != NULL )
+				free( buf );
+			return( -1 );
+			}
+		}
+
+	if( buf != NULL )
+		free( buf );
+	return( 0 );
+}
+
+/*============================================================================*/
+/* Returns the color list of the named colormap (or the first one if name
+ * is NULL), or NULL if there is no such colormap.
+ */
+	static XColor *
+render_find_colormap( char *name, char **found_name )
+{
+	int	i, n, enabled;
+	char	*cmap_name;
+	XColor	*color_list;
+
+	n = x_n_colormaps( colormap_list );
+	for( i=0; i<n; i++ ) {
+		x_colormap_info( colormap_list, i, &cmap_name, &enabled, &color_list );
+		if( (name == NULL) || (strcmp( name, cmap_name ) == 0)) {
+			*found_name = cmap_name;
+			return( color_list );
+			}
+		}
+
+	return( NULL );
+}
+
+#ifdef HAVE_PNG
+/*============================================================================*/
+/* Writes an image of colormap indices as a palette PNG.  Returns 0 on
+ * success, -1 on failure.
+ */
+	int
+write_png_file( char *filename, unsigned char *data, size_t width, size_t height,
+		XColor *color_list, int n_palette )
+{
+	png_color	palette[256];
+
+	if( n_palette > 256 )
+		n_palette = 256;
+	png_set_palette( palette, color_list, n_palette );
+
+	return( png_encode( filename, data, width, height, palette, n_palette ));
+}
+
+/*============================================================================*/
+	static void
+png_set_palette( png_color *palette, XColor *color_list, int n_palette )
+{
+	int	i;
+
+	for( i=0; i<n_palette; i++ ) {
+		palette[i].red   = ((color_list+i)->red   >> 8);
+		palette[i].green = ((color_list+i)->green >> 8);
+		palette[i].blue  = ((color_list+i)->blue  >> 8);
+		}
+}
+
+/*============================================================================*/
+/* Writes the PNG file, with the compression level and filters asked for
+ * with -png_level and -png_filter.  This is called from the encoder
+ * threads, so it can't touch anything shared.
+ */
+	static int
+png_encode( char *filename, unsigned char *data, size_t width, size_t height,
+		png_color *palette, int n_palette )
+{
+	FILE		*out_file;
+	png_structp	png_ptr;
+	png_infop	info_ptr;
+	size_t		j;
+	unsigned char	**row_pointers;
+
+	/* Open binary output file */
+	if( (out_file = fopen( filename, "wb" )) == NULL ) {
+		fprintf( stderr, "ncview: can't open PNG file %s for writing\n", filename );
+		return( -1 );
+		}
+
+	/* Set up PNG information structures */
+	png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, (png_voidp)NULL, NULL, NULL );	/* use default error handlers */
+	if( ! png_ptr ) {
+		fprintf( stderr, "Error returned when trying to allocate PNG write structure\n" );
+		fclose( out_file );
+		return( -1 );
+		}
+
+	info_ptr = png_create_info_struct( png_ptr );
+	if( ! info_ptr ) {
+		fprintf( stderr, "Error returned when trying to allocate PNG info structure\n" );
+		png_destroy_write_struct( &png_ptr, (png_infopp)NULL );
+		fclose( out_file );
+		return( -1 );
+		}
+
+	/* Make our row pointers */
+	row_pointers = (unsigned char **)malloc( sizeof( unsigned char * ) * height );
+	if( row_pointers == NULL ) {
+		fprintf( stderr, "Failed to allocate row pointers; returning without writing output file\n" );
+		png_destroy_write_struct( &png_ptr, &info_ptr );
+		fclose( out_file );
+		return( -1 );
+		}
+	for( j=0; j<height; j++ )
+		row_pointers[j] = data + j*width;
+
+	/* Set up longjump target (PNG will use this for an error) */
+	if( setjmp( png_jmpbuf(png_ptr))) {
+		fprintf( stderr, "Error returned when trying to write PNG file %s, aborting operation\n", filename );
+		png_destroy_write_struct( &png_ptr, &info_ptr );
+		free( row_pointers );
+		fclose( out_file );
+		return( -1 );
+		}
+
+	/* Set up PNG I/O ops */
+	png_init_io( png_ptr, out_file );
+
+	/* Describe our image for PNG */
+	png_set_IHDR( png_ptr, info_ptr, width, height, 8,
+		PNG_COLOR_TYPE_PALETTE,		/* ncview operates with palettes almost exclusively */
+		PNG_INTERLACE_NONE,
+		PNG_COMPRESSION_TYPE_DEFAULT,
+		PNG_FILTER_TYPE_DEFAULT );
+
+	/* Level 1 is several times faster than the default, and the files
+	 * are not much bigger for the smooth fields we usually have
+	 */
+	if( options.png_level >= 0 )
+		png_set_compression_level( png_ptr, options.png_level );
+	if( options.png_filter >= 0 )
+		png_set_filter( png_ptr, PNG_FILTER_TYPE_BASE, options.png_filter );
+
+	png_set_PLTE( png_ptr, info_ptr, palette, n_palette );
+
+	/* Associate row pointers with the PNG structures, and write */
+	png_set_rows( png_ptr, info_ptr, row_pointers );
+	png_write_png( png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL );
+
+	png_destroy_write_struct( &png_ptr, &info_ptr );
+	free( row_pointers );
+	fclose( out_file );
+
+	return( 0 );
+}
+/*============================================================================*/
+/* Hands a frame to the PNG encoder threads to be written to filename.
+ * The data and colors are copied, so the caller can reuse them right
+ * away.  Returns -1 if writing any frame so far has failed, 0 otherwise.
+ * With no thread support, or only one processor, the frame is just
+ * written before returning.
+ */
+	int
+png_queue_frame( char *filename, unsigned char *data, size_t width, size_t height,
+		XColor *color_list, int n_palette )
+{
+	PNGJob	*job;
+	int	err;
+
+	if( n_palette > 256 )
+		n_palette = 256;
+
+#ifdef HAVE_PTHREAD
+	if( png_n_threads == 0 )
+		png_start_threads();
+
+	if( png_n_threads > 1 ) {
+		job = (PNGJob *)malloc( sizeof(PNGJob) );
+		if( job == NULL ) {
+			fprintf( stderr, "ncview: png_queue_frame: failed to allocate PNG job\n" );
+			exit( -1 );
+			}
+		job->filename = (char *)malloc( strlen(filename)+1 );
+		job->data     = (unsigned char *)malloc( width*height );
+		if( (job->filename == NULL) || (job->data == NULL) ) {
+			fprintf( stderr, "ncview: png_queue_frame: failed to allocate %ld bytes for frame\n",
+				(long)(width*height) );
+			exit( -1 );
+			}
+		strcpy( job->filename, filename );
+		memcpy( job->data, data, width*height );
+		job->width     = width;
+		job->height    = height;
+		job->n_palette = n_palette;
+		png_set_palette( job->palette, color_list, n_palette );
+
+		pthread_mutex_lock( &png_lock );
+		while( png_queue_count == PNG_QUEUE_LEN )
+			pthread_cond_wait( &png_not_full, &png_lock );
+		png_queue[(png_queue_head + png_queue_count) % PNG_QUEUE_LEN] = job;
+		png_queue_count++;
+		err = (png_n_errors > 0) ? -1 : 0;
+		pthread_cond_signal( &png_not_empty );
+		pthread_mutex_unlock( &png_lock );
+
+		return( err );
+		}
+#endif
+
+	if( write_png_file( filename, data, width, height, color_list, n_palette ) != 0 )
+		png_n_errors++;
+	return( (png_n_errors > 0) ? -1 : 0 );
+}
+
+/*============================================================================*/
+/* Waits until all the queued frames have been written, and stops the
+ * encoder threads.  Returns the number of frames that could not be
+ * written since the last time this was called.
+ */
+	int
+png_queue_finish( void )
+{
+	int	n_errors;
+#ifdef HAVE_PTHREAD
+	int	i;
+
+	if( png_n_threads > 1 ) {
+		pthread_mutex_lock( &png_lock );
+		png_shutting_down = 1;
+		pthread_cond_broadcast( &png_not_empty );
+		pthread_mutex_unlock( &png_lock );
+
+		for( i=0; i<png_n_threads; i++ )
+			pthread_join( png_threads[i], NULL );
+		png_shutting_down = 0;
+		}
+#endif
+
+	n_errors      = png_n_errors;
+	png_n_errors  = 0;
+	png_n_threads = 0;
+	return( n_errors );
+}
+
+#ifdef HAVE_PTHREAD
+/*============================================================================*/
+/* Starts the encoder threads: as many as -threads says, or one per
+ * processor (shared out between the -render worker processes).  If we
+ * end up with only one, png_queue_frame writes the frames itself.
+ */
+	static void
+png_start_threads( void )
+{
+	long	n;
+	int	i;
+
+	n = options.n_threads;
+	if( n <= 0 ) {
+		n = sysconf( _SC_NPROCESSORS_ONLN );
+		if( options.render->doit && (options.render->n_procs > 1) )
+			n /= options.render->n_procs;
+		}
+	if( n > PNG_MAX_THREADS )
+		n = PNG_MAX_THREADS;
+	if( n <= 1 ) {
+		png_n_threads = 1;
+		return;
+		}
+
+	for( i=0; i<n; i++ ) {
+		if( pthread_create( &(png_threads[i]), NULL, png_encoder_thread, NULL ) != 0 )
+			break;
+		}
+	png_n_threads = i;
+
+	if( png_n_threads == 0 ) {
+		fprintf( stderr, "ncview: could not start PNG encoder threads; writing frames one at a time\n" );
+		png_n_threads = 1;
+		}
+	else if( options.debug )
+		printf( "started %d PNG encoder threads\n", png_n_threads );
+}
+
+/*============================================================================*/
+	static void *
+png_encoder_thread( void *arg )
+{
+	PNGJob	*job;
+	int	err;
+
+	for( ;; ) {
+		pthread_mutex_lock( &png_lock );
+		while( (png_queue_count == 0) && (! png_shutting_down) )
+			pthread_cond_wait( &png_not_empty, &png_lock );
+		if( png_queue_count == 0 ) {
+			pthread_mutex_unlock( &png_lock );
+			return( NULL );
+			}
+		job = png_queue[png_queue_head];
+		png_queue_head = (png_queue_head + 1) % PNG_QUEUE_LEN;
+		png_queue_count--;
+		pthread_cond_signal( &png_not_full );
+		pthread_mutex_unlock( &png_lock );
+
+		err = png_encode( job->filename, job->data, job->width, job->height,
+			job->palette, job->n_palette );
+
+		if( err != 0 ) {
+			pthread_mutex_lock( &png_lock );
+			png_n_errors++;
+			pthread_mutex_unlock( &png_lock );
+			}
+
+		free( job->filename );
+		free( job->data );
+		free( job );
+		}
+}
+#endif
+#endif
+
+/*============================================================================*/
+/* Returns the libpng filter flags for the name given to -png_filter, or
+ * -1 if it isn't one we know about.
+ */
+	int
+png_parse_filter( char *s )
+{
+#ifdef HAVE_PNG
+	if( strcmp( s, "none"  ) == 0 ) return( PNG_FILTER_NONE  );
+	if( strcmp( s, "sub"   ) == 0 ) return( PNG_FILTER_SUB   );
+	if( strcmp( s, "up"    ) == 0 ) return( PNG_FILTER_UP    );
+	if( strcmp( s, "avg"   ) == 0 ) return( PNG_FILTER_AVG   );
+	if( strcmp( s, "paeth" ) == 0 ) return( PNG_FILTER_PAETH );
+	if( strcmp( s, "all"   ) == 0 ) return( PNG_ALL_FILTERS  );
+#endif
+	return( -1 );
+}
@@ -0,0 +1,269 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Writing frames as an uncompressed video stream (-stream FILE), so they
+ * can be piped straight into a movie encoder instead of going through
+ * one PNG file per frame.  Two formats are supported: YUV4MPEG2 (which
+ * carries its own size and frame rate, and which ffmpeg, x264, etc. read
+ * directly) and headerless packed 24-bit RGB.  The frames are the
+ * colormap-index images from data_to_pixels, so they have the same
+ * colormap and blowup as on the screen.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+#include <signal.h>
+
+extern Options  options;
+
+/* Per-colormap-index output values, so converting a frame is a table
+ * lookup per pixel.  They are rebuilt for each frame, which costs next to
+ * nothing and keeps up with colormap changes and inversions.
+ */
+static unsigned char	tab_r[256], tab_g[256], tab_b[256];
+static unsigned char	tab_y[256], tab_u[256], tab_v[256];
+
+static unsigned char	*frame_buf     = NULL;
+static size_t		frame_buf_size = 0L;
+
+/* State for streaming frames from the interactive display */
+static FILE	*display_stream = NULL;
+static size_t	display_width, display_height;
+static int	display_error_state = 0;
+
+static void	stream_build_tables( XColor *color_list, int n_colors );
+
+/*============================================================================*/
+/* Returns STREAM_Y4M or STREAM_RGB for the given format name, or -1 if
+ * it isn't one we know about.
+ */
+	int
+stream_parse_format( char *s )
+{
+	if( (strcmp( s, "y4m" ) == 0) || (strcmp( s, "yuv4mpeg" ) == 0))
+		return( STREAM_Y4M );
+	if( strcmp( s, "rgb" ) == 0 )
+		return( STREAM_RGB );
+	return( -1 );
+}
+
+/*============================================================================*/
+/* Opens the stream to write frames to.  A name of "-" means standard
+ * output; in that case, anything else the program prints to stdout is
+ * sent to stderr from now on so it can't end up mixed in with the frames.
+ * A FIFO can be given as the name; the open then waits until the
+ * encoder on the other end has started reading.  Returns NULL on error.
+ */
+	FILE *
+stream_open( char *name )
+{
+	FILE	*f;
+	int	fd;
+
+	/* If the reader goes away, get an error from the write rather than
+	 * being killed
+	 */
+	signal( SIGPIPE, SIG_IGN );
+
+	if( strcmp( name, "-" ) == 0 ) {
+		fflush( stdout );
+		if( (fd = dup( fileno(stdout) )) < 0 ) {
+			fprintf( stderr, "ncview: can't duplicate standard output for the frame stream\n" );
+			return( NULL );
+			}
+		dup2( fileno(stderr), fileno(stdout) );
+		f = fdopen( fd, "wb" );
+		}
+	else
+		f = fopen( name, "wb" );
+
+	if( f == NULL )
+		fprintf( stderr, "ncview: can't open \"%s\" to write the frame stream to\n", name );
+
+	return( f );
+}
+
+/*============================================================================*/
+/* Puts the stream header for frames of the given size into buf, and
+ * returns its length (which is 0 for formats with no header).
+ */
+	int
+stream_header( char *buf, int len, int format, size_t width, size_t height, int fps )
+{
+	if( format != STREAM_Y4M )
+		return( 0 );
+
+	/* 4:4:4 so that no chroma is lost and odd sizes are fine */
+	snprintf( buf, len, "YUV4MPEG2 W%ld H%ld F%d:1 Ip A1:1 C444\n",
+		(long)width, (long)height, fps );
+	return( strlen( buf ));
+}
+
+/*============================================================================*/
+/* Converts an image of colormap indices into one frame of the stream,
+ * including any per-frame header.  Returns a pointer to the frame
+ * (which is only good until the next call) and its length in *nbytes.
+ */
+	unsigned char *
+stream_convert( unsigned char *pixels, size_t width, size_t height,
+		XColor *color_list, int n_colors, int format, size_t *nbytes )
+{
+	size_t		i, n, size;
+	unsigned char	*p, *py, *pu, *pv;
+	static char	frame_hdr[] = "FRAME\n";
+
+	stream_build_tables( color_list, n_colors );
+
+	n = width*height;
+	if( format == STREAM_Y4M )
+		size = strlen(frame_hdr) + 3*n;
+	else
+		size = 3*n;
+
+	if( size > frame_buf_size ) {
+		if( frame_buf != NULL )
+			free( frame_buf );
+		frame_buf = (unsigned char *)malloc( size );
+		if( frame_buf == NULL ) {
+			fprintf( stderr, "ncview: stream_convert: failed to allocate %ld bytes for frame\n", (long)size );
+			exit( -1 );
+			}
+		frame_buf_size = size;
+		}
+
+	if( format == STREAM_Y4M ) {
+		memcpy( frame_buf, frame_hdr, strlen(frame_hdr) );
+		py = frame_buf + strlen(frame_hdr);
+		pu = py + n;
+		pv = pu + n;
+		for( i=0; i<n; i++ ) {
+			*(py++) = tab_y[*pixels];
+			*(pu++) = tab_u[*pixels];
+			*(pv++) = tab_v[*pixels];
+			pixels++;
+			}
+		}
+	else
+		{
+		p = frame_buf;
+		for( i=0; i<n; i++ ) {
+			*(p++) = tab_r[*pixels];
+			*(p++) = tab_g[*pixels];
+			*(p++) = tab_b[*pixels];
+			pixels++;
+			}
+		}
+
+	*nbytes = size;
+	return( frame_buf );
+}
+
+/*============================================================================*/
+	static void
+stream_build_tables( XColor *color_list, int n_colors )
+{
+	int	i, r, g, b;
+
+	if( n_colors > 256 )
+		n_colors = 256;
+
+	for( i=0; i<256; i++ ) {
+		if( i < n_colors ) {
+			r = (color_list+i)->red   >> 8;
+			g = (color_list+i)->green >> 8;
+			b = (color_list+i)->blue  >> 8;
+			}
+		else
+			r = g = b = 0;
+
+		tab_r[i] = r;
+		tab_g[i] = g;
+		tab_b[i] = b;
+
+		/* ITU-R BT.601, studio range, which is what Y4M readers assume */
+		tab_y[i] = (unsigned char)( 16 + (( 66*r + 129*g +  25*b + 128) >> 8));
+		tab_u[i] = (unsigned char)(128 + ((-38*r -  74*g + 112*b + 128) >> 8));
+		tab_v[i] = (unsigned char)(128 + ((112*r -  94*g -  18*b + 128) >> 8));
+		}
+}
+
+/*============================================================================*/
+/* Called with each frame drawn on the display when -stream is on.  The
+ * stream is opened, and the header written, on the first frame.  Since
+ * a video stream has one fixed size, we stop streaming if the size of
+ * the image changes.
+ */
+	void
+stream_display_frame( unsigned char *pixels, size_t width, size_t height,
+		XColor *color_list, int n_colors )
+{
+	char		hdr[256];
+	int		hdr_len;
+	unsigned char	*frame;
+	size_t		nbytes;
+
+	if( display_error_state )
+		return;
+
+	if( display_stream == NULL ) {
+		if( (display_stream = stream_open( options.stream_file )) == NULL ) {
+			display_error_state = 1;
+			return;
+			}
+		display_width  = width;
+		display_height = height;
+		hdr_len = stream_header( hdr, 256, options.stream_format, width, height, options.stream_fps );
+		fwrite( hdr, 1, hdr_len, display_stream );
+		}
+
+	if( (width != display_width) || (height != display_height)) {
+		fprintf( stderr, "ncview: image size changed from %ldx%ld to %ldx%ld; stopping the frame stream\n",
+			(long)display_width, (long)display_height, (long)width, (long)height );
+		fclose( display_stream );
+		display_stream = NULL;
+		display_error_state = 1;
+		return;
+		}
+
+	frame = stream_convert( pixels, width, height, color_list, n_colors, options.stream_format, &nbytes );
+	if( fwrite( frame, 1, nbytes, display_stream ) != nbytes ) {
+		fprintf( stderr, "ncview: error writing to the frame stream; stopping it\n" );
+		fclose( display_stream );
+		display_stream = NULL;
+		display_error_state = 1;
+		return;
+		}
+	fflush( display_stream );
+}
+
+/*============================================================================*/
+/* Called on exit, to make sure the end of the display's stream gets out */
+	void
+stream_finish( void )
+{
+	if( display_stream != NULL ) {
+		fclose( display_stream );
+		display_stream = NULL;
+		}
+}
@@ -0,0 +1,250 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Drawing big blown-up images a tile at a time.  With a large blowup the
+ * image can be many times bigger than the scrolled window it is shown in,
+ * so rather than expanding and colorizing the whole thing for each frame,
+ * we only make the square tiles (options.viewport_tile_size pixels on a
+ * side) that can be seen.  Scrolling brings an expose event, which draws
+ * whatever tiles have come into view.  Recently made tiles are kept, up
+ * to TILE_CACHE_MB megabytes, so scrolling back and forth and stepping
+ * back to a recent frame don't have to make them again.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+#define TILE_CACHE_MB	64
+
+extern Options  options;
+
+typedef struct {
+	int		valid;
+	size_t		frameno, tx, ty;	/* which frame, and which tile across and down */
+	size_t		width, height;		/* tiles on the right and bottom edges can be smaller */
+	ncv_pixel	*pixels;
+	unsigned long	last_used;
+} ViewTile;
+
+static ViewTile		*tile_cache = NULL;
+static int		tile_cache_n = 0;
+static unsigned long	tile_use_count = 0L;
+
+static ViewTile	*tile_find( size_t frameno, size_t tx, size_t ty );
+static ViewTile	*tile_make( View *v, size_t frameno, size_t tx, size_t ty, size_t width, size_t height );
+
+/*============================================================================*/
+/* Returns TRUE if the current view should be drawn a tile at a time.  This
+ * is only worth it when the blown-up image is a good deal bigger than the
+ * window it is seen through.  Frames written to PNG files or to a stream
+ * always have to be made whole.
+ */
+	int
+view_tiles_active( View *v )
+{
+	size_t	x_size, y_size, scaled_x_size, scaled_y_size, vx, vy, vw, vh;
+
+	if( (options.viewport_tile_size <= 0) || (options.blowup <= 1) ||
+	    options.dump_frames || (options.stream_file != NULL) || options.render->doit )
+		return( FALSE );
+
+	x_size = *(v->variable->size + v->x_axis_id);
+	y_size = *(v->variable->size + v->y_axis_id);
+	view_get_scaled_size( options.blowup, x_size, y_size, &scaled_x_size, &scaled_y_size );
+
+	in_get_visible_area( &vx, &vy, &vw, &vh );
+
+	return( scaled_x_size*scaled_y_size > 2*vw*vh );
+}
+
+/*============================================================================*/
+/* Forgets all the tiles made so far.  Called whenever what a frame looks
+ * like changes, the same as the pixmap ring.
+ */
+	void
+view_tiles_invalidate( void )
+{
+	int	i;
+
+	for( i=0; i<tile_cache_n; i++ )
+		tile_cache[i].valid = FALSE;
+}
+
+/*============================================================================*/
+/* Forgets the tiles made for just one frame */
+	void
+view_tiles_forget( size_t frameno )
+{
+	int	i;
+
+	for( i=0; i<tile_cache_n; i++ )
+		if( tile_cache[i].frameno == frameno )
+			tile_cache[i].valid = FALSE;
+}
+
+/*============================================================================*/
+/* What data_to_pixels does to the data before making the image, without
+ * making it.  Returns -1 if the variable can't be shown, 0 otherwise.
+ */
+	int
+view_tiles_prepare( View *v )
+{
+	int	err;
+
+	if( ! v->variable->have_set_range )
+		return( -1 );
+
+	/* If the range had to be changed, tiles already made are wrong */
+	while( (err = data_check_range( v )) > 0 )
+		view_tiles_invalidate();
+
+	return( err );
+}
+
+/*============================================================================*/
+/* Draws the tiles of frame 'frameno' that can be seen in the window.  The
+ * blown-up frame is width by height pixels.  The view's data must already
+ * be read in and its range checked.
+ */
+	void
+view_tiles_draw( View *v, size_t frameno, size_t width, size_t height )
+{
+	size_t	ts, vx, vy, vw, vh, tx, ty, tx0, tx1, ty0, ty1, tw, th;
+	int	n_made, n_cached;
+	ViewTile *tile;
+
+	ts = options.viewport_tile_size;
+
+	in_get_visible_area( &vx, &vy, &vw, &vh );
+	if( (vx >= width) || (vy >= height) || (vw == 0) || (vh == 0))
+		return;
+	if( vx+vw > width )
+		vw = width - vx;
+	if( vy+vh > height )
+		vh = height - vy;
+
+	tx0 = vx/ts;
+	tx1 = (vx+vw-1)/ts;
+	ty0 = vy/ts;
+	ty1 = (vy+vh-1)/ts;
+
+	n_made = 0;
+	n_cached = 0;
+	for( ty=ty0; ty<=ty1; ty++ )
+	for( tx=tx0; tx<=tx1; tx++ ) {
+		if( (tile = tile_find( frameno, tx, ty )) != NULL )
+			n_cached++;
+		else
+			{
+			tw = ((tx+1)*ts > width)  ? width  - tx*ts : ts;
+			th = ((ty+1)*ts > height) ? height - ty*ts : ts;
+			tile = tile_make( v, frameno, tx, ty, tw, th );
+			n_made++;
+			}
+		in_draw_2d_tile( tile->pixels, tx*ts, ty*ts, tile->width, tile->height );
+		}
+
+	if( options.debug )
+		printf( "view_tiles_draw: frame %ld, tiles %ld-%ld x %ld-%ld: made %d, had %d\n",
+			(long)frameno, (long)tx0, (long)tx1, (long)ty0, (long)ty1, n_made, n_cached );
+}
+
+/*============================================================================*/
+/* Returns the cached tile, or NULL if we don't have it */
+	static ViewTile *
+tile_find( size_t frameno, size_t tx, size_t ty )
+{
+	int	i;
+
+	for( i=0; i<tile_cache_n; i++ ) {
+		if( tile_cache[i].valid && (tile_cache[i].frameno == frameno) &&
+		    (tile_cache[i].tx == tx) && (tile_cache[i].ty == ty)) {
+			tile_cache[i].last_used = ++tile_use_count;
+			return( tile_cache + i );
+			}
+		}
+	return( NULL );
+}
+
+/*============================================================================*/
+/* Makes a tile and puts it in the cache, in place of the one used least
+ * recently.  The cache is set up the first time through.
+ */
+	static ViewTile *
+tile_make( View *v, size_t frameno, size_t tx, size_t ty, size_t width, size_t height )
+{
+	int	i, oldest;
+	size_t	ts;
+	ViewTile *tile;
+
+	ts = options.viewport_tile_size;
+
+	if( tile_cache == NULL ) {
+		tile_cache_n = (int)((size_t)TILE_CACHE_MB*1024L*1024L / (ts*ts*sizeof(ncv_pixel)));
+		if( tile_cache_n < 1 )
+			tile_cache_n = 1;
+		tile_cache = (ViewTile *)malloc( tile_cache_n * sizeof( ViewTile ));
+		if( tile_cache == NULL ) {
+			fprintf( stderr, "ncview: tile_make: failed to allocate %d tile cache entries\n", tile_cache_n );
+			exit( -1 );
+			}
+		for( i=0; i<tile_cache_n; i++ ) {
+			tile_cache[i].valid  = FALSE;
+			tile_cache[i].pixels = NULL;
+			tile_cache[i].last_used = 0L;
+			}
+		if( options.debug )
+			printf( "tile_make: cache holds %d tiles of %ldx%ld pixels\n", tile_cache_n, (long)ts, (long)ts );
+		}
+
+	oldest = 0;
+	for( i=0; i<tile_cache_n; i++ ) {
+		if( ! tile_cache[i].valid ) {
+			oldest = i;
+			break;
+			}
+		if( tile_cache[i].last_used < tile_cache[oldest].last_used )
+			oldest = i;
+		}
+	tile = tile_cache + oldest;
+
+	if( tile->pixels == NULL ) {
+		tile->pixels = (ncv_pixel *)malloc( ts*ts*sizeof(ncv_pixel) );
+		if( tile->pixels == NULL ) {
+			fprintf( stderr, "ncview: tile_make: failed to allocate %ld byte tile\n", (long)(ts*ts) );
+			exit( -1 );
+			}
+		}
+
+	data_to_pixels_rect( v, tx*ts, ty*ts, width, height, tile->pixels );
+
+	tile->valid     = TRUE;
+	tile->frameno   = frameno;
+	tile->tx        = tx;
+	tile->ty        = ty;
+	tile->width     = width;
+	tile->height    = height;
+	tile->last_used = ++tile_use_count;
+
+	return( tile );
+}
@@ -0,0 +1,387 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Keeps track of how long each stage of drawing a frame takes, so we can
+ * tell where the time goes when playback is slow.  The stages are given
+ * by the TIMING_ defines in ncview.defines.h.  Times accumulate for the
+ * frame being drawn until timing_frame_done() is called, and then go into
+ * a rolling window of the last TIMING_WINDOW frames for each stage, from
+ * which averages and percentiles are reported.  If the user asked for it
+ * with -timings FILE, each frame's times are also written to FILE as CSV.
+ *
+ * Also here is the session trace (-trace FILE), which records when things 
+ * like reading the files, calculating the data ranges, and making overlays
+ * started and stopped, along with the frame stages above, in the Chrome
+ * trace event JSON format.  That can be loaded into chrome://tracing or
+ * Perfetto (ui.perfetto.dev) to see the whole session on one timeline.
+ * The trace calls are made through the TRACE_BEGIN and TRACE_END macros,
+ * which go away if ncview is compiled with -DNO_TRACE.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+extern Options  options;
+
+#define TIMING_WINDOW	128	/* number of recent frames the statistics cover */
+
+/* Must match the order of the TIMING_ defines */
+static char *timing_stage_names[] = { "read", "expand", "colorize", "truecolor", "xfer", "total" };
+
+static double	cur_msec[N_TIMING_STAGES];	/* accumulated for the frame being drawn */
+static int	cur_used[N_TIMING_STAGES];
+
+static double	window[N_TIMING_STAGES][TIMING_WINDOW];
+static int	window_n[N_TIMING_STAGES], window_next[N_TIMING_STAGES];
+
+static long	n_frames = 0L;
+static double	t_first_frame;
+static FILE	*csv_file = NULL;
+
+static FILE	*trace_file = NULL;
+static double	trace_t0;
+static int	trace_pid;
+
+static int 	timing_compare( const void *a, const void *b );
+static void 	timing_stats( int stage, double *avg, double *p50, double *p95, double *max );
+static void 	trace_event( char *name, char *cat, char ph, double ts, double dur, char *detail );
+static void 	trace_json_string( char *s );
+
+/*============================================================================*/
+/* Called once at startup, after the options have been read */
+	void
+timing_init( void )
+{
+	int	i;
+
+	for( i=0; i<N_TIMING_STAGES; i++ ) {
+		cur_msec[i]    = 0.0;
+		cur_used[i]    = FALSE;
+		window_n[i]    = 0;
+		window_next[i] = 0;
+		}
+
+	if( options.timings_file == NULL )
+		return;
+
+	if( (csv_file = fopen( options.timings_file, "w" )) == NULL ) {
+		fprintf( stderr, "ncview: can't open file \"%s\" to write timings to\n",
+			options.timings_file );
+		exit( -1 );
+		}
+
+	fprintf( csv_file, "frame,elapsed_ms,variable,scan_place" );
+	for( i=0; i<N_TIMING_STAGES; i++ )
+		fprintf( csv_file, ",%s_ms", timing_stage_names[i] );
+	fprintf( csv_file, "\n" );
+}
+
+/*============================================================================*/
+/* Adds the time since 't_start' (from util_time_msec) to the given stage
+ * of the frame being drawn.
+ */
+	void
+timing_add( int stage, double t_start )
+{
+	double	now;
+
+	now = util_time_msec();
+	cur_msec[stage] += now - t_start;
+	cur_used[stage]  = TRUE;
+
+#ifndef NO_TRACE
+	if( trace_file != NULL )
+		trace_event( timing_stage_names[stage], "frame", 'X', t_start, now - t_start, NULL );
+#endif
+}
+
+/*============================================================================*/
+/* Called when a frame has been drawn (or rendered ahead).  The stages that
+ * ran for this frame are added to the statistics; those that did not,
+ * for example reading when the frame came from the framestore, are left
+ * out so they don't pull the averages down.
+ */
+	void
+timing_frame_done( char *var_name, long scan_place )
+{
+	int	i;
+	double	now;
+
+	now = util_time_msec();
+	if( n_frames == 0L )
+		t_first_frame = now;
+
+	for( i=0; i<N_TIMING_STAGES; i++ ) {
+		if( ! cur_used[i] )
+			continue;
+		window[i][window_next[i]] = cur_msec[i];
+		window_next[i] = (window_next[i] + 1) % TIMING_WINDOW;
+		if( window_n[i] < TIMING_WINDOW )
+			window_n[i]++;
+		}
+
+	if( options.debug ) {
+		fprintf( stderr, "timing: frame %ld:", scan_place );
+		for( i=0; i<N_TIMING_STAGES; i++ )
+			if( cur_used[i] )
+				fprintf( stderr, " %s=%.2f", timing_stage_names[i], cur_msec[i] );
+		fprintf( stderr, " ms\n" );
+		}
+
+	if( csv_file != NULL ) {
+		fprintf( csv_file, "%ld,%.3f,%s,%ld", n_frames, now - t_first_frame,
+			(var_name == NULL) ? "" : var_name, scan_place );
+		for( i=0; i<N_TIMING_STAGES; i++ )
+			fprintf( csv_file, ",%.3f", cur_msec[i] );
+		fprintf( csv_file, "\n" );
+		}
+
+	for( i=0; i<N_TIMING_STAGES; i++ ) {
+		cur_msec[i] = 0.0;
+		cur_used[i] = FALSE;
+		}
+	n_frames++;
+}
+
+/*============================================================================*/
+/* Forgets any times accumulated for a frame that was not finished */
+	void
+timing_frame_abort( void )
+{
+	int	i;
+
+	for( i=0; i<N_TIMING_STAGES; i++ ) {
+		cur_msec[i] = 0.0;
+		cur_used[i] = FALSE;
+		}
+}
+
+/*============================================================================*/
+	static int
+timing_compare( const void *a, const void *b )
+{
+	double	da, db;
+
+	da = *((double *)a);
+	db = *((double *)b);
+	if( da < db )
+		return( -1 );
+	if( da > db )
+		return( 1 );
+	return( 0 );
+}
+
+/*============================================================================*/
+	static void
+timing_stats( int stage, double *avg, double *p50, double *p95, double *max )
+{
+	double	sorted[TIMING_WINDOW], sum;
+	int	i, n;
+
+	n = window_n[stage];
+	sum = 0.0;
+	for( i=0; i<n; i++ ) {
+		sorted[i] = window[stage][i];
+		sum += sorted[i];
+		}
+	qsort( sorted, n, sizeof(double), timing_compare );
+
+	*avg = sum/(double)n;
+	*p50 = sorted[ (n-1)/2 ];
+	*p95 = sorted[ (int)(0.95*(double)(n-1) + 0.5) ];
+	*max = sorted[ n-1 ];
+}
+
+/*============================================================================*/
+/* Puts a multi-line table of the timing statistics into 's'.  */
+	void
+timing_report( char *s, size_t len )
+{
+	int	i;
+	double	avg, p50, p95, max;
+	char	line[200];
+
+	snprintf( s, len, "Frame timings (ms, last %d frames):\n%-10s %6s %8s %8s %8s %8s\n",
+		TIMING_WINDOW, "stage", "n", "avg", "p50", "p95", "max" );
+	for( i=0; i<N_TIMING_STAGES; i++ ) {
+		if( window_n[i] == 0 )
+			continue;
+		timing_stats( i, &avg, &p50, &p95, &max );
+		snprintf( line, 199, "%-10s %6d %8.2f %8.2f %8.2f %8.2f\n",
+			timing_stage_names[i], window_n[i], avg, p50, p95, max );
+		safe_strcat( s, len, line );
+		}
+}
+
+/*============================================================================*/
+/* Puts a one-line summary of the average stage times into 's', suitable
+ * for a label.
+ */
+	void
+timing_summary( char *s, size_t len )
+{
+	int	i;
+	double	avg, p50, p95, max;
+	char	item[100];
+
+	s[0] = '\0';
+	for( i=0; i<N_TIMING_STAGES; i++ ) {
+		if( window_n[i] == 0 )
+			continue;
+		timing_stats( i, &avg, &p50, &p95, &max );
+		if( i == TIMING_TOTAL )
+			snprintf( item, 99, "total %.1f (p95 %.1f)", avg, p95 );
+		else
+			snprintf( item, 99, "%s %.1f ", timing_stage_names[i], avg );
+		safe_strcat( s, len, item );
+		}
+}
+
+/*============================================================================*/
+/* Called on exit; flushes the CSV file and prints the statistics */
+	void
+timing_finish( void )
+{
+	char	report[2000];
+
+	trace_finish();
+
+	if( csv_file != NULL ) {
+		fclose( csv_file );
+		csv_file = NULL;
+		}
+
+	if( (options.debug || (options.timings_file != NULL)) && (n_frames > 0L) ) {
+		timing_report( report, 2000 );
+		fprintf( stderr, "%s", report );
+		}
+}
+
+/*============================================================================*/
+/* Called in a forked worker process, so that it doesn't write into the
+ * parent's timing or trace files.
+ */
+	void
+timing_detach( void )
+{
+	csv_file   = NULL;
+	trace_file = NULL;
+}
+
+/*============================================================================*/
+/* Starts the session trace.  Called as early as possible, so that the 
+ * trace covers reading in the files.
+ */
+	void
+trace_init( void )
+{
+	if( options.trace_file == NULL )
+		return;
+
+	if( (trace_file = fopen( options.trace_file, "w" )) == NULL ) {
+		fprintf( stderr, "ncview: can't open file \"%s\" to write the trace to\n",
+			options.trace_file );
+		exit( -1 );
+		}
+
+	trace_t0  = util_time_msec();
+	trace_pid = (int)getpid();
+
+	/* The closing ']' is optional in this format, so the trace
+	 * is still readable if we exit without calling trace_finish
+	 */
+	fprintf( trace_file, "[\n" );
+	fprintf( trace_file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":1,\"args\":{\"name\":\"ncview\"}}",
+		trace_pid );
+}
+
+/*============================================================================*/
+/* Marks the start of something that takes a while.  'detail' can be NULL,
+ * or something like a file or variable name to show with the event.
+ * Calls must be nested properly with trace_end.
+ */
+	void
+trace_begin( char *name, char *detail )
+{
+	if( trace_file == NULL )
+		return;
+	trace_event( name, "ncview", 'B', util_time_msec(), 0.0, detail );
+}
+
+/*============================================================================*/
+	void
+trace_end( char *name )
+{
+	if( trace_file == NULL )
+		return;
+	trace_event( name, "ncview", 'E', util_time_msec(), 0.0, NULL );
+}
+
+/*============================================================================*/
+	void
+trace_finish( void )
+{
+	if( trace_file == NULL )
+		return;
+
+	fprintf( trace_file, "\n]\n" );
+	fclose( trace_file );
+	trace_file = NULL;
+}
+
+/*============================================================================*/
+/* Writes one event.  Times are passed in msec from util_time_msec, but 
+ * the format wants microseconds.
+ */
+	static void
+trace_event( char *name, char *cat, char ph, double ts, double dur, char *detail )
+{
+	fprintf( trace_file, ",\n{\"name\":" );
+	trace_json_string( name );
+	fprintf( trace_file, ",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":%d,\"tid\":1,\"ts\":%.1f",
+		cat, ph, trace_pid, (ts - trace_t0)*1000.0 );
+	if( ph == 'X' )
+		fprintf( trace_file, ",\"dur\":%.1f", dur*1000.0 );
+	if( detail != NULL ) {
+		fprintf( trace_file, ",\"args\":{\"detail\":" );
+		trace_json_string( detail );
+		fprintf( trace_file, "}" );
+		}
+	fprintf( trace_file, "}" );
+}
+
+/*============================================================================*/
+	static void
+trace_json_string( char *s )
+{
+	fputc( '"', trace_file );
+	for( ; *s != '\0'; s++ ) {
+		if( (*s == '"') || (*s == '\\') )
+			fprintf( trace_file, "\\%c", *s );
+		else if( (unsigned char)*s < 0x20 )
+			fprintf( trace_file, "\\u%04x", (unsigned char)*s );
+		else
+			fputc( *s, trace_file );
+		}
+	fputc( '"', trace_file );
+}
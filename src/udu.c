@@ -272,6 +272,42 @@ void udu_fmt_time( char *temp_string, size_t temp_string_len, double new_dimval,
 		}
 }
 
+/******************************************************************************/
+/* Reads a date, either like 2000-01-31 12:00:00 (or 2000-01-31T12:00:00) or
+ * like 31-Jan-2000 12:00:00, which is how udu_fmt_time writes them, and puts
+ * it in 'val' in the units of dim.  The time of day can be left off, or given
+ * only to the hour or minute.  Returns 0 on success.
+ */
+int udu_parse_time( char *s, NCDim *dim, double *val )
+{
+	int	n, year, month, day, hour, minute;
+	double	second;
+	char	mon[4];
+	static	char months[12][4] = { "Jan\0", "Feb\0", "Mar\0", "Apr\0",
+				       "May\0", "Jun\0", "Jul\0", "Aug\0",
+				       "Sep\0", "Oct\0", "Nov\0", "Dec\0"};
+
+	if( ! valid_udunits_pkg )
+		return( -1 );
+
+	hour   = 0;
+	minute = 0;
+	second = 0.0;
+	n = sscanf( s, " %d-%d-%d%*[ T]%d:%d:%lf", &year, &month, &day, &hour, &minute, &second );
+	if( n < 3 ) {
+		n = sscanf( s, " %d-%3[A-Za-z]-%d %d:%d:%lf", &day, mon, &year, &hour, &minute, &second );
+		if( n < 3 )
+			return( -1 );
+		for( month=1; month<=12; month++ )
+			if( strncmp_nocase( mon, months[month-1], 3 ) == 0 )
+				break;
+		}
+	if( (month < 1) || (month > 12) || (day < 1) || (day > 31) )
+		return( -1 );
+
+	return( utInvCalendar2_cal( year, month, day, hour, minute, second, dim->units, val, dim->calendar ));
+}
+
 /******************************************************************************/
 	static int 
 is_unique( char *units )
@@ -326,4 +362,9 @@ void udu_fmt_time( char *temp_string, size_t temp_string_len, double new_dimval,
 	snprintf( temp_string, temp_string_len-1, "%g", new_dimval );
 }
 
+int udu_parse_time( char *s, NCDim *dim, double *val )
+{
+	return( -1 );
+}
+
 #endif
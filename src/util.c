@@ -55,14 +55,32 @@ static float util_mode( float *x, size_t n, float fill_value );
 static void contract_data( float *small_data, View *v, float fill_value );
 static int equivalent_FDBs( NCVar *v1, NCVar *v2 );
 static int data_has_mv( float *data, size_t n, float fill_value );
+static void colorize_data( View *v, float *src, size_t src_stride, size_t nx, size_t ny, int flip, ncv_pixel *pixels );
 static void handle_dim_mapping( NCVar *v );
 static void handle_dim_mapping_scalar( NCVar *v, char *coord_var_name, char *coord_att );
 static void handle_dim_mapping_2d( NCVar *v, char *coord_var_name, char *coord_att, 
 	size_t *coord_var_eff_size, int coord_var_neff_dims, char *orig_coord_att,
 	int ncid );
 static int  determine_lat_lon( char *s_in, int *is_lat, int *is_lon );
+static void fdb_fill_details( NCVar *var, FDBlist *fdb );
+static void fdb_append( NCVar *var, FDBlist *new_fdb );
+static NCFile *ncfile_get( int id, char *filename );
+static int  timestep_map_matches( NCTimestepMap *m, NCVar *v, unsigned long long hash, int n_files );
+static NCTimestepMap *timestep_map_new( NCVar *v, unsigned long long hash, int n_files );
+static void timestep_map_release( NCTimestepMap *m );
+static void cache_scalar_coord_values( NCVar *v );
+static void calc_dim_minmaxes_var( NCVar *v );
+static int  copy_info_from_identical_dims( NCVar *vdst, NCDim *ddst, size_t dim_len );
+static void dim_set_time_values( NCDim *d, double *vals, size_t n );
+static void dim_copy_time_values( NCDim *ddst, NCDim *dsrc );
+static void dim_map_abandon( NCVar *v );
+static NCCoordCache *coord_cache_get( int ncid, char *filename, char *coord_var_name, int ndims, size_t *size );
+static void coord_cache_release( NCCoordCache *cc );
 
 /* Variables local to routines in this file */
+static	NCCoordCache *coord_caches = NULL;	/* all the 2-D coordinate variables in use */
+static	NCFile	*ncfiles = NULL;		/* all the input files, most recent first */
+static	NCTimestepMap *ts_maps = NULL;		/* all the timestep maps in use */
 static  char    *month_name[12] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
 	"Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
 
@@ -130,30 +148,97 @@ new_variable( NCVar **el )
 {
 	(*el)       = (NCVar *)malloc( sizeof( NCVar ));
 	(*el)->next = NULL;
+	(*el)->ts_map       = NULL;
+	(*el)->fdb_by_index = NULL;
 }
 
 
 /******************************************************************************
- * Allocate space for a new FDBlist element
+ * Allocate space for a new FDBlist element, for a var in 'file'.  If aux_data
+ * is NULL, the element gets its own.
  */
 	void
-new_fdblist( FDBlist **el )
+new_fdblist( FDBlist **el, NCFile *file, void *aux_data )
 {
 	NetCDFOptions	*new_netcdf_options;
 
 	(*el)           = (FDBlist *)malloc( sizeof( FDBlist ));
+	if( (*el) == NULL ) {
+		fprintf( stderr, "ncview: new_fdblist: failed to allocate space for a file entry\n" );
+		exit( -1 );
+		}
 	(*el)->next     = NULL;
-	(*el)->filename     = (char *)malloc( MAX_FILE_NAME_LEN );
-	(*el)->recdim_units = (char *)malloc( MAX_RECDIM_UNITS_LEN );
+	(*el)->file     = file;
+	(*el)->id       = file->id;
+	(*el)->filename = file->filename;
+	(*el)->recdim_units = NULL;
 
 #ifdef HAVE_UDUNITS2
 	(*el)->ut_unit_ptr  = NULL;
+	(*el)->recdim_conv  = 0;
+#endif
+	(*el)->same_schema  = FALSE;
+	(*el)->var_size_shared = FALSE;
+
+	if( aux_data == NULL ) {
+		new_netcdf( &new_netcdf_options );
+		aux_data = new_netcdf_options;
+		}
+	(*el)->aux_data = aux_data;
+}
+
+/******************************************************************************
+ * Makes the shared record of what we know about an input file.  'id' is what
+ * fi_initialize returned for it, and 'rec_len' is the length of its record
+ * dimension.
+ */
+	NCFile *
+ncfile_add( char *filename, int id, size_t rec_len )
+{
+	NCFile	*file;
+
+	if( strlen(filename) > (MAX_FILE_NAME_LEN-1)) {
+		fprintf( stderr, "Error, input file name is too long; longest I can handle is %d\nError occurred on file %s\n",
+			MAX_FILE_NAME_LEN, filename );
+		exit(-1);
+		}
+
+	file = (NCFile *)malloc( sizeof( NCFile ));
+	if( file == NULL ) {
+		fprintf( stderr, "ncview: ncfile_add: failed to allocate space for file %s\n", filename );
+		exit( -1 );
+		}
+	file->filename = (char *)malloc( strlen(filename)+1 );
+	strcpy( file->filename, filename );
+	file->id                = id;
+	file->rec_len           = rec_len;
+	file->have_recdim_units = FALSE;
+	file->recdim_units      = NULL;
+#ifdef HAVE_UDUNITS2
+	file->ut_unit_ptr       = NULL;
 #endif
+	file->next = ncfiles;
+	ncfiles    = file;
+
+	return( file );
+}
+
+/******************************************************************************
+ * Returns the shared record of the file with this id and name.  Vars are
+ * added a file at a time, so it is nearly always the last one made.
+ */
+	static NCFile *
+ncfile_get( int id, char *filename )
+{
+	NCFile	*file;
 
-	strcpy( (*el)->filename, "UNINITIALIZED" );
+	for( file=ncfiles; file != NULL; file=file->next )
+		if( (file->id == id) && (strcmp( file->filename, filename ) == 0) )
+			return( file );
 
-	new_netcdf( &new_netcdf_options );
-	(*el)->aux_data = new_netcdf_options;
+	fprintf( stderr, "ncview: ncfile_get: internal error, file %s (id %d) was never added\n",
+		filename, id );
+	exit( -1 );
 }
 
 /******************************************************************************
@@ -201,15 +286,11 @@ data_has_mv( float *data, size_t n, float fill_value )
 	int
 data_to_pixels( View *v )
 {
-	long	i, j, j2;
 	size_t	x_size, y_size, new_x_size, new_y_size;
-	ncv_pixel pix_val;
-	float	data_range, rawdata, data, fill_value, *scaled_data;
-	long	blowup, result, orig_minmax_method;
-	char	error_message[1024];
-	double	pi;
-
-	pi = 3.1415926536;
+	float	fill_value, *scaled_data;
+	long	blowup;
+	int	err;
+	double	t_start;
 
 	/* Make sure the limits have been set on this variable.
 	 * They won't always be because an initial expose event can 
@@ -226,6 +307,12 @@ data_to_pixels( View *v )
 
 	view_get_scaled_size( options.blowup, x_size, y_size, &new_x_size, &new_y_size );
 
+	/* This can change the range, in which case we start over */
+	if( (err = data_check_range( v )) < 0 )
+		return( -1 );
+	else if( err > 0 )
+		return( data_to_pixels( v ));
+
 	scaled_data   = (float *)malloc( new_x_size*new_y_size*sizeof(float));
 	if( scaled_data == NULL ) {
 		fprintf( stderr, "ncview: data_to_pixels: can't allocate data expansion array\n" );
@@ -236,17 +323,9 @@ data_to_pixels( View *v )
 		exit( -1 );
 		}
 
-	/* If we are doing overlays, implement them */
-	if( options.overlay->doit && (options.overlay->overlay != NULL)) {
-		for( i=0; i<(x_size*y_size); i++ ) {
-			*((float *)v->data + i) = 
-			     (float)(1 - *(options.overlay->overlay+i)) * *((float *)v->data + i) +
-			     (float)(*(options.overlay->overlay+i)) * v->variable->fill_value;
-			}
-		}
-
 	fill_value = v->variable->fill_value;
 
+	t_start = util_time_msec();
 	if( blowup > 0 ) {
 		if( options.debug ) printf( "..expanding data, blowup=%ld\n", blowup );
 		expand_data( scaled_data, v, new_x_size*new_y_size );
@@ -256,8 +335,97 @@ data_to_pixels( View *v )
 		if( options.debug ) printf( "..contracting data, blowup=%ld\n", blowup );
 		contract_data( scaled_data, v, fill_value );
 		}
+	timing_add( TIMING_EXPAND, t_start );
 
-	data_range = v->variable->user_max - v->variable->user_min;
+	t_start = util_time_msec();
+	colorize_data( v, scaled_data, new_x_size, new_x_size, new_y_size, ! options.invert_physical, v->pixels );
+	overlay_draw( v, 0, 0, new_x_size, new_y_size, v->pixels );
+	timing_add( TIMING_COLORIZE, t_start );
+
+	free( scaled_data );
+	return( 0 );
+}
+
+/******************************************************************************
+ * Same as data_to_pixels, but only makes the part of the blown-up image
+ * that is width by height pixels with its upper left corner at (x0,y0),
+ * putting it in 'pixels'.  The data must already be in v->data and its
+ * range checked.  Only for options.blowup > 0.
+ */
+	void
+data_to_pixels_rect( View *v, size_t x0, size_t y0, size_t width, size_t height, ncv_pixel *pixels )
+{
+	size_t	nxl, nyl, nyb, il_lo, il_hi, jl_lo, jl_hi, wxl, wyl, by0, j;
+	long	blowup;
+	float	*little, *big, *src;
+	double	t_start;
+
+	blowup = options.blowup;
+	nxl    = *(v->variable->size + v->x_axis_id);
+	nyl    = *(v->variable->size + v->y_axis_id);
+	nyb    = nyl*blowup;
+
+	/* Rows on the screen run the other way from rows in the data,
+	 * unless the picture is inverted
+	 */
+	if( options.invert_physical )
+		by0 = y0;
+	else
+		by0 = nyb - y0 - height;
+
+	/* The piece of the little array that the rectangle comes from, plus
+	 * two points on each side so that the interpolation inside the
+	 * rectangle comes out just as it does for the whole field
+	 */
+	il_lo = x0/blowup;
+	il_lo = (il_lo > 2) ? il_lo-2 : 0;
+	il_hi = (x0+width-1)/blowup + 2;
+	il_hi = (il_hi > nxl-1) ? nxl-1 : il_hi;
+	jl_lo = by0/blowup;
+	jl_lo = (jl_lo > 2) ? jl_lo-2 : 0;
+	jl_hi = (by0+height-1)/blowup + 2;
+	jl_hi = (jl_hi > nyl-1) ? nyl-1 : jl_hi;
+	wxl   = il_hi - il_lo + 1;
+	wyl   = jl_hi - jl_lo + 1;
+
+	little = (float *)malloc( wxl*wyl*sizeof(float) );
+	big    = (float *)malloc( wxl*wyl*blowup*blowup*sizeof(float) );
+	if( (little == NULL) || (big == NULL) ) {
+		fprintf( stderr, "ncview: data_to_pixels_rect: can't allocate data expansion arrays\n" );
+		exit( -1 );
+		}
+	for( j=0; j<wyl; j++ )
+		memcpy( little + j*wxl, (float *)v->data + il_lo + (jl_lo+j)*nxl, wxl*sizeof(float) );
+
+	t_start = util_time_msec();
+	expand_data_array( big, little, wxl, wyl, v->variable->fill_value, wxl*wyl*blowup*blowup );
+	timing_add( TIMING_EXPAND, t_start );
+
+	t_start = util_time_msec();
+	src = big + (x0 - il_lo*blowup) + (by0 - jl_lo*blowup)*wxl*blowup;
+	colorize_data( v, src, wxl*blowup, width, height, ! options.invert_physical, pixels );
+	overlay_draw( v, x0, y0, width, height, pixels );
+	timing_add( TIMING_COLORIZE, t_start );
+
+	free( little );
+	free( big );
+}
+
+/******************************************************************************
+ * Deal with a data range of zero, which would make every pixel the same.
+ * Returns -1 if the variable can't be shown, 1 if the range was changed
+ * (in which case this should be called again), and 0 if the range is OK.
+ */
+	int
+data_check_range( View *v )
+{
+	size_t	data_nx, data_ny;
+	float	fill_value;
+	long	result, orig_minmax_method;
+	char	error_message[1024];
+
+	view_data_size( v, &data_nx, &data_ny );
+	fill_value = v->variable->fill_value;
 
 	if( (v->variable->user_max == 0) &&
 	    (v->variable->user_min == 0) &&
@@ -271,7 +439,7 @@ data_to_pixels( View *v )
 			v->variable->user_max = 1;
 			v->variable->user_min = -1;
 			v->variable->auto_set_no_range = 1;
-			return( data_to_pixels(v) );
+			return( 1 );
 			}
 	    	snprintf( error_message, 1022, "min and max both 0 for variable %s.\nI can check ALL the data instead of subsampling if that's OK,\nor just cancel viewing this variable.",
 	    				v->variable->name );
@@ -279,7 +447,9 @@ data_to_pixels( View *v )
 		if( result == MESSAGE_OK ) {
 			orig_minmax_method = options.min_max_method;
 			options.min_max_method = MIN_MAX_METHOD_EXHAUST;
+			TRACE_BEGIN( "init_min_max", v->variable->name );
 			init_min_max( v->variable );
+			TRACE_END( "init_min_max" );
 			options.min_max_method = orig_minmax_method;
 			if( (v->variable->user_max == 0) &&
 	    		    (v->variable->user_min == 0) ) {
@@ -289,14 +459,14 @@ data_to_pixels( View *v )
 				v->variable->user_max = 1;
 				v->variable->user_min = -1;
 				v->variable->auto_set_no_range = 1;
-				return( data_to_pixels(v) );
+				return( 1 );
 				}
 			else
-				return( data_to_pixels(v) );
+				return( 1 );
 			}
 		else
 			{
-			if( ! data_has_mv( v->data, x_size*y_size, fill_value ) )
+			if( ! data_has_mv( v->data, data_nx*data_ny, fill_value ) )
 				return( -1 );
 			v->variable->user_max = 1;
 			}
@@ -307,11 +477,11 @@ data_to_pixels( View *v )
 	    	snprintf( error_message, 1022, "min and max both %g for variable %s",
 	    		v->variable->user_min, v->variable->name );
 		x_error( error_message );
-		if( ! data_has_mv( v->data, x_size*y_size, fill_value ) ) {
+		if( ! data_has_mv( v->data, data_nx*data_ny, fill_value ) ) {
 			v->variable->user_max += 0.1 * v->variable->user_max;
 			v->variable->user_min -= 0.1 * v->variable->user_min;
 			v->variable->auto_set_no_range = 1;
-			return( data_to_pixels(v) );
+			return( 1 );
 			}
 		/* If we get here, data is all same, but have a missing value,
 		 * so let's go ahead and show it
@@ -324,15 +494,36 @@ data_to_pixels( View *v )
 			v->variable->user_max = 0;
 	    	}
 
-	for( j=0; j<new_y_size; j++ ) {
+	return( 0 );
+}
+
+/******************************************************************************
+ * Convert nx by ny of the scaled (expanded or contracted) data in src, whose
+ * rows are src_stride apart, to pixels.  If flip is TRUE, the first row of
+ * pixels comes from the last row of src.
+ */
+	static void
+colorize_data( View *v, float *src, size_t src_stride, size_t nx, size_t ny, int flip, ncv_pixel *pixels )
+{
+	long	i, j, j2;
+	ncv_pixel pix_val;
+	float	data_range, rawdata, data, fill_value;
+	double	pi;
 
-		if( options.invert_physical )
-			j2 = j;
+	pi = 3.1415926536;
+
+	fill_value = v->variable->fill_value;
+	data_range = v->variable->user_max - v->variable->user_min;
+
+	for( j=0; j<ny; j++ ) {
+
+		if( flip )
+			j2 = ny - j - 1;
 		else
-			j2 = new_y_size - j - 1;
+			j2 = j;
 
-		for( i=0; i<new_x_size; i++ ) {
-			rawdata =  *(scaled_data + i + j2*new_x_size);
+		for( i=0; i<nx; i++ ) {
+			rawdata =  *(src + i + j2*src_stride);
 			if( close_enough(rawdata, fill_value) || (rawdata == FILL_FLOAT))
 				pix_val = *pixel_transform;
 			else
@@ -362,12 +553,9 @@ data_to_pixels( View *v )
 				if( options.display_type == PseudoColor )
 					pix_val = *(pixel_transform+pix_val);
 				}
-			*(v->pixels + i + j*new_x_size) = pix_val;
+			*(pixels + i + j*nx) = pix_val;
 			}
 		}
-
-	free( scaled_data );
-	return( 0 );
 }
 
 /******************************************************************************
@@ -413,6 +601,116 @@ add_vars_to_list( Stringlist *var_list, int id, char *filename, int nfiles )
 		printf( "done adding vars for file %s\n", filename );
 }
 
+/******************************************************************************
+ * Like add_vars_to_list, but for a file whose schema fingerprint matched the
+ * first file's, and var_list is the first file's list of vars.  Everything
+ * but the length of the record dimension is the same as in the first file, so
+ * that is all we take from this file.  The vars share the first file's aux
+ * data, and the size of the previous file if it is the same.
+ */
+	void
+add_vars_to_list_same_schema( Stringlist *var_list, int id, char *filename )
+{
+	Stringlist *sl;
+	NCVar	*var;
+	NCFile	*file;
+	FDBlist	*new_fdb;
+	size_t	size[MAX_NC_DIMS];
+	int	i, same;
+
+	file = ncfile_get( id, filename );
+	if( options.debug )
+		printf( "add_vars_to_list_same_schema: file %s has the same schema as %s, record length %ld\n", 
+			filename, variables->first_file->filename, (long)file->rec_len );
+
+	for( sl=var_list; sl != NULL; sl=sl->next ) {
+		var = get_var( sl->string );
+		if( var == NULL ) {
+			fprintf( stderr, "ncview: add_vars_to_list_same_schema: internal inconsistency; var %s is not on the list\n",
+				sl->string );
+			exit( -1 );
+			}
+
+		new_fdblist( &new_fdb, file, var->first_file->aux_data );
+		new_fdb->same_schema = TRUE;
+
+		for( i=0; i<var->n_dims; i++ )
+			size[i] = var->first_file->var_size[i];
+		if( var->recdim_index >= 0 )
+			size[var->recdim_index] = file->rec_len;
+
+		same = TRUE;
+		for( i=0; i<var->n_dims; i++ )
+			if( size[i] != var->last_file->var_size[i] )
+				same = FALSE;
+		if( same ) {
+			new_fdb->var_size        = var->last_file->var_size;
+			new_fdb->var_size_shared = TRUE;
+			}
+		else
+			{
+			new_fdb->var_size = (size_t *)malloc( var->n_dims * sizeof(size_t) );
+			if( new_fdb->var_size == NULL ) {
+				fprintf( stderr, "ncview: add_vars_to_list_same_schema: failed to allocate var_size\n" );
+				exit( -1 );
+				}
+			for( i=0; i<var->n_dims; i++ )
+				new_fdb->var_size[i] = size[i];
+			}
+
+		fdb_append( var, new_fdb );
+		}
+}
+
+/******************************************************************************
+ * Gives fdb its own var_size, if it was sharing one, so it can be changed
+ */
+	void
+fdb_own_var_size( NCVar *var, FDBlist *fdb )
+{
+	size_t	*size;
+	int	i;
+
+	if( ! fdb->var_size_shared )
+		return;
+
+	size = (size_t *)malloc( var->n_dims * sizeof(size_t) );
+	if( size == NULL ) {
+		fprintf( stderr, "ncview: fdb_own_var_size: failed to allocate var_size\n" );
+		exit( -1 );
+		}
+	for( i=0; i<var->n_dims; i++ )
+		size[i] = fdb->var_size[i];
+	fdb->var_size        = size;
+	fdb->var_size_shared = FALSE;
+}
+
+/******************************************************************************
+ * Puts new_fdb at the end of the var's list of files, and accumulates the
+ * var's size.
+ */
+	static void
+fdb_append( NCVar *var, FDBlist *new_fdb )
+{
+	if( var->last_file == NULL ) {
+		fprintf( stderr, "ncview: add_var_to_list: internal ");
+		fprintf( stderr, "inconsistency; var has no last_file\n" );
+		exit( -1 );
+		}
+	var->last_file->next = new_fdb;
+	new_fdb->prev     = var->last_file;
+	new_fdb->index    = var->last_file->index + 1;	/* so index for this fdb is 1 more than index for prev one */
+	var->last_file    = new_fdb;
+	*(var->size)      += *(new_fdb->var_size);	/* this works b/c you can only concatenate across first (timelike) dim */
+	var->is_virtual   = TRUE;
+
+	/* If the var has already been looked at, the new file needs
+	 * what var_fill_details did for the others
+	 */
+	if( var->have_details )
+		fdb_fill_details( var, new_fdb );
+}
+
 /******************************************************************************
  * For the given variable name, fill out the variable and file structures,
  * and add them into the global variable list.
@@ -422,26 +720,11 @@ add_var_to_list( char *var_name, int file_id, char *filename, int nfiles )
 {
 	NCVar	*var, *new_var;
 	int	n_dims, i;
-	FDBlist	*new_fdb, *fdb;
+	FDBlist	*new_fdb;
 
 	/* make a new file description entry for this var/file combo */
-	new_fdblist( &new_fdb );
-	new_fdb->id       = file_id;
+	new_fdblist( &new_fdb, ncfile_get( file_id, filename ), NULL );
 	new_fdb->var_size = fi_var_size( file_id, var_name );
-	if( strlen(filename) > (MAX_FILE_NAME_LEN-1)) {
-		fprintf( stderr, "Error, input file name is too long; longest I can handle is %d\nError occurred on file %s\n",
-			MAX_FILE_NAME_LEN, filename );
-		exit(-1);
-		}
-	strcpy( new_fdb->filename, filename );
-
-	/* fill out auxiliary (data-file format dependent) information
-	 * for the new fdb.
-	 */
-	fi_fill_aux_data( file_id, var_name, new_fdb );
-#ifdef HAVE_UDUNITS2
-	new_fdb->ut_unit_ptr = ut_parse( unitsys, new_fdb->recdim_units, UT_ASCII ); /* Will be NULL if there was an error */
-#endif
 
 	/* Does this variable already have an entry on the global var list "variables"? */
 	var = get_var( var_name );
@@ -464,8 +747,8 @@ add_var_to_list( char *var_name, int file_id, char *filename, int nfiles )
 		new_var->auto_set_no_range = 0;
 		new_var->have_set_range    = FALSE;
 		new_var->size       = fi_var_size( file_id, var_name );
+		new_var->recdim_index = fi_var_recdim_index( file_id, var_name );
 		new_var->fill_value = DEFAULT_FILL_VALUE;
-		fi_fill_value( new_var, &(new_var->fill_value) );
 		new_fdb->prev       = NULL;
 		new_fdb->index      = 0;	/* Since this is the FIRST fdb for this var */
 
@@ -478,9 +761,14 @@ add_var_to_list( char *var_name, int file_id, char *filename, int nfiles )
 		for( i=0; i<MAX_SCALAR_COORDS; i++ )
 			new_var->scalar_dim_map_info[i] = NULL;
 		new_var->n_scalar_coords = 0;
-		handle_dim_mapping( new_var );	/* needs to be before fill_dim_structs cuz latter access fi_dim_info */
 
-		fill_dim_structs( new_var );
+		/* The rest is filled out by var_fill_details when the var is
+		 * first looked at; most vars never are
+		 */
+		new_var->dim          = NULL;
+		new_var->dim_map_info = NULL;
+		new_var->have_details = FALSE;
+
 		add_to_varlist  ( &variables, new_var );
 		new_var->is_virtual = FALSE;
 
@@ -489,83 +777,386 @@ add_var_to_list( char *var_name, int file_id, char *filename, int nfiles )
 		 * this variable appears, and accumulate the variable's size.
 		 */
 		{
-		/* Go to the end of the file list and add it there */
+		/* Add it to the end of the file list */
 		if( options.debug )
 			printf( "adding another file with variable %s in it\n",
 				var_name );
-		if( var->last_file == NULL ) {
-			fprintf( stderr, "ncview: add_var_to_list: internal ");
-			fprintf( stderr, "inconsistency; var has no last_file\n" );
-			exit( -1 );
+		fdb_append( var, new_fdb );
+		}
+}
+
+/******************************************************************************
+ * Fills out the auxiliary (data-file format dependent) information and
+ * record dimension units of the var in this file.
+ */
+	static void
+fdb_fill_details( NCVar *var, FDBlist *fdb )
+{
+	NCFile	*file;
+
+	/* A file with the same schema as the first differs from it only in
+	 * the record dimension, and shares the first file's aux data
+	 */
+	if( ! (fdb->same_schema && (fdb != var->first_file)) )
+		fi_fill_aux_data( fdb->id, var->name, fdb );
+
+	/* Vars in groups can have their own record dimension */
+	if( strchr( var->name, '/' ) != NULL ) {
+		fdb->recdim_units = fi_recdim_units( fdb->id, var->name );
+#ifdef HAVE_UDUNITS2
+		fdb->ut_unit_ptr = ut_parse( unitsys, fdb->recdim_units, UT_ASCII ); /* Will be NULL if there was an error */
+#endif
+		return;
+		}
+
+	/* Otherwise the units are those of the file, which are only looked
+	 * up and parsed once
+	 */
+	file = fdb->file;
+	if( ! file->have_recdim_units ) {
+		file->recdim_units = fi_recdim_units( file->id, NULL );
+#ifdef HAVE_UDUNITS2
+		file->ut_unit_ptr = ut_parse( unitsys, file->recdim_units, UT_ASCII ); /* Will be NULL if there was an error */
+#endif
+		file->have_recdim_units = TRUE;
+		}
+	fdb->recdim_units = file->recdim_units;
+#ifdef HAVE_UDUNITS2
+	fdb->ut_unit_ptr  = file->ut_unit_ptr;
+#endif
+}
+
+/******************************************************************************
+ * add_var_to_list only finds out what is needed to list a variable (its name,
+ * size, and the files it is in).  This fills out the rest: the fill value,
+ * scaling, and units in each file, the coordinate mapping, and the
+ * dimensions.  It is called when the var is first looked at, after all the
+ * files have been read in.  Doing it again does nothing.
+ */
+	void
+var_fill_details( NCVar *var )
+{
+	FDBlist	*fdb;
+
+	if( var->have_details )
+		return;
+
+	if( options.debug )
+		printf( "var_fill_details: filling out details of var %s\n", var->name );
+
+	for( fdb=var->first_file; fdb != NULL; fdb=fdb->next )
+		fdb_fill_details( var, fdb );
+
+	fi_fill_value( var, &(var->fill_value) );
+
+	handle_dim_mapping( var );	/* needs to be before fill_dim_structs cuz latter access fi_dim_info */
+	fill_dim_structs( var );
+	cache_scalar_coord_values( var );
+	calc_dim_minmaxes_var( var );
+
+	var->have_details = TRUE;
+}
+
+/******************************************************************************
+ * (Re)make the var's map of which file (FDBlist) EACH TIMESTEP of the
+ * variable lives in.  Vars whose files hold the same number of timesteps
+ * each share the same map.  Called once all the files are read in, and
+ * again whenever the files grow.
+ */
+	void
+fill_timestep_map( NCVar *v )
+{
+	FDBlist		*f;
+	NCTimestepMap	*m;
+	int		n_files;
+	unsigned long long h;
+
+	if( v->size[0] == 0 )	/* total number of timesteps across ALL files */
+		return;
+
+	n_files = v->last_file->index + 1;
+	v->fdb_by_index = (FDBlist **)realloc( v->fdb_by_index, n_files * sizeof(FDBlist *) );
+	if( v->fdb_by_index == NULL ) {
+		fprintf( stderr, "Error, failed to allocate space for %d FDBlist pointers!\n", n_files );
+		exit(-1);
+		}
+
+	h = UTIL_HASH_INIT;
+	for( f=v->first_file; f != NULL; f=f->next ) {
+		v->fdb_by_index[f->index] = f;
+		h = util_hash_bytes( h, &(f->file),   sizeof(NCFile *) );
+		h = util_hash_bytes( h, f->var_size, sizeof(size_t) );
+		}
+
+	for( m=ts_maps; m != NULL; m=m->next )
+		if( timestep_map_matches( m, v, h, n_files ))
+			break;
+	if( (m != NULL) && (m == v->ts_map) )
+		return;
+
+	if( m == NULL )
+		m = timestep_map_new( v, h, n_files );
+	else if( options.debug )
+		printf( "fill_timestep_map: var %s shares its timestep map with %d other vars\n", v->name, m->n_refs );
+	m->n_refs++;
+	timestep_map_release( v->ts_map );
+	v->ts_map = m;
+}
+
+/******************************************************************************
+ * Returns TRUE if the timestep map m is right for var v
+ */
+	static int
+timestep_map_matches( NCTimestepMap *m, NCVar *v, unsigned long long hash, int n_files )
+{
+	FDBlist	*f;
+
+	if( (m->hash != hash) || (m->n_files != n_files) || (m->n_ts != v->size[0]) )
+		return( FALSE );
+	for( f=v->first_file; f != NULL; f=f->next )
+		if( (m->files[f->index] != f->file) ||
+		    (m->file_start[f->index+1] - m->file_start[f->index] != f->var_size[0]) )
+			return( FALSE );
+	return( TRUE );
+}
+
+/******************************************************************************
+ * Makes a new timestep map for var v, with no users yet
+ */
+	static NCTimestepMap *
+timestep_map_new( NCVar *v, unsigned long long hash, int n_files )
+{
+	NCTimestepMap	*m;
+	FDBlist		*f;
+	size_t		n_ts, ii;
+
+	n_ts = v->size[0];
+	if( options.debug )
+		printf( "Constructing timestep map for var %s, which has %ld timesteps in %d files\n", 
+			v->name, n_ts, n_files );
+
+	m = (NCTimestepMap *)malloc( sizeof( NCTimestepMap ));
+	if( m != NULL ) {
+		m->files      = (NCFile **)malloc( n_files * sizeof(NCFile *) );
+		m->file_start = (size_t *)malloc( (n_files+1) * sizeof(size_t) );
+		m->ts_file    = (int *)malloc( n_ts * sizeof(int) );
+		}
+	if( (m == NULL) || (m->files == NULL) || (m->file_start == NULL) || (m->ts_file == NULL) ) {
+		fprintf( stderr, "Error, failed to allocate space for the timestep map of length %ld!\n",
+				n_ts );
+		exit(-1);
+		}
+	m->n_files = n_files;
+	m->n_ts    = n_ts;
+	m->hash    = hash;
+	m->n_refs  = 0;
+
+	m->file_start[0] = 0L;
+	for( f=v->first_file; f != NULL; f=f->next ) {
+		m->files[f->index] = f->file;
+		m->file_start[f->index+1] = m->file_start[f->index] + f->var_size[0];
+		if( m->file_start[f->index+1] > n_ts )
+			break;
+		for( ii=m->file_start[f->index]; ii<m->file_start[f->index+1]; ii++ )
+			m->ts_file[ii] = f->index;
+		}
+	if( (f != NULL) || (m->file_start[n_files] != n_ts) ) {
+		fprintf( stderr, "Internal error: in routine timestep_map_new, got a total length of the unlimited dim in var %s to be %ld, but the files hold a different number of entries\n",
+			v->name, n_ts );
+		exit(-1);
+		}
+
+	m->next = ts_maps;
+	ts_maps = m;
+
+	return( m );
+}
+
+/******************************************************************************
+ * Drops one user of timestep map m, and frees it if there are none left
+ */
+	static void
+timestep_map_release( NCTimestepMap *m )
+{
+	NCTimestepMap	**mp;
+
+	if( m == NULL )
+		return;
+	if( --(m->n_refs) > 0 )
+		return;
+
+	for( mp=&ts_maps; *mp != NULL; mp=&((*mp)->next) )
+		if( *mp == m ) {
+			*mp = m->next;
+			break;
 			}
-		fdb = var->first_file;
-		while( fdb->next != NULL )
-			fdb = fdb->next;
-		fdb->next         = new_fdb;
-		new_fdb->prev     = fdb;
-		new_fdb->index    = ((FDBlist *)(new_fdb->prev))->index + 1;	/* so index for this fdb is 1 more than index for prev one */
-		var->last_file    = new_fdb;
-		*(var->size)      += *(new_fdb->var_size);	/* this works b/c you can only concatenate across first (timelike) dim */
-		var->is_virtual   = TRUE;
+	free( m->files );
+	free( m->file_start );
+	free( m->ts_file );
+	free( m );
+}
+
+/******************************************************************************
+ * Returns the file (FDBlist) that timestep ts of the var lives in
+ */
+	FDBlist *
+timestep_fdb( NCVar *v, size_t ts )
+{
+	FDBlist	*f;
+	size_t	cur_end;
+
+	if( (v->ts_map != NULL) && (ts < v->ts_map->n_ts) )
+		return( v->fdb_by_index[ v->ts_map->ts_file[ts] ] );
+
+	/* Before the map is made */
+	f = v->first_file;
+	cur_end = f->var_size[0];
+	while( (ts >= cur_end) && (f->next != NULL) ) {
+		f = f->next;
+		cur_end += f->var_size[0];
 		}
+	return( f );
+}
+
+/******************************************************************************
+ * A new file has turned up that carries on from the last file that 'var'
+ * lives in (say, the next output file of a running model).  Every variable
+ * that lives in that same last file, and is in the new file with the same
+ * shape apart from the first (timelike) dimension, gets the new file added
+ * to the end of its list of files.  Returns how many timesteps this adds
+ * to 'var', which is 0 if the file could not be used.
+ */
+	size_t
+add_new_file_to_vars( NCVar *var, char *new_filename )
+{
+	char		last_filename[MAX_FILE_NAME_LEN];
+	int		id, i, nsc, isc, n_added, fits, nfiles;
+	size_t		old_nt, *new_size, zeros[MAX_NC_DIMS], ones[MAX_NC_DIMS], rec_len;
+	Stringlist	*var_list, *sl;
+	NCVar		*v;
+	NCDim_map_info	*dmi;
+	float		fval;
+
+	if( (strlen(new_filename) > (MAX_FILE_NAME_LEN-1)) || (! fi_confirm( new_filename )))
+		return( 0L );
+
+	strcpy( last_filename, var->last_file->filename );
+	old_nt = var->size[0];
+
+	id = netcdf_fi_initialize( new_filename );
+	var_list = fi_list_vars( id );
+	fi_schema_fingerprint( id, &rec_len );
+	ncfile_add( new_filename, id, rec_len );
+
+	for( isc=0; isc<MAX_NC_DIMS; isc++ ) {
+		zeros[isc] = 0L;
+		ones[isc]  = 1L;
+		}
+
+	n_added = 0;
+	v = variables;
+	while( v != NULL ) {
+		fits = (strcmp( v->last_file->filename, last_filename ) == 0);
+		if( fits ) {
+			fits = FALSE;
+			for( sl=var_list; sl != NULL; sl=sl->next )
+				if( strcmp( sl->string, v->name ) == 0 )
+					fits = TRUE;
+			}
+		if( fits && (fi_n_dims( id, v->name ) != v->n_dims))
+			fits = FALSE;
+		if( fits ) {
+			new_size = fi_var_size( id, v->name );
+			for( i=1; i<v->n_dims; i++ )
+				if( new_size[i] != v->size[i] )
+					fits = FALSE;
+			free( new_size );
+			}
+		if( ! fits ) {
+			v = v->next;
+			continue;
+			}
+
+		if( options.debug )
+			printf( "add_new_file_to_vars: adding file %s to var %s\n", new_filename, v->name );
+		nfiles = v->last_file->index + 2;	/* including the new one */
+		add_var_to_list( v->name, id, new_filename, nfiles );
+		fill_timestep_map( v );
+		n_added++;
+
+		/* Scalar coordinates are cached one value per file */
+		nsc = v->n_scalar_coords;
+		for( isc=0; isc<nsc; isc++ ) {
+			dmi = v->scalar_dim_map_info[isc];
+			dmi->data_cache = (float *)realloc( dmi->data_cache, sizeof(float) * (v->last_file->index + 1) );
+			if( dmi->data_cache == NULL ) {
+				fprintf( stderr, "Error, failed to allocate space for %d scalar coord vals\n", v->last_file->index + 1 );
+				exit(-1);
+				}
+			netcdf_fi_get_data( id, dmi->coord_var_name, zeros, ones, &fval, NULL );
+			dmi->data_cache[v->last_file->index] = fval;
+			if( fval != dmi->data_cache[0] )
+				dmi->scalar_all_same = 0;
+			}
+
+		v = v->next;
+		}
+
+	if( n_added == 0 ) {
+		if( options.debug )
+			printf( "add_new_file_to_vars: file %s does not carry on from %s, ignoring it\n", new_filename, last_filename );
+		fi_close( id );
+		}
+
+	return( var->size[0] - old_nt );
 }
 
 /******************************************************************************
- * Go through each variable, and if it has scalar coordinate information,
- * read that in from each file that the var lives in.
+ * Once all the files are read in, set up which file each timestep of each
+ * variable is in.  Also, for vars that have already been looked at, if they
+ * have scalar coordinate information, read that in from each file that the
+ * var lives in.
  */
 	void
 cache_scalar_coord_info( NCVar *vars )
 {
  	NCVar		*v;
-	FDBlist		*tfile;
-	int		nfiles, ifile, nsc, isc;
-	NCDim_map_info	*dmi;
-	float		fval;
-	size_t		zeros[MAX_NC_DIMS], ones[MAX_NC_DIMS], n_ts, ii, i_cursor, n_ts_this_file;
 
 	if( options.debug ) printf( "cache_scalar_coord_info: entering\n" );
 
-	/* Allocate space for the timestep_2_fdb array. This points
-	 * to the file (FDBlist) associated with EACH TIMESTEP of
-	 * the variable
+	/* Set up the timestep map. This says which file (FDBlist)
+	 * EACH TIMESTEP of the variable is in
 	 */
 	v = vars;
 	while( v != NULL ) {
-		n_ts = v->size[0];	/* total number of timesteps across ALL files */
-		if( n_ts > 0 ) {
-			if( options.debug )
-				printf( "Constructing timestep_2_fdb array for var %s, which has %ld timesteps\n", v->name, n_ts );
-			/* One FDBlist pointer for each timestep of the var */
-			v->timestep_2_fdb = (FDBlist **)malloc( sizeof( FDBlist *) * n_ts );
-			if( v->timestep_2_fdb == NULL ) {
-				fprintf( stderr, "Error, failed to allocate space for FDBlist pointer block of length %ld!\n",
-						n_ts );
-				exit(-1);
-				}
+		fill_timestep_map( v );
+		v = v->next;
+		}
 
-			tfile = v->first_file;
-			i_cursor = 0L;
-			while( tfile != NULL ) {
-				/* Set all FDBpointers for the timesteps in THIS file 
-				 * to point to this file
-				 */
-				n_ts_this_file = tfile->var_size[0];
-				if( options.debug )
-					printf( "%ld timesteps of var %s are in file %s\n", n_ts_this_file, v->name, tfile->filename ); 
-				for( ii=0; ii<n_ts_this_file; ii++ ) 
-					v->timestep_2_fdb[i_cursor++] = tfile;
-				tfile = tfile->next;
-				}
-			if( i_cursor != n_ts ) {
-				fprintf( stderr, "Internal error: in routine cache_scalar_coord_info, got a total length of the unlimited dim in var %s to be %ld, but when setting pointers to the files, there seemd to be only %ld entries\n",
-					v->name, n_ts, i_cursor );
-				exit(-1);
-				}
-			}
+	/* Vars that have already been looked at */
+	v = vars;
+	while( v != NULL ) {
+		if( v->have_details )
+			cache_scalar_coord_values( v );
 		v = v->next;
 		}
 
+	if( options.debug ) printf( "cache_scalar_coord_info: finished\n" );
+}
+
+/******************************************************************************
+ * If the var has scalar coordinate information, read that in from each
+ * file that the var lives in.
+ */
+	static void
+cache_scalar_coord_values( NCVar *v )
+{
+	FDBlist		*tfile;
+	int		nfiles, ifile, nsc, isc;
+	NCDim_map_info	*dmi;
+	float		fval;
+	size_t		zeros[MAX_NC_DIMS], ones[MAX_NC_DIMS];
+
 	/* These will be used as the start (zeros) and count (ones)
 	 * to get the scalar data
 	 */
@@ -574,66 +1165,65 @@ cache_scalar_coord_info( NCVar *vars )
 		ones[isc]  = 1L;
 		}
 
-	v = vars;
-	while( v != NULL ) {
-		nsc = v->n_scalar_coords;
-		if( nsc > 0 ) {
-			tfile = v->first_file;
-
-			/* How many files does this var live in? */
-			nfiles = 0;
-			while( tfile != NULL ) {
-				nfiles++;
-				tfile = tfile->next;
+	nsc = v->n_scalar_coords;
+	if( nsc > 0 ) {
+		tfile = v->first_file;
+
+		/* How many files does this var live in? */
+		nfiles = 0;
+		while( tfile != NULL ) {
+			nfiles++;
+			tfile = tfile->next;
+			}
+		if( options.debug )
+			printf( "Making cache for the %d SCALAR coordinates of variable %s, which lives in %d files\n", nsc, v->name, nfiles );
+
+		/* We hold the values of the scalar coords in the data_cache */
+		for( isc=0; isc<nsc; isc++ ) {	
+			dmi = v->scalar_dim_map_info[isc];
+			dmi->data_cache = (float *)malloc( sizeof(float) * nfiles ); /* one val per FILE (not timestep) */
+			if( dmi->data_cache == NULL ) {
+				fprintf( stderr, "Error, failed to allocate space for %d scalar coord vals\n", nfiles );
+				exit(-1);
 				}
-			if( options.debug )
-				printf( "Making cache for the %d SCALAR coordinates of variable %s, which lives in %d files\n", nsc, v->name, nfiles );
+			}
 
-			/* We hold the values of the scalar coords in the data_cache */
+		/* Go through each file and read in the vals of all the scalar coords */
+		tfile = v->first_file;
+		for( ifile=0; ifile<nfiles; ifile++ ) {
 			for( isc=0; isc<nsc; isc++ ) {	
 				dmi = v->scalar_dim_map_info[isc];
-				dmi->data_cache = (float *)malloc( sizeof(float) * nfiles ); /* one val per FILE (not timestep) */
-				if( dmi->data_cache == NULL ) {
-					fprintf( stderr, "Error, failed to allocate space for %d scalar coord vals\n", nfiles );
+				if( dmi == NULL ) {
+					fprintf( stderr, "Coding error, uninitialized pointer to a scalar dim info struct is being used\n" );
 					exit(-1);
 					}
+				/* Files from a manifest that haven't been opened yet are taken
+				 * to have the same scalar coords as the first file
+				 */
+				if( (ifile > 0) && (! fi_fdb_is_open( tfile )))
+					fval = dmi->data_cache[0];
+				else
+					netcdf_fi_get_data( fi_fdb_id( tfile ), dmi->coord_var_name, zeros, ones, &fval, NULL );
+				if( options.debug ) printf( "In file %d/%d, value of scalar coord \"%s\" is %f %s\n",
+					ifile, nfiles, dmi->coord_var_name, fval, dmi->coord_var_units );
+				dmi->data_cache[ifile] = fval;
 				}
+			tfile = tfile->next;
+			}
 
-			/* Go through each file and read in the vals of all the scalar coords */
-			tfile = v->first_file;
-			for( ifile=0; ifile<nfiles; ifile++ ) {
-				for( isc=0; isc<nsc; isc++ ) {	
-					dmi = v->scalar_dim_map_info[isc];
-					if( dmi == NULL ) {
-						fprintf( stderr, "Coding error, uninitialized pointer to a scalar dim info struct is being used\n" );
-						exit(-1);
-						}
-					netcdf_fi_get_data( tfile->id, dmi->coord_var_name, zeros, ones, &fval, NULL );
-					if( options.debug ) printf( "In file %d/%d, value of scalar coord \"%s\" is %f %s\n",
-						ifile, nfiles, dmi->coord_var_name, fval, dmi->coord_var_units );
-					dmi->data_cache[ifile] = fval;
-					}
-				tfile = tfile->next;
-				}
-
-			/* Now see if all the scalar values are the same */
-			for( isc=0; isc<nsc; isc++ ) {	
-				dmi = v->scalar_dim_map_info[isc];
-				dmi->scalar_all_same = 1;	
-				if( nfiles > 1 ) {
-					for( ifile=1; ifile<nfiles; ifile++ ) {
-						if( dmi->data_cache[ifile] != dmi->data_cache[0] ) 
-							dmi->scalar_all_same = 0;
-						}
+		/* Now see if all the scalar values are the same */
+		for( isc=0; isc<nsc; isc++ ) {	
+			dmi = v->scalar_dim_map_info[isc];
+			dmi->scalar_all_same = 1;	
+			if( nfiles > 1 ) {
+				for( ifile=1; ifile<nfiles; ifile++ ) {
+					if( dmi->data_cache[ifile] != dmi->data_cache[0] ) 
+						dmi->scalar_all_same = 0;
 					}
 				}
 			}
-
-		v = v->next;
 		}
-
-	if( options.debug ) printf( "cache_scalar_coord_info: finished\n" );
- }
+}
 
 /******************************************************************************
  * Calculate the min and max values for the passed variable.
@@ -902,10 +1492,10 @@ virt_to_actual_place( NCVar *var, size_t *virt_pl, size_t *act_pl, FDBlist **fil
 {
 	FDBlist	*f;
 	size_t	v_place, cur_start, cur_end;
-	int	i, n_dims;
+	int	i, k, n_dims;
 
 	f       = var->first_file;
-	n_dims  = fi_n_dims( f->id, var->name );
+	n_dims  = var->n_dims;
 	v_place = *(virt_pl);
 
 	if( v_place >= *(var->size) ) {
@@ -917,12 +1507,20 @@ virt_to_actual_place( NCVar *var, size_t *virt_pl, size_t *act_pl, FDBlist **fil
 		exit( -1 );
 		}
 
-	cur_start = 0L;
-	cur_end   = *(f->var_size) - 1L;
-	while( v_place > cur_end ) {
-		cur_start += *(f->var_size);
-		f          = f->next;
-		cur_end   += *(f->var_size);
+	if( (var->ts_map != NULL) && (v_place < var->ts_map->n_ts) ) {
+		k         = var->ts_map->ts_file[v_place];
+		f         = var->fdb_by_index[k];
+		cur_start = var->ts_map->file_start[k];
+		}
+	else
+		{
+		cur_start = 0L;
+		cur_end   = *(f->var_size) - 1L;
+		while( v_place > cur_end ) {
+			cur_start += *(f->var_size);
+			f          = f->next;
+			cur_end   += *(f->var_size);
+			}
 		}
 
 	*file = f;
@@ -1053,6 +1651,7 @@ handle_dim_mapping_scalar( NCVar *v, char *coord_var_name, char *coord_att )
 	strcpy( tmi->coord_var_name, coord_var_name );
 	tmi->coord_var_units = fi_var_units( v->first_file->id, coord_var_name );
 	tmi->scalar_all_same = 0;
+	tmi->coord_cache = NULL;
 
 	/* Add this new scalar dim to the array */
 	v->scalar_dim_map_info[v->n_scalar_coords] = tmi;
@@ -1078,7 +1677,6 @@ handle_dim_mapping_2d( NCVar *v, char *coord_var_name, char *coord_att, size_t *
 		int coord_var_neff_dims, char *orig_coord_att, int ncid )
 {
 	NCDim_map_info	*map_info;
-	size_t		totsize, start[MAX_NC_DIMS], count[MAX_NC_DIMS];
 	int		i, n_matches, err, is_lat, is_lon, idx_lat_dim, idx_lon_dim,
 			must_be_left_of, j;
 
@@ -1088,6 +1686,7 @@ handle_dim_mapping_2d( NCVar *v, char *coord_var_name, char *coord_att, size_t *
 		fprintf( stderr, "Error, could not allocate space for a dim mapping info structure\n" );
 		exit(-1);
 		}
+	map_info->coord_cache = NULL;
 
 	/* Copy over the coordinate attribute for posterity */
 	map_info->coord_att = (char *)malloc( sizeof(char)*(strlen(coord_att)+2));
@@ -1186,8 +1785,7 @@ handle_dim_mapping_2d( NCVar *v, char *coord_var_name, char *coord_att, size_t *
 			}
 		fprintf( stderr, "), which does not match dimensions in the variable being mapped!\n" );
 		fprintf( stderr, "Abandoning coordinate mapping for this variable\n-------------\n" );
-		for( i=0; i<v->n_dims; i++ )
-			(v->dim_map_info)[i] = (NCDim_map_info *)NULL;
+		dim_map_abandon( v );
 		return;
 		}
 	if( (n_matches<1) || (n_matches>2)) {
@@ -1196,8 +1794,7 @@ handle_dim_mapping_2d( NCVar *v, char *coord_var_name, char *coord_att, size_t *
 		fprintf( stderr, "Problem encountered on variable \"%s\"\n", v->name );
 		fprintf( stderr, "which has coordinates attribute \"%s\"\n", orig_coord_att );
 		fprintf( stderr, "Abandoning coordinate mapping for this variable\n" );
-		for( i=0; i<v->n_dims; i++ )
-			(v->dim_map_info)[i] = (NCDim_map_info *)NULL;
+		dim_map_abandon( v );
 		return;
 		}
 
@@ -1208,8 +1805,7 @@ handle_dim_mapping_2d( NCVar *v, char *coord_var_name, char *coord_att, size_t *
 	err = determine_lat_lon( map_info->coord_var_name, &is_lat, &is_lon );
 	if( err != 0 ) {
 		/* Abort this process */
-		for( i=0; i<v->n_dims; i++ )
-			(v->dim_map_info)[i] = (NCDim_map_info *)NULL;
+		dim_map_abandon( v );
 		return;
 		}
 	idx_lon_dim = -1;
@@ -1263,20 +1859,12 @@ handle_dim_mapping_2d( NCVar *v, char *coord_var_name, char *coord_att, size_t *
 		exit( -1 );
 		}
 
-	/* Read in data from var, store it in cache */
-	totsize = 1L;
-	for( i=0; i<map_info->coord_var_ndims; i++ ) {
-		totsize *= map_info->coord_var_size[i];
-		start[i] = 0L;
-		count[i] = map_info->coord_var_size[i];
-		}
-	map_info->data_cache = (float *)malloc( totsize*sizeof(float) );
-	if( map_info->data_cache == NULL ) {
-		fprintf( stderr, "Error, could not allocate cache for dim map variable %s; total size (bytes): %ld\n", 
-			map_info->coord_var_name, totsize*sizeof(float) );
-		exit(-1);
-		}
-	netcdf_fi_get_data( ncid, map_info->coord_var_name, start, count, map_info->data_cache, NULL );
+	/* The values of the coord var are shared with other vars it maps, and
+	 * only read in when first needed (see dim_map_data)
+	 */
+	map_info->data_cache  = NULL;
+	map_info->coord_cache = coord_cache_get( ncid, v->first_file->filename, map_info->coord_var_name,
+					map_info->coord_var_ndims, map_info->coord_var_size );
 
 	if( n_matches == 1 ) {
 		if( idx_lon_dim == -1 )
@@ -1306,6 +1894,138 @@ handle_dim_mapping_2d( NCVar *v, char *coord_var_name, char *coord_att, size_t *
 	*/
 }
 
+/******************************************************************************
+ * Drops all the 2-D coordinate mappings of the variable
+ */
+	static void
+dim_map_abandon( NCVar *v )
+{
+	int	i;
+
+	for( i=0; i<v->n_dims; i++ ) {
+		if( (v->dim_map_info[i] != NULL) && (v->dim_map_info[i]->coord_cache != NULL) )
+			coord_cache_release( v->dim_map_info[i]->coord_cache );
+		(v->dim_map_info)[i] = (NCDim_map_info *)NULL;
+		}
+}
+
+/******************************************************************************
+ * Returns the values of the 2-D coordinate variable of the mapping, reading
+ * them in if this is the first time they are needed by any variable.
+ */
+	float *
+dim_map_data( NCDim_map_info *dmi )
+{
+	NCCoordCache	*cc;
+	size_t		totsize, start[MAX_NC_DIMS], count[MAX_NC_DIMS];
+	int		i;
+
+	if( dmi->data_cache != NULL )
+		return( dmi->data_cache );
+
+	cc = dmi->coord_cache;
+	if( cc->data == NULL ) {
+		totsize = 1L;
+		for( i=0; i<cc->ndims; i++ ) {
+			totsize *= cc->size[i];
+			start[i] = 0L;
+			count[i] = cc->size[i];
+			}
+		cc->data = (float *)malloc( totsize*sizeof(float) );
+		if( cc->data == NULL ) {
+			fprintf( stderr, "Error, could not allocate cache for dim map variable %s; total size (bytes): %ld\n", 
+				cc->coord_var_name, totsize*sizeof(float) );
+			exit(-1);
+			}
+		netcdf_fi_get_data( cc->ncid, cc->coord_var_name, start, count, cc->data, NULL );
+		if( options.debug )
+			printf( "dim_map_data: read %ld values of %s from %s, shared by %d mappings\n",
+				(long)totsize, cc->coord_var_name, cc->filename, cc->n_refs );
+		}
+
+	dmi->data_cache = cc->data;
+	return( dmi->data_cache );
+}
+
+/******************************************************************************
+ * Returns the shared cache for the coordinate variable of the given name and
+ * shape in the file, making a new one if no other variable is using it yet.
+ */
+	static NCCoordCache *
+coord_cache_get( int ncid, char *filename, char *coord_var_name, int ndims, size_t *size )
+{
+	NCCoordCache	*cc;
+	int		i, same;
+
+	for( cc=coord_caches; cc != NULL; cc=cc->next ) {
+		if( (cc->ndims != ndims) || (strcmp( cc->coord_var_name, coord_var_name ) != 0) ||
+		    (strcmp( cc->filename, filename ) != 0) )
+			continue;
+		same = TRUE;
+		for( i=0; i<ndims; i++ )
+			if( cc->size[i] != size[i] )
+				same = FALSE;
+		if( same ) {
+			cc->n_refs++;
+			return( cc );
+			}
+		}
+
+	cc = (NCCoordCache *)malloc( sizeof(NCCoordCache) );
+	if( cc == NULL ) {
+		fprintf( stderr, "Error, could not allocate space for a coordinate variable cache\n" );
+		exit(-1);
+		}
+	cc->filename       = (char *)malloc( strlen(filename) + 1 );
+	cc->coord_var_name = (char *)malloc( strlen(coord_var_name) + 1 );
+	cc->size           = (size_t *)malloc( (ndims > 0 ? ndims : 1) * sizeof(size_t) );
+	if( (cc->filename == NULL) || (cc->coord_var_name == NULL) || (cc->size == NULL) ) {
+		fprintf( stderr, "Error, could not allocate space for a coordinate variable cache\n" );
+		exit(-1);
+		}
+	strcpy( cc->filename, filename );
+	strcpy( cc->coord_var_name, coord_var_name );
+	for( i=0; i<ndims; i++ )
+		cc->size[i] = size[i];
+	cc->ncid   = ncid;
+	cc->ndims  = ndims;
+	cc->data   = NULL;
+	cc->n_refs = 1;
+	cc->next   = coord_caches;
+	coord_caches = cc;
+
+	return( cc );
+}
+
+/******************************************************************************
+ * Done with the coordinate variable cache; frees it if nothing else is using it.
+ */
+	static void
+coord_cache_release( NCCoordCache *cc )
+{
+	NCCoordCache	*prev;
+
+	if( --(cc->n_refs) > 0 )
+		return;
+
+	if( coord_caches == cc )
+		coord_caches = cc->next;
+	else
+		{
+		for( prev=coord_caches; (prev != NULL) && (prev->next != cc); prev=prev->next )
+			;
+		if( prev != NULL )
+			prev->next = cc->next;
+		}
+
+	if( cc->data != NULL )
+		free( cc->data );
+	free( cc->filename );
+	free( cc->coord_var_name );
+	free( cc->size );
+	free( cc );
+}
+
 /******************************************************************************
  * Initialize all the fields in the dim structure by reading from the data file
  */
@@ -1333,6 +2053,11 @@ fill_dim_structs( NCVar *v )
 			d->name      	= dim_name;
 			d->long_name 	= fi_dim_longname( fileid, dim_name );
 			d->have_calc_minmax = 0;
+			d->time_values  = NULL;
+			d->n_time_values = 0L;
+			d->time_order   = 0;
+			d->has_bounds   = -1;
+			d->char_values  = FALSE;
 			d->units     	= fi_dim_units   ( fileid, dim_name );
 			d->units_change = 0;
 			d->size      	= *(v->size+i);
@@ -1360,15 +2085,17 @@ fill_dim_structs( NCVar *v )
 		d = *(v->dim+0);
 		if( d->timelike ) {
 			/* Go through each file and see if it has the same units
-			 * as the first file, which is stored in d->units 
+			 * as the first file, which is stored in d->units.  The
+			 * units of each file were already read by fdb_fill_details.
 			 */
 			cursor = v->first_file->next;
-			while( cursor != NULL ) {
-				tmp_units = fi_dim_units( cursor->id, d->name );
-				if( strcmp( d->units, tmp_units ) != 0 ) {
+			while( (cursor != NULL) && (! d->units_change) ) {
+				tmp_units = cursor->recdim_units;
+				if( (d->units != NULL) && (tmp_units != NULL) && (strcmp( d->units, tmp_units ) != 0) ) {
 					printf( "** Warning: different time units found in different files.  Trying to compensate...\n" );
 					d->units_change = 1;
 					}
+				cursor = cursor->next;
 				}
 			}
 		}
@@ -1506,7 +2233,7 @@ copy_info_to_identical_dims( NCVar *vsrc, NCDim *dsrc, size_t dim_len )
 
 	v = variables;
 	while( v != NULL ) {
-		for( i=0; i<v->n_dims; i++ ) {
+		for( i=0; (i<v->n_dims) && v->have_details; i++ ) {
 			d = *(v->dim+i);
 			if( (d != NULL) && (d->have_calc_minmax == 0)) {
 				/* See if this dim is same as passed dim */
@@ -1524,6 +2251,8 @@ copy_info_to_identical_dims( NCVar *vsrc, NCDim *dsrc, size_t dim_len )
 					d->values = (float *)malloc(dim_len*sizeof(float));
 					for( j=0L; j<dim_len; j++ )
 						*(d->values + j) = *(dsrc->values + j);
+					dim_copy_time_values( d, dsrc );
+					d->char_values = dsrc->char_values;
 					d->is_lat = dsrc->is_lat;
 					d->is_lon = dsrc->is_lon;
 					}
@@ -1533,6 +2262,42 @@ copy_info_to_identical_dims( NCVar *vsrc, NCDim *dsrc, size_t dim_len )
 		}
 }
 
+/******************************************************************************
+ * The other way around from copy_info_to_identical_dims: if a var that was
+ * looked at before has the same dim as ddst, copy the info from there.
+ * Returns TRUE if it did.
+ */
+	static int
+copy_info_from_identical_dims( NCVar *vdst, NCDim *ddst, size_t dim_len )
+{
+	NCVar	*v;
+	int	i;
+	NCDim	*d;
+
+	for( v=variables; v != NULL; v=v->next ) {
+		if( (v == vdst) || (! v->have_details) )
+			continue;
+		for( i=0; i<v->n_dims; i++ ) {
+			d = *(v->dim+i);
+			if( (d != NULL) && d->have_calc_minmax && (strcmp( ddst->name, d->name ) == 0) &&
+			    (*(v->size+i) == dim_len) && equivalent_FDBs( v, vdst )) {
+				ddst->min = d->min;
+				ddst->max = d->max;
+				ddst->have_calc_minmax = 1;
+				ddst->values = (float *)malloc(dim_len*sizeof(float));
+				memcpy( ddst->values, d->values, dim_len*sizeof(float) );
+				dim_copy_time_values( ddst, d );
+				ddst->char_values = d->char_values;
+				ddst->is_lat = d->is_lat;
+				ddst->is_lon = d->is_lon;
+				return( TRUE );
+				}
+			}
+		}
+
+	return( FALSE );
+}
+
 /******************************************************************************
  * Calculate the minimum and maximum values in the dimension structs.  While
  * we are messing with the dims, we also try to determine if they are lat and
@@ -1541,75 +2306,241 @@ copy_info_to_identical_dims( NCVar *vsrc, NCDim *dsrc, size_t dim_len )
 	void
 calc_dim_minmaxes( void )
 {
-	int	i, j;
 	NCVar	*v;
+
+	v = variables;
+	while( v != NULL ) {
+		if( v->have_details )
+			calc_dim_minmaxes_var( v );
+		v = v->next;
+		}
+}
+
+/******************************************************************************
+ * calc_dim_minmaxes for just the one var.
+ */
+	static void
+calc_dim_minmaxes_var( NCVar *v )
+{
+	int	i, j;
 	NCDim	*d;
 	char	temp_str[1024];
 	nc_type	type;
-	double	temp_double, bounds_max, bounds_min;
+	double	temp_double, bounds_max, bounds_min, *dvals;
 	int	has_bounds, name_lat, name_lon, units_lat, units_lon;
 	size_t	dim_len;
 	size_t	cursor_place[MAX_NC_DIMS];
 
-	v = variables;
-	while( v != NULL ) {
-		for( i=0; i<v->n_dims; i++ ) {
-			d = *(v->dim+i);
-			if( (d != NULL) && (d->have_calc_minmax == 0)) {
-				if( options.debug ) 
-					printf( "%s %d ...min & maxes for dim d->name=>%s< (d->global_id=%d)...\n", 
-						__FILE__, __LINE__, d->name, d->global_id );
-				dim_len = *(v->size+i);
-				d->values = (float *)malloc(dim_len*sizeof(float));
-
-				for( j=0; j<v->n_dims; j++ ) 
-					cursor_place[j] = (int)(*(v->size+j)/2.0);	/* take middle in case 2-d mapped dims apply */
-
-				type = fi_dim_value( v, i, 0L, &temp_double, temp_str, &has_bounds, &bounds_min, 
-								&bounds_max, cursor_place );	/* used to get type ONLY */
-				if( type == NC_DOUBLE ) {
-					for( j=0; j<dim_len; j++ ) {
-						cursor_place[i] = j;
-						type = fi_dim_value( v, i, j, &temp_double, temp_str, &has_bounds, &bounds_min, &bounds_max, cursor_place );
-						*(d->values+j) = (float)temp_double;
-						}
-					d->min  = *(d->values);
-					d->max  = *(d->values + dim_len - 1);
+	for( i=0; i<v->n_dims; i++ ) {
+		d = *(v->dim+i);
+		if( (d != NULL) && (d->have_calc_minmax == 0)) {
+			dim_len = *(v->size+i);
+
+			/* If another var that was looked at before has the same dim,
+			 * just copy it from there (see below)
+			 */
+			if( copy_info_from_identical_dims( v, d, dim_len ))
+				continue;
+
+			if( options.debug ) 
+				printf( "%s %d ...min & maxes for dim d->name=>%s< (d->global_id=%d)...\n", 
+					__FILE__, __LINE__, d->name, d->global_id );
+			d->values = (float *)malloc(dim_len*sizeof(float));
+
+			for( j=0; j<v->n_dims; j++ ) 
+				cursor_place[j] = (int)(*(v->size+j)/2.0);	/* take middle in case 2-d mapped dims apply */
+
+			type = fi_dim_value( v, i, 0L, &temp_double, temp_str, &has_bounds, &bounds_min, 
+							&bounds_max, cursor_place );	/* used to get type ONLY */
+			d->has_bounds = (has_bounds ? 1 : 0);
+			if( (type == NC_DOUBLE) && (v->dim_map_info[i] == NULL) ) {
+				/* Read them all at once, and keep them in full precision
+				 * for timelike dims
+				 */
+				dvals = (double *)malloc(dim_len*sizeof(double));
+				if( dvals == NULL ) {
+					fprintf( stderr, "ncview: calc_dim_minmaxes_var: failed to allocate space for %ld values of dim %s\n",
+						(long)dim_len, d->name );
+					exit( -1 );
 					}
+				fi_dim_values( v, i, dvals );
+				for( j=0; j<dim_len; j++ )
+					*(d->values+j) = (float)dvals[j];
+				if( d->timelike )
+					dim_set_time_values( d, dvals, dim_len );
 				else
-					{
-					if( options.debug ) 
-						printf( "**Note: non-float dim found; i=%d\n", i );
-					d->min  = 1.0;
-					d->max  = (float)dim_len;
-					for( j=0; j<dim_len; j++ )
-						*(d->values+j) = (float)j;
+					free( dvals );
+				d->min  = *(d->values);
+				d->max  = *(d->values + dim_len - 1);
+				}
+			else if( type == NC_DOUBLE ) {
+				for( j=0; j<dim_len; j++ ) {
+					cursor_place[i] = j;
+					type = fi_dim_value( v, i, j, &temp_double, temp_str, &has_bounds, &bounds_min, &bounds_max, cursor_place );
+					*(d->values+j) = (float)temp_double;
 					}
-				d->have_calc_minmax = 1;
-				
-				/* Try to see if the dim is a lat or lon.  Not an exact science by a long shot */
-				name_lat  = strncmp_nocase(d->name,  "lat",    3)==0;
-				units_lat = strncmp_nocase(d->units, "degree", 6) == 0;
-				name_lon  = strncmp_nocase(d->name,  "lon",    3)==0;
-				units_lon = strncmp_nocase(d->units, "degree", 6) == 0;
-				d->is_lat = ((name_lat || units_lat) && (d->max <  90.01) && (d->min > -90.01));
-				d->is_lon = ((name_lon || units_lon) && (d->max < 360.01) && (d->min > -180.01));
-
-				/* There is a funny thing we need to do at this point.  Think about the following case.
-				 * We want to look at 3 different files, and they all have a dim named 'lon' in them,
-				 * and each is different.  Because this might happen, we can't use the name as an
-				 * indication of a unique dimension.  On the other hand, it is very slow to repeatedly
-				 * reprocess the same dim over and over, especially if it's the time dim in a series
-				 * of virtually concatenated input files.  For that reason, we copy the min and max
-				 * values we just found to all identical dims.
-				 */
-				copy_info_to_identical_dims( v, d, dim_len );
+				d->min  = *(d->values);
+				d->max  = *(d->values + dim_len - 1);
+				}
+			else
+				{
+				if( options.debug ) 
+					printf( "**Note: non-float dim found; i=%d\n", i );
+				d->char_values = TRUE;
+				d->min  = 1.0;
+				d->max  = (float)dim_len;
+				for( j=0; j<dim_len; j++ )
+					*(d->values+j) = (float)j;
 				}
+			d->have_calc_minmax = 1;
+			
+			/* Try to see if the dim is a lat or lon.  Not an exact science by a long shot */
+			name_lat  = strncmp_nocase(d->name,  "lat",    3)==0;
+			units_lat = strncmp_nocase(d->units, "degree", 6) == 0;
+			name_lon  = strncmp_nocase(d->name,  "lon",    3)==0;
+			units_lon = strncmp_nocase(d->units, "degree", 6) == 0;
+			d->is_lat = ((name_lat || units_lat) && (d->max <  90.01) && (d->min > -90.01));
+			d->is_lon = ((name_lon || units_lon) && (d->max < 360.01) && (d->min > -180.01));
+
+			/* There is a funny thing we need to do at this point.  Think about the following case.
+			 * We want to look at 3 different files, and they all have a dim named 'lon' in them,
+			 * and each is different.  Because this might happen, we can't use the name as an
+			 * indication of a unique dimension.  On the other hand, it is very slow to repeatedly
+			 * reprocess the same dim over and over, especially if it's the time dim in a series
+			 * of virtually concatenated input files.  For that reason, we copy the min and max
+			 * values we just found to all identical dims.
+			 */
+			copy_info_to_identical_dims( v, d, dim_len );
 			}
-		v = v->next;
 		}
 }
-	
+
+/******************************************************************************
+ * Makes 'vals' (n of them) the time values of dim d, which takes them over
+ */
+	static void
+dim_set_time_values( NCDim *d, double *vals, size_t n )
+{
+	size_t	j;
+	int	up, down;
+
+	if( d->time_values != NULL )
+		free( d->time_values );
+	d->time_values   = vals;
+	d->n_time_values = n;
+
+	up   = TRUE;
+	down = TRUE;
+	for( j=1; j<n; j++ ) {
+		if( vals[j] <  vals[j-1] )
+			up = FALSE;
+		if( vals[j] >  vals[j-1] )
+			down = FALSE;
+		}
+	d->time_order = up ? 1 : (down ? -1 : 0);
+}
+
+/******************************************************************************/
+	static void
+dim_copy_time_values( NCDim *ddst, NCDim *dsrc )
+{
+	double	*vals;
+
+	if( dsrc->time_values == NULL )
+		return;
+	vals = (double *)malloc( dsrc->n_time_values*sizeof(double) );
+	if( vals == NULL ) {
+		fprintf( stderr, "ncview: dim_copy_time_values: failed to allocate space for %ld values of dim %s\n",
+			(long)dsrc->n_time_values, dsrc->name );
+		exit( -1 );
+		}
+	memcpy( vals, dsrc->time_values, dsrc->n_time_values*sizeof(double) );
+	if( ddst->time_values != NULL )
+		free( ddst->time_values );
+	ddst->time_values   = vals;
+	ddst->n_time_values = dsrc->n_time_values;
+	ddst->time_order    = dsrc->time_order;
+	ddst->has_bounds    = dsrc->has_bounds;
+}
+
+/******************************************************************************
+ * Makes sure the time values of timelike dim 'dimid' of var v are there for
+ * the whole of the dim, reading them again if the dim has grown since they
+ * were read (because more data turned up).  Returns FALSE if the dim has no
+ * time values to be had.
+ */
+	int
+dim_fill_time_values( NCVar *v, int dimid )
+{
+	NCDim	*d;
+	double	*vals;
+	size_t	n;
+
+	d = *(v->dim+dimid);
+	if( (d == NULL) || (! d->timelike) || (v->dim_map_info[dimid] != NULL) )
+		return( FALSE );
+
+	n = *(v->size+dimid);
+	if( (d->time_values != NULL) && (d->n_time_values == n) )
+		return( TRUE );
+
+	vals = (double *)malloc( n*sizeof(double) );
+	if( vals == NULL ) {
+		fprintf( stderr, "ncview: dim_fill_time_values: failed to allocate space for %ld values of dim %s\n",
+			(long)n, d->name );
+		exit( -1 );
+		}
+	if( fi_dim_values( v, dimid, vals ) != NC_DOUBLE ) {
+		free( vals );
+		return( FALSE );
+		}
+	dim_set_time_values( d, vals, n );
+	return( TRUE );
+}
+
+/******************************************************************************
+ * Returns the place along timelike dim d whose time value is nearest to 'val',
+ * which must be in the same units.  The time values must have been filled out
+ * (see dim_fill_time_values).  They nearly always go in order, so we can
+ * binary search; otherwise we have to look at them all.
+ */
+	size_t
+dim_nearest_time( NCDim *d, double val )
+{
+	double	*tv;
+	size_t	n, lo, hi, mid, j, best;
+
+	tv = d->time_values;
+	n  = d->n_time_values;
+	if( n == 0 )
+		return( 0L );
+
+	if( d->time_order == 0 ) {
+		best = 0L;
+		for( j=1; j<n; j++ )
+			if( fabs(tv[j] - val) < fabs(tv[best] - val) )
+				best = j;
+		return( best );
+		}
+
+	/* Find the first place that is at or past val */
+	lo = 0L;
+	hi = n;
+	while( lo < hi ) {
+		mid = lo + (hi-lo)/2;
+		if( (d->time_order > 0) ? (tv[mid] < val) : (tv[mid] > val) )
+			lo = mid+1;
+		else
+			hi = mid;
+		}
+
+	if( lo == n )
+		return( n-1 );
+	if( (lo > 0) && (fabs(tv[lo-1] - val) <= fabs(tv[lo] - val)) )
+		return( lo-1 );
+	return( lo );
+}
+
 /********************************************************************************
  * Actually do the "shrinking" of the FLOATING POINT (not pixel) data, converting 
  * it to the small version by either finding the most common value in the square,
@@ -1621,7 +2552,7 @@ calc_dim_minmaxes( void )
 contract_data( float *small_data, View *v, float fill_value )
 {
 	long 	i, j, n, nx, ny, ii, jj;
-	size_t	new_nx, new_ny, idx, ioffset, joffset;
+	size_t	new_nx, new_ny, idx, ioffset, joffset, data_nx, data_ny;
 	float 	*tmpv;
 
 	if( options.blowup > 0 ) {
@@ -1630,17 +2561,39 @@ contract_data( float *small_data, View *v, float fill_value )
 		}
 
 	n = -options.blowup;
-	tmpv = (float *)malloc( n*n * sizeof(float) );
-	if( tmpv == NULL ) {
-		fprintf( stderr, "internal error, failed to allocate array for calculating reduced means\n" );
-		exit( -1 );
-		}
 
 	/* Get old and new sizes (new size is smaller in this routine) */
 	nx   = *(v->variable->size + v->x_axis_id);
 	ny   = *(v->variable->size + v->y_axis_id);
 	view_get_scaled_size( options.blowup, nx, ny, &new_nx, &new_ny );
 
+	/* If only every n'th point was read, there is nothing left to do */
+	if( v->data_stride == n ) {
+		memcpy( small_data, v->data, new_nx*new_ny*sizeof(float) );
+		return;
+		}
+	if( (v->data_stride != 1) && ((n % v->data_stride) != 0) ) {
+		fprintf( stderr, "internal error, contract_data called with data reduced by %d, but shrinking by %ld\n",
+			v->data_stride, n );
+		exit(-1);
+		}
+
+	/* If we have means over blocks of data_stride points (from the
+	 * pyramid), shrink those the rest of the way
+	 */
+	if( v->data_stride != 1 ) {
+		n /= v->data_stride;
+		view_data_size( v, &data_nx, &data_ny );
+		nx = data_nx;
+		ny = data_ny;
+		}
+
+	tmpv = (float *)malloc( n*n * sizeof(float) );
+	if( tmpv == NULL ) {
+		fprintf( stderr, "internal error, failed to allocate array for calculating reduced means\n" );
+		exit( -1 );
+		}
+
 	for( j=0; j<new_ny; j++ )
 	for( i=0; i<new_nx; i++ ) {
 		for( jj=0; jj<n; jj++ )
@@ -1658,6 +2611,9 @@ contract_data( float *small_data, View *v, float fill_value )
 		if( options.shrink_method == SHRINK_METHOD_MEAN )
 			small_data[i + j*new_nx] = util_mean( tmpv, n*n, fill_value );
 
+		else if( options.shrink_method == SHRINK_METHOD_SAMPLE )	/* full-res data, e.g. after editing */
+			small_data[i + j*new_nx] = tmpv[0];
+
 		else if( options.shrink_method == SHRINK_METHOD_MODE ) {
 			small_data[i + j*new_nx] = util_mode( tmpv, n*n, fill_value );
 			}
@@ -1680,14 +2636,29 @@ contract_data( float *small_data, View *v, float fill_value )
 	void
 expand_data( float *big_data, View *v, size_t array_size )
 {
-	size_t	idx, nxl, nyl, nxb, nyb;
+	expand_data_array( big_data, (float *)v->data,
+		*(v->variable->size + v->x_axis_id), *(v->variable->size + v->y_axis_id),
+		v->variable->fill_value, array_size );
+}
+
+/******************************************************************************
+ * Blow up the nxl by nyl array 'little' into big_data, which is blowup times
+ * bigger in each direction.  Each point in the big array only depends on the
+ * little array points next to it (apart from along the edges), so this can
+ * also be used on a piece of a larger field, as the tiled drawing does.
+ */
+	void
+expand_data_array( float *big_data, float *little, size_t nxl, size_t nyl, float fill_val,
+		size_t array_size )
+{
+	size_t	idx, nxb, nyb;
 	long	line, il, jl, i2b, j2b;
 	int	blowup, offset_xb, offset_yb, miss_base, miss_right, miss_below;
 	float	step, final_est, extrap_fact;
 	float	base_val, right_val, below_val, val, bupr;
 	float	base_x, base_y, del_x, del_y;
 	float	est1, est2, frac_x, frac_y;
-	float 	fill_val, cval;
+	float 	cval;
 
 	blowup   = options.blowup;
 
@@ -1701,12 +2672,8 @@ expand_data( float *big_data, View *v, size_t array_size )
 	 * original (little) array, indicazted by a "l" (little) suffix (such as il or jl),
 	 * and indices valid in the destination (big) array, which have a suffix of "b".
 	 *---------------------------------------------------------------------------------*/
-	nxl = *(v->variable->size + v->x_axis_id);	/* # of X entries in the little array */
-	nyl = *(v->variable->size + v->y_axis_id);	/* # of Y entries in the little array */
 	nxb = nxl*blowup;				/* # of X entries in big array */
 	nyb = nyl*blowup;				/* # of Y entries in big array */
-
-	fill_val = v->variable->fill_value;
 	
 	if( (nxb < blowup) || (nxb*nyb < blowup) ) {
 		fprintf( stderr, "ncview: data_to_pixels: too much magnification\n" );
@@ -1721,7 +2688,7 @@ expand_data( float *big_data, View *v, size_t array_size )
 #ifdef CHECK_MEM
 					if( il*blowup + jl*nxb*blowup + i2b >= array_size ) { fprintf( stderr, "mem error 001\n" ); exit(-1); }
 #endif
-					*(big_data + il*blowup + jl*nxb*blowup + i2b) = *((float *)((float *)v->data)+il+jl*nxl);
+					*(big_data + il*blowup + jl*nxb*blowup + i2b) = *(little+il+jl*nxl);
 					}
 			for( line=1; line<blowup; line++ )
 				for( i2b=0; i2b<nxb; i2b++ ) {
@@ -1746,8 +2713,8 @@ expand_data( float *big_data, View *v, size_t array_size )
 		/* Horizontal base lines */
 		for( jl=0; jl<nyl; jl++ ) {
 			for( il=0; il<nxl-1; il++ ) {
-				base_val  = *((float *)v->data + il   + jl*nxl);
-				right_val = *((float *)v->data + il+1 + jl*nxl);
+				base_val  = *(little + il   + jl*nxl);
+				right_val = *(little + il+1 + jl*nxl);
 
 				miss_base  = close_enough(base_val,  fill_val);
 				miss_right = close_enough(right_val, fill_val);
@@ -1788,14 +2755,14 @@ expand_data( float *big_data, View *v, size_t array_size )
 #ifdef CHECK_MEM
 			if( (nxl-1)*blowup+offset_xb + jl*blowup*nxb + offset_yb*nxb >= array_size ) { fprintf( stderr, "mem error 004\n" ); exit(-1); }
 #endif
-			*(big_data + (nxl-1)*blowup+offset_xb + jl*blowup*nxb + offset_yb*nxb ) = *((float *)v->data + (nxl-1) + jl*nxl);
+			*(big_data + (nxl-1)*blowup+offset_xb + jl*blowup*nxb + offset_yb*nxb ) = *(little + (nxl-1) + jl*nxl);
 			}
 
 		/* Vertical base lines */
 		for( jl=0; jl<nyl-1; jl++ ) 
 		for( il=0; il<nxl;   il++ ) {
-			base_val  = *((float *)v->data + il + jl*nxl);
-			below_val = *((float *)v->data + il + (jl+1)*nxl);
+			base_val  = *(little + il + jl*nxl);
+			below_val = *(little + il + (jl+1)*nxl);
 
 			miss_base  = close_enough(base_val,  fill_val);
 			miss_below = close_enough(below_val, fill_val);
@@ -1838,7 +2805,7 @@ expand_data( float *big_data, View *v, size_t array_size )
 #ifdef CHECK_MEM
 			if( il*blowup+offset_xb + (nyl-1)*blowup*nxb + offset_yb*nxb >= array_size ) { fprintf( stderr, "mem error 006\n" ); exit(-1); }
 #endif
-			*(big_data + il*blowup+offset_xb + (nyl-1)*blowup*nxb + offset_yb*nxb) = *((float *)v->data + il + (nyl-1)*nxl);
+			*(big_data + il*blowup+offset_xb + (nyl-1)*blowup*nxb + offset_yb*nxb) = *(little + il + (nyl-1)*nxl);
 			}
 
 		/* Now, fill in the interior of the interior squares by 
@@ -1906,7 +2873,7 @@ expand_data( float *big_data, View *v, size_t array_size )
 			idx = il*blowup+offset_xb + (j2b+offset_yb)*nxb;	
 			step = (*(big_data + idx - 1) - *(big_data + idx - 2));
 			val  = *(big_data + idx) + step;
-			for( i2b=1; i2b<(blowup-offset_xb+1); i2b++ ) {
+			for( i2b=1; i2b<=blowup/2; i2b++ ) {
 #ifdef CHECK_MEM
 				if( idx + i2b >= array_size ) { fprintf( stderr, "mem error 008\n" ); exit(-1); }
 #endif
@@ -1968,7 +2935,7 @@ expand_data( float *big_data, View *v, size_t array_size )
 		/* Lower left corner */
 		il = 0;
 		jl = 0;
-		cval = *((float *)v->data + il + jl*nxl);          /* Data value in lower left corner */
+		cval = *(little + il + jl*nxl);          /* Data value in lower left corner */
 		if( ! close_enough( cval, fill_val )) {
 			/* Fill in lower left corner */
 			for( j2b=0; j2b<=offset_yb; j2b++ )
@@ -1983,7 +2950,7 @@ expand_data( float *big_data, View *v, size_t array_size )
 		/* Lower right corner */
 		il = nxl - 1;
 		jl = 0;
-		cval = *((float *)v->data + il + jl*nxl);          /* Data value in lower left corner */
+		cval = *(little + il + jl*nxl);          /* Data value in lower left corner */
 		if( ! close_enough( cval, fill_val )) {
 			/* Fill in lower right corner */
 			for( j2b=0; j2b<=offset_yb; j2b++ )
@@ -1998,7 +2965,7 @@ expand_data( float *big_data, View *v, size_t array_size )
 		/* Upper right corner */
 		il = nxl - 1;
 		jl = nyl - 1;
-		cval = *((float *)v->data + il + jl*nxl);          /* Data value in lower left corner */
+		cval = *(little + il + jl*nxl);          /* Data value in lower left corner */
 		if( ! close_enough( cval, fill_val )) {
 			/* Fill in upper right corner */
 			for( j2b=offset_yb; j2b<blowup; j2b++ )
@@ -2013,7 +2980,7 @@ expand_data( float *big_data, View *v, size_t array_size )
 		/* Upper left corner */
 		il = 0;
 		jl = nyl - 1;
-		cval = *((float *)v->data + il + jl*nxl);          /* Data value in lower left corner */
+		cval = *(little + il + jl*nxl);          /* Data value in lower left corner */
 		if( ! close_enough( cval, fill_val )) {
 			/* Fill in upper left corner */
 			for( j2b=offset_yb; j2b<blowup; j2b++ )
@@ -2028,7 +2995,7 @@ expand_data( float *big_data, View *v, size_t array_size )
 		/* Paint missing value blocks */
 		for( jl=0; jl<nyl; jl++ )
 		for( il=0; il<nxl; il++ ) {
-			base_val  = *((float *)v->data + il   + jl*nxl);
+			base_val  = *(little + il   + jl*nxl);
 			if( close_enough( base_val, fill_val )) {
 				for( j2b=0; j2b<blowup; j2b++ )
 				for( i2b=0; i2b<blowup; i2b++ ) {
@@ -2208,6 +3175,25 @@ void fmt_time( char *temp_string, size_t temp_string_len, double new_dimval, NCD
 		}
 }
 
+/*********************************************************************************************
+ * The other way around from fmt_time: puts the value of the date in 's' on timelike
+ * axis 'dim' into 'val'.  A plain number is taken as a value in the units of the dim.
+ * Returns 0 on success, -1 if the string can't be understood.
+ */
+	int
+parse_time( char *s, NCDim *dim, double *val )
+{
+	char	c;
+
+	if( (dim->time_std == TSTD_UDUNITS) && (udu_parse_time( s, dim, val ) == 0) )
+		return( 0 );
+
+	if( sscanf( s, "%lf %c", val, &c ) == 1 )
+		return( 0 );
+
+	return( -1 );
+}
+
 /*********************************************************************************************
  * like strncmp, but ignoring case
  */
@@ -2471,3 +3457,33 @@ void varname_no_groups( char *varname, char *varname_sans_groups, char *groupnam
 	*/
 }
 
+
+/*********************************************************************************************
+ * Returns the time in milliseconds, from a clock that is not affected by changes
+ * to the system date.  Only differences between two calls are meaningful.
+ */
+	double
+util_time_msec( void )
+{
+	struct timespec	ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return( (double)ts.tv_sec*1000.0 + (double)ts.tv_nsec/1.0e6 );
+}
+
+/*********************************************************************************************
+ * Adds n bytes at p to the running FNV-1a hash h.  Start h off at UTIL_HASH_INIT.
+ */
+	unsigned long long
+util_hash_bytes( unsigned long long h, void *p, size_t n )
+{
+	unsigned char	*c;
+	size_t		i;
+
+	c = (unsigned char *)p;
+	for( i=0; i<n; i++ ) {
+		h ^= *(c+i);
+		h *= 1099511628211ULL;
+		}
+	return( h );
+}
@@ -65,8 +65,10 @@ static NCDim *plot_XY_dim[MAX_PLOT_XY];
 static void 		determine_scan_axes( View *view, NCVar *var, View *old_view );
 static void 		initial_determine_scan_axes( View *view, NCVar *var );
 static void 		fill_view_data( View *v );
+static void 		view_read_data( View *v );
 static void 		view_set_axis( View *local_view, int dimension, char *new_dim_name );
 static void 		alloc_view_storage( View *view );
+static void 		alloc_view_pixels( View *view );
 static void 		init_view( View **view, NCVar *var );
 static void 		set_buttons( int to_state );
 static void 		re_determine_scan_axes( View *new_view, NCVar *new_var, View *old_view );
@@ -85,11 +87,25 @@ static void 		invalidate_variable( NCVar *var );
 static void 		plot_XY_sc( size_t *start, size_t *count );
 static void 		mouse_xy_to_data_xy( int mouse_x, int mouse_y, int blowup, size_t *data_x, size_t *data_y );
 static int 		view_data_has_missing( View *v );
+static float		view_data_value( View *v, size_t *data_x, size_t *data_y );
+static int		view_data_stride_wanted( View *v );
 static void 		view_construct_scalar_coord_str( char *str, int slen );
+static void 		view_axis_value_str( int axis_id, size_t place, size_t *virt_cursor_pos, char *s, size_t slen );
 static float 		view_calc_minval_float( float *arr, size_t n );
 static float 		view_calc_maxval_float( float *arr, size_t n );
 static void 		strip_trailing_zeros( char *s );
 
+/* What the readout of the cursor position in the main window last showed,
+ * so that the label is only redone when that changes
+ */
+static struct {
+	View	*view;
+	NCVar	*variable;
+	int	x_axis_id, y_axis_id, t_conv;
+	size_t	data_x, data_y, var_place[MAX_NC_DIMS];
+	float	val;
+} readout = { NULL, NULL, -1, -1, 0, 0, 0, {0}, 0.0 };
+
 #define NFRAMES_RECORD	10
 static int    n_new_frame_times=0;			/* Numer of valid entries in following two arrays */
 static time_t new_frame_times[NFRAMES_RECORD];		/* TIME that new frame(s) were found */
@@ -105,7 +121,7 @@ set_scan_variable( NCVar *var )
 	View	*new_view, *old_view;
 	size_t	*start, *count, x_size, y_size, scaled_x_size, scaled_y_size;
 	long	i;
-	int	changed_size, overlay2use;
+	int	changed_size, overlay2use, err;
 	float	range_x, range_y;
 	NCDim	*xdim, *ydim, *xdim_old, *xdim_new, *ydim_old, *ydim_new;
 
@@ -118,6 +134,11 @@ set_scan_variable( NCVar *var )
 
 	in_set_cursor_busy();
 
+	/* The first time a var is looked at, find out the rest about it */
+	TRACE_BEGIN( "var_fill_details", var->name );
+	var_fill_details( var );
+	TRACE_END( "var_fill_details" );
+
 	set_buttons( BUTTONS_ALL_ON );
 	unlock_plot();
 
@@ -269,7 +290,11 @@ set_scan_variable( NCVar *var )
 	/* Actually read the data in from the file */
 	if( options.debug )
 		fprintf( stderr, "...reading data from file\n" );
-	fill_view_data( view );
+	view_read_data( view );
+
+	/* Frames held on the display belong to the old variable */
+	in_pixmap_ring_invalidate();
+	view_tiles_invalidate();
 
 	if( options.save_frames == TRUE )
 		{
@@ -279,8 +304,11 @@ set_scan_variable( NCVar *var )
 		}
 
 	/* Set the min and maxes of the data */
-	if( !view->variable->have_set_range )
+	if( !view->variable->have_set_range ) {
+		TRACE_BEGIN( "init_min_max", var->name );
 		init_min_max( var );
+		TRACE_END( "init_min_max" );
+		}
 
 	/* If we are automatically putting on overlays, do so now */
 	xdim = *(view->variable->dim + view->x_axis_id);
@@ -305,7 +333,14 @@ set_scan_variable( NCVar *var )
 	if( options.debug )
 		fprintf( stderr, "...converting data to pixels\n" );
 	lockout_view_changes = TRUE;
-	if( data_to_pixels( view ) < 0 ) {
+	if( view_tiles_active( view ))
+		err = view_tiles_prepare( view );
+	else
+		{
+		alloc_view_pixels( view );
+		err = data_to_pixels( view );
+		}
+	if( err < 0 ) {
 		in_timer_clear();
 		if( view->variable->global_min == view->variable->global_max )
 			invalidate_variable( view->variable );
@@ -533,55 +568,73 @@ set_scan_view( size_t scan_place )
 	*(view->var_place + view->scan_axis_id) = scan_place;
 	snprintf( view_place, 1023, "frame %1ld/%1ld ", scan_place+1, size );
 
-	/* type is the data type of the dimension--can be float or character */
-	type = fi_dim_value( view->variable, view->scan_axis_id, scan_place, &new_dimval, 
-			temp_string, &has_bounds, &bound_min, &bound_max, view->var_place );
-	if( type == NC_DOUBLE ) {
-		if( dim->timelike && options.t_conv ) {
-			fmt_time( temp_string, 1024, new_dimval, dim, 1 );
-			strcat( view_place, temp_string );
-			if( has_bounds ) {
-				snprintf( temp_string, 1023, " (%d bnds:", has_bounds );
+	/* Timelike dims have their values at hand; only go back to the
+	 * file if there are bounds to show as well
+	 */
+	if( dim->timelike && options.t_conv && (scan_place < dim->n_time_values) && (dim->has_bounds == 0) ) {
+		fmt_time( temp_string, 1024, dim->time_values[scan_place], dim, 1 );
+		strcat( view_place, temp_string );
+		}
+	else
+		{
+		/* type is the data type of the dimension--can be float or character */
+		type = fi_dim_value( view->variable, view->scan_axis_id, scan_place, &new_dimval, 
+				temp_string, &has_bounds, &bound_min, &bound_max, view->var_place );
+		if( type == NC_DOUBLE ) {
+			if( dim->timelike && options.t_conv ) {
+				fmt_time( temp_string, 1024, new_dimval, dim, 1 );
 				strcat( view_place, temp_string );
+				if( has_bounds ) {
+					snprintf( temp_string, 1023, " (%d bnds:", has_bounds );
+					strcat( view_place, temp_string );
 
-				fmt_time( temp_string, 1024, bound_min, dim, 0 );
-				strcat( view_place, temp_string );
+					fmt_time( temp_string, 1024, bound_min, dim, 0 );
+					strcat( view_place, temp_string );
 
-				strcat( view_place, " -> " );
+					strcat( view_place, " -> " );
 
-				fmt_time( temp_string, 1024, bound_max, dim, 0 );
-				strcat( view_place, temp_string );
+					fmt_time( temp_string, 1024, bound_max, dim, 0 );
+					strcat( view_place, temp_string );
 
-				strcat( view_place, ")" );
+					strcat( view_place, ")" );
+					}
 				}
-			}
-		else
-			{
-			snprintf( temp_string, 1023, "%lg", new_dimval );
-			if( has_bounds ) {
-				snprintf( temp_string, 1023, " (%d bnds:", has_bounds );
-				strcat( view_place, temp_string );
+			else
+				{
+				snprintf( temp_string, 1023, "%lg", new_dimval );
+				if( has_bounds ) {
+					snprintf( temp_string, 1023, " (%d bnds:", has_bounds );
+					strcat( view_place, temp_string );
 
-				snprintf( temp_string, 1023, "%lg", bound_min );
-				strcat( view_place, temp_string );
+					snprintf( temp_string, 1023, "%lg", bound_min );
+					strcat( view_place, temp_string );
 
-				strcat( view_place, " -> " );
+					strcat( view_place, " -> " );
 
-				snprintf( temp_string, 1023, "%lg", bound_max );
-				strcat( view_place, temp_string );
+					snprintf( temp_string, 1023, "%lg", bound_max );
+					strcat( view_place, temp_string );
 
-				strcat( view_place, ")" );
+					strcat( view_place, ")" );
+					}
 				}
 			}
+		else
+			; /* don't have to do anything, since string-type dimval
+			   * is already in variable "temp_string"
+			   */
 		}
-	else
-		; /* don't have to do anything, since string-type dimval
-		   * is already in variable "temp_string"
-		   */
+	strncat( view_place, playback_status(), 1023-strlen(view_place) );
 	in_set_label( LABEL_SCAN_PLACE, view_place );
 	in_set_cur_dim_value( dim_name, temp_string );
 	view->data_status = VDS_INVALID;
 	if( options.want_extra_info ) {
+		/* Also show how long frames have been taking to draw */
+		timing_summary( scalar_coord_str, 1020 );
+		if( strlen(scalar_coord_str) > 0 ) {
+			safe_strcat( temp_string, 1024, "   [ms: " );
+			safe_strcat( temp_string, 1024, scalar_coord_str );
+			safe_strcat( temp_string, 1024, "]" );
+			}
 		in_set_label( LABEL_CCINFO_2, temp_string );
 		}
 
@@ -599,10 +652,12 @@ set_scan_view( size_t scan_place )
 view_draw( int allow_framestore_usage, int force_range_to_frame )
 {
 	long		i; 
-	size_t		x_size, y_size, scan_size, scaled_x_size, scaled_y_size, framesize, frameno;
+	size_t		x_size, y_size, scan_size, scaled_x_size, scaled_y_size, framesize, frameno,
+			data_nx, data_ny;
 	static int	last_x_size=0, last_y_size=0;
-	int		must_recalc_range;
+	int		must_recalc_range, drew_from_store, tiled, err;
 	float		min, max, dat;
+	double		t_start;
 
 	/* The reason why we have to lockout the possiblity that this
 	 * routine is called WHILE it is executing is tricky.  The 
@@ -616,6 +671,7 @@ view_draw( int allow_framestore_usage, int force_range_to_frame )
 	if( lockout_view_changes )
 		return(0);
 	lockout_view_changes = TRUE;
+	t_start = util_time_msec();
 
 	/* These can happen because this routine is called when the ccontour
 	 * window gets 'expose' events, which happens on program startup,
@@ -635,7 +691,8 @@ view_draw( int allow_framestore_usage, int force_range_to_frame )
 		min = 1.0e35;
 		max = -min;
 
-		for( i=0; i<x_size*y_size; i++ ) {
+		view_data_size( view, &data_nx, &data_ny );
+		for( i=0; i<data_nx*data_ny; i++ ) {
 			dat = *((float *)(view->data)+i);
 			if( dat != dat ) 
 				dat = view->variable->fill_value;
@@ -673,29 +730,49 @@ view_draw( int allow_framestore_usage, int force_range_to_frame )
 						frameno );
 		}
 
-	/* Is this frame stored in the framestore? */
-	if( framestore.valid && allow_framestore_usage ) {
-		if( *(framestore.frame_valid + frameno) == TRUE ) {
+	/* Big blown-up images are drawn only where they can be seen,
+	 * and don't go in the framestore.
+	 */
+	tiled = view_tiles_active( view );
+
+	/* Is this frame still on the display from being drawn recently,
+	 * or stored in the framestore?  The first is faster, but we
+	 * can't use it when dumping frames since nothing would be dumped.
+	 */
+	if( allow_framestore_usage && (! tiled) ) {
+		if( (! options.dump_frames) && (options.stream_file == NULL) && in_pixmap_ring_draw( frameno, scaled_x_size, scaled_y_size ))
+			drew_from_store = TRUE;
+		else if( framestore.valid && (*(framestore.frame_valid + frameno) == TRUE)) {
 			if( options.debug )
 				printf( "drawing from framestore...\n" );
 			in_draw_2d_field( (framestore.frame + frameno*framesize), 
 				scaled_x_size, scaled_y_size, frameno );
+			drew_from_store = TRUE;
+			}
+		else
+			drew_from_store = FALSE;
+
+		if( drew_from_store ) {
+			timing_add( TIMING_TOTAL, t_start );
+			timing_frame_done( view->variable->name, (long)frameno );
 			lockout_view_changes = FALSE;
 
 			if( view->scan_axis_id != -1 ) {
 				scan_size  = *(view->variable->size  + view->scan_axis_id);
 				if( (frameno == (scan_size-1)) && (which_button_pressed() == BUTTON_PAUSE)) {
-					in_timer_set( (XtTimerCallbackProc)view_check_new_data, 0, 1000L );
+					in_timer_set( (XtTimerCallbackProc)view_check_new_data, 0, watch_interval() );
 					}
 				}
 			return(0);
 			}
 		}
 
-	if( view->data_status == VDS_INVALID ) {
+	if( (view->data_status == VDS_INVALID) || 
+	    ((view->data_status == VDS_VALID) && (view->data_stride != view_data_stride_wanted( view ))) ||
+	    ((view->data_status == VDS_PREVIEW) && (! progressive_pending()))) {
 		if( options.debug )
 			printf( "Reading data to contour...\n" );
-		fill_view_data( view );
+		view_read_data( view );
 		}
 	else
 		{
@@ -705,7 +782,15 @@ view_draw( int allow_framestore_usage, int force_range_to_frame )
 
 	if( options.debug )
 		printf( "Calling data_to_pixels...\n" );
-	if( data_to_pixels( view ) < 0 ) {
+	if( tiled )
+		err = view_tiles_prepare( view );
+	else
+		{
+		alloc_view_pixels( view );
+		err = data_to_pixels( view );
+		}
+	if( err < 0 ) {
+		timing_frame_abort();
 		in_timer_clear();
 		if( view->variable->global_min == view->variable->global_max )
 			invalidate_variable( view->variable );
@@ -720,14 +805,28 @@ view_draw( int allow_framestore_usage, int force_range_to_frame )
 		in_set_2d_size  ( scaled_x_size, scaled_y_size );
 		}
 
-	if( options.debug )
-		printf( "Calling draw_2d_field...\n" );
-	in_draw_2d_field( view->pixels, scaled_x_size, scaled_y_size, frameno );
+	if( tiled ) {
+		if( options.debug )
+			printf( "Calling view_tiles_draw...\n" );
+		view_tiles_draw( view, frameno, scaled_x_size, scaled_y_size );
+		}
+	else
+		{
+		if( options.debug )
+			printf( "Calling draw_2d_field...\n" );
+		in_draw_2d_field( view->pixels, scaled_x_size, scaled_y_size, frameno );
 
-	if( framestore.valid == TRUE ) {
-		for( i=0; i<framesize; i++ )
-			*(framestore.frame + frameno*framesize + i) = *(view->pixels + i);
-		*(framestore.frame_valid + frameno) = TRUE;
+		if( (framestore.valid == TRUE) && (view->data_status != VDS_PREVIEW) ) {
+			for( i=0; i<framesize; i++ )
+				*(framestore.frame + frameno*framesize + i) = *(view->pixels + i);
+			*(framestore.frame_valid + frameno) = TRUE;
+			}
+		}
+
+	/* Don't keep a preview around as though it were the frame */
+	if( view->data_status == VDS_PREVIEW ) {
+		in_pixmap_ring_forget( frameno );
+		view_tiles_forget( frameno );
 		}
 
 	/* If we just drew the last time entry for this var, then
@@ -737,24 +836,227 @@ view_draw( int allow_framestore_usage, int force_range_to_frame )
 	if( view->scan_axis_id != -1 ) {
 		scan_size  = *(view->variable->size  + view->scan_axis_id);
 		if( (frameno == (scan_size-1)) && (which_button_pressed() == BUTTON_PAUSE)) {
-			in_timer_set( (XtTimerCallbackProc)view_check_new_data, 0, 1000L );
+			in_timer_set( (XtTimerCallbackProc)view_check_new_data, 0, watch_interval() );
 			}
 		}
 
+	timing_add( TIMING_TOTAL, t_start );
+	timing_frame_done( view->variable->name, (long)frameno );
 	lockout_view_changes = FALSE;
 	return( 0 );
 }
 
+/********************************************************************************
+ * Read and colorize frame 'frameno' along the scan axis and put it in the 
+ * framestore, without displaying it or changing the current view.  This is 
+ * used to render frames ahead of time during animation.  Returns 0 if the 
+ * frame is now in the framestore, or -1 if it can't be rendered ahead (the
+ * framestore is off, the range would change per frame, etc).
+ */
+	int
+view_prerender_frame( size_t frameno )
+{
+	static float	*scratch_data = NULL;
+	static size_t	scratch_size = 0L;
+	size_t		x_size, y_size, scaled_x_size, scaled_y_size, framesize, old_place;
+	void		*old_data;
+	ncv_pixel	*old_pixels;
+	int		old_status, old_stride, err;
+	double		t_start;
+
+	if( lockout_view_changes )
+		return( -1 );
+
+	if( (view == NULL) || (view->data == NULL) || (view->scan_axis_id == -1))
+		return( -1 );
+
+	if( (! framestore.valid) || options.autoscale || options.dump_frames || (options.stream_file != NULL) ||
+	    (! view->variable->have_set_range) || (view->data_status == VDS_EDITED))
+		return( -1 );
+
+	if( frameno >= *(view->variable->size + view->scan_axis_id))
+		return( -1 );
+
+	if( *(framestore.frame_valid + frameno) == TRUE )
+		return( 0 );
+
+	x_size = *(view->variable->size + view->x_axis_id);
+	y_size = *(view->variable->size + view->y_axis_id);
+	view_get_scaled_size( options.blowup, x_size, y_size, &scaled_x_size, &scaled_y_size );
+	framesize = scaled_x_size * scaled_y_size;
+
+	if( scratch_size < x_size*y_size ) {
+		if( scratch_data != NULL )
+			free( scratch_data );
+		scratch_size = x_size*y_size;
+		scratch_data = (float *)malloc( scratch_size*sizeof(float) );
+		if( scratch_data == NULL ) {
+			fprintf( stderr, "ncview: view_prerender_frame: can't allocate %ld floats\n", 
+				scratch_size );
+			exit( -1 );
+			}
+		}
+
+	lockout_view_changes = TRUE;
+	t_start = util_time_msec();
+
+	/* Read into a scratch array and colorize straight into the
+	 * framestore, so that the data and pixels of the frame now
+	 * on the screen are left alone.
+	 */
+	old_data   = view->data;
+	old_pixels = view->pixels;
+	old_status = view->data_status;
+	old_stride = view->data_stride;
+	old_place  = *(view->var_place + view->scan_axis_id);
+
+	view->data   = (void *)scratch_data;
+	view->pixels = framestore.frame + frameno*framesize;
+	*(view->var_place + view->scan_axis_id) = frameno;
+	view->data_status = VDS_INVALID;
+
+	if( options.debug )
+		printf( "rendering frame %ld ahead into framestore\n", frameno );
+	fill_view_data( view );
+	err = data_to_pixels( view );
+
+	*(view->var_place + view->scan_axis_id) = old_place;
+	view->data        = old_data;
+	view->pixels      = old_pixels;
+	view->data_status = old_status;
+	view->data_stride = old_stride;
+
+	if( err < 0 ) {
+		timing_frame_abort();
+		lockout_view_changes = FALSE;
+		return( -1 );
+		}
+
+	*(framestore.frame_valid + frameno) = TRUE;
+	timing_add( TIMING_TOTAL, t_start );
+	timing_frame_done( view->variable->name, (long)frameno );
+	lockout_view_changes = FALSE;
+	return( 0 );
+}
+
+/********************************************************************************
+ * Returns the current place along the scan axis, or -1 if there is none
+ */
+	long
+view_current_scan_place( void )
+{
+	if( (view == NULL) || (view->scan_axis_id == -1))
+		return( -1L );
+
+	return( (long)*(view->var_place + view->scan_axis_id) );
+}
+
+/********************************************************************************
+ * Returns the place along the scan axis that change_view( delta, FRAMES )
+ * would move to, starting from 'place'; or -1 if that would stop the 
+ * animation instead.
+ */
+	long
+view_next_scan_place( long place, int delta )
+{
+	long	size;
+
+	if( (view == NULL) || (view->scan_axis_id == -1))
+		return( -1L );
+
+	size   = (long)*(view->variable->size + view->scan_axis_id);
+	place += delta * view->skip;
+
+	if( place >= size ) {
+		if( options.stop_on_restart )
+			return( -1L );
+		place = 0L;
+		}
+	if( place < 0L )
+		place = size - 1L;
+
+	return( place );
+}
+
+/********************************************************************************
+ * Make a view of the passed variable that is not connected to the display, 
+ * for rendering frames straight to files (see render.c).  The axes are
+ * picked the same way as when the variable is first selected interactively.
+ */
+	View *
+view_new_offscreen( NCVar *var )
+{
+	View	*v;
+	size_t	x_size, y_size, scaled_x_size, scaled_y_size;
+
+	var_fill_details( var );
+	init_view( &v, var );
+	initial_determine_scan_axes( v, var );
+	if( v->y_axis_id == -1 )
+		return( v );
+
+	x_size = *(var->size + v->x_axis_id);
+	y_size = *(var->size + v->y_axis_id);
+	view_get_scaled_size( options.blowup, x_size, y_size, &scaled_x_size, &scaled_y_size );
+
+	v->data   = (void *)malloc( x_size*y_size*sizeof(float) );
+	v->pixels = (ncv_pixel *)malloc( scaled_x_size*scaled_y_size*sizeof(ncv_pixel) );
+	v->n_pixels = scaled_x_size*scaled_y_size;
+	if( (v->data == NULL) || (v->pixels == NULL)) {
+		fprintf( stderr, "ncview: view_new_offscreen: can't allocate data and pixel arrays for %s\n",
+			var->name );
+		exit( -1 );
+		}
+
+	return( v );
+}
+
+/********************************************************************************
+ * Read and colorize the frame at 'scan_place' along the scan axis of an
+ * offscreen view, leaving the result in v->pixels.  Returns 0 on success.
+ */
+	int
+view_render_offscreen( View *v, size_t scan_place )
+{
+	if( v->scan_axis_id != -1 )
+		*(v->var_place + v->scan_axis_id) = scan_place;
+	v->data_status = VDS_INVALID;
+
+	fill_view_data( v );
+	return( data_to_pixels( v ));
+}
+
+/********************************************************************************
+ * Called when the full resolution data for the preview now in the view has
+ * been read (see progressive.c); puts it in and redraws.  Does nothing if
+ * the view is in the middle of being drawn.
+ */
+	void
+view_set_refined_data( float *data )
+{
+	size_t	nx, ny;
+
+	if( lockout_view_changes || (view->data_status != VDS_PREVIEW) )
+		return;
+
+	nx = *(view->variable->size + view->x_axis_id);
+	ny = *(view->variable->size + view->y_axis_id);
+	memcpy( view->data, data, nx*ny*sizeof(float) );
+	view->data_status = VDS_VALID;
+
+	view_draw( FALSE, FALSE );
+}
+
 /********************************************************************************
  * Checks if the file has grown since we last saw it
  */
 	void
 view_check_new_data( int unused )
 {
-	size_t 	file_var_size[MAX_NC_DIMS], *t, n_other;
-	int	i, has_grown, ierr, t_ncid, timelike_index;
+	size_t 	*t, n_other;
+	int	i, ierr, timelike_index;
 	size_t	dt, nt_new, n_scan_entries, n_extra_frames, storage_size, old_nt;
-	char	message[1024], rate_units[50];
+	char	message[1024], rate_units[50], new_filename[MAX_FILE_NAME_LEN];
 	time_t	tt;
 	long	nframes_tot, delta_time;
 	float	rate_per_sec, rate_per_min, rate_per_hour, rate_per_day, rate,
@@ -771,26 +1073,32 @@ view_check_new_data( int unused )
 	if( view->scan_axis_id != timelike_index ) 	/* in netcdf v3, simple way to check for time dimension */
 		return;
 
-	/* Get size of the var in the last file */
-	t_ncid = netcdf_fi_initialize( view->variable->last_file->filename );
-	t = netcdf_fi_var_size( t_ncid, view->variable->name );
-	for( i=0; i<view->variable->n_dims; i++ )
-		file_var_size[i] = t[i];
-	free( t );
-	ierr = nc_close( t_ncid );
-
-	has_grown = 0;
-	if( file_var_size[ timelike_index ] > view->variable->last_file->var_size[ timelike_index ] ) {
-		has_grown = 1;
+	/* Only look inside the last file if it has changed since last time */
+	watch_file( view->variable->last_file->filename );
+	dt = 0L;
+	if( watch_file_changed() ) {
+		t = netcdf_fi_var_size_now( fi_fdb_id( view->variable->last_file ), 
+			view->variable->last_file->filename, view->variable->name );
+		if( t[timelike_index] > view->variable->last_file->var_size[timelike_index] ) {
+			dt = t[timelike_index] - view->variable->last_file->var_size[timelike_index];
+			fdb_own_var_size( view->variable, view->variable->last_file );
+			view->variable->size[ timelike_index ] += dt;
+			view->variable->last_file->var_size[ timelike_index ] += dt;
+			fill_timestep_map( view->variable );
+			}
+		free( t );
 		}
 
-	if( ! has_grown ) {
-		in_timer_set( (XtTimerCallbackProc)view_check_new_data, 0, 1000L );
+	/* A new file that follows on from the last one also brings new frames */
+	if( (dt == 0) && watch_new_file( new_filename, MAX_FILE_NAME_LEN ))
+		dt = add_new_file_to_vars( view->variable, new_filename );
+
+	if( dt == 0 ) {
+		in_timer_set( (XtTimerCallbackProc)view_check_new_data, 0, watch_interval() );
 		return;
 		}
 
-	dt = file_var_size[timelike_index] - view->variable->last_file->var_size[timelike_index];
-	nt_new = view->variable->size[timelike_index] + dt;
+	nt_new = view->variable->size[timelike_index];
 
 	/* Make our informative label */
 	tt = time(NULL);	/* Time this new frame was found, in seconds since epoch */
@@ -843,7 +1151,7 @@ view_check_new_data( int unused )
 	in_set_label( LABEL_TITLE, message );
 
 	/* See if we need to reallocate the framestore */
-	if( nt_new >= framestore.nt ) {
+	if( framestore.valid && (nt_new >= framestore.nt) ) {
 		old_nt = framestore.nt;
 		n_scan_entries = *(view->variable->size + view->scan_axis_id);
 		n_extra_frames = floor( n_scan_entries * 0.2 ) + 1;
@@ -872,11 +1180,8 @@ view_check_new_data( int unused )
 			*(framestore.frame_valid+i) = FALSE;
 		}
 
-	view->variable->size[ timelike_index ] = nt_new;
-	view->variable->last_file->var_size[ timelike_index ] += dt;
-
 	/* Resync so we will read the last time entry */
-	ierr = nc_sync( view->variable->last_file->id );
+	ierr = nc_sync( fi_fdb_id( view->variable->last_file ));
 
 	/* Special check: if we were started with no range in the variable,
 	 * but now we have one, then reset the displayed range
@@ -1120,20 +1425,31 @@ initial_determine_scan_axes( View *view, NCVar *var )
 fill_view_data( View *v )
 {
 	size_t	*count;
-	int	i;
+	ptrdiff_t *stride;
+	int	i, data_stride;
+	double	t_start;
 
-	if( v->data_status == VDS_VALID )
+	data_stride = view_data_stride_wanted( v );
+	if( (v->data_status == VDS_VALID) && (v->data_stride == data_stride) )
 		return;
 
-	count = (size_t *)malloc( v->variable->n_dims * sizeof( size_t ));
+	/* Whatever we were reading in the background is no longer wanted */
+	progressive_cancel();
+
+	count  = (size_t *)malloc( v->variable->n_dims * sizeof( size_t ));
+	stride = (ptrdiff_t *)malloc( v->variable->n_dims * sizeof( ptrdiff_t ));
 
 	/* By default, count of 1 for all uninteresting dimensions */
-	for( i=0; i<v->variable->n_dims; i++ ) 
-		*(count+i) = 1;
+	for( i=0; i<v->variable->n_dims; i++ ) {
+		*(count+i)  = 1;
+		*(stride+i) = 1;
+		}
 
 	/* Do full count of the X and Y axes so we can display the whole 2D field */
-	*(count+v->x_axis_id) = *(v->variable->size + v->x_axis_id);
-	*(count+v->y_axis_id) = *(v->variable->size + v->y_axis_id);
+	v->data_stride = data_stride;
+	view_data_size( v, count+v->x_axis_id, count+v->y_axis_id );
+	*(stride+v->x_axis_id) = data_stride;
+	*(stride+v->y_axis_id) = data_stride;
 
 	if( options.debug || options.show_sel ) {
 		printf( "-var %s -start \\(", v->variable->name );
@@ -1151,10 +1467,94 @@ fill_view_data( View *v )
 		printf( "\\) %s\n", v->variable->first_file->filename );
 		}
 
-	fi_get_data( v->variable, v->var_place, count, v->data );
+	t_start = util_time_msec();
+	if( (data_stride > 1) && (options.shrink_method == SHRINK_METHOD_MEAN) ) {
+		/* Block averages come from the pyramid.  If it hasn't been
+		 * made yet, read the whole slice and make it now.
+		 */
+		if( pyramid_read( v, data_stride ) != 0 ) {
+			v->data_stride = 1;
+			view_data_size( v, count+v->x_axis_id, count+v->y_axis_id );
+			fi_get_data( v->variable, v->var_place, count, v->data );
+			if( (pyramid_build( v ) == 0) && (pyramid_read( v, data_stride ) == 0))
+				v->data_stride = data_stride;
+			}
+		}
+	else if( data_stride > 1 )
+		fi_get_data_strided( v->variable, v->var_place, count, stride, v->data );
+	else
+		fi_get_data( v->variable, v->var_place, count, v->data );
+	timing_add( TIMING_READ, t_start );
 
 	v->data_status = VDS_VALID;
 	free( count );
+	free( stride );
+}
+
+/********************************************************************************
+ * Read in the current slice for display, putting up a quick preview first if
+ * the read might be slow.
+ */
+	static void
+view_read_data( View *v )
+{
+	if( (view_data_stride_wanted( v ) == 1) && progressive_wanted( v ))
+		progressive_start( v );
+	else
+		fill_view_data( v );
+}
+
+/********************************************************************************
+ * When shrinking by sampling, we only read the points that will be shown.
+ * When shrinking by averaging, we can start from block averages in the
+ * pyramid, if there is one.  Edited data is kept at full resolution, and
+ * shrunk from that.
+ */
+	static int
+view_data_stride_wanted( View *v )
+{
+	if( (options.blowup >= 0) || (v->data_status == VDS_EDITED) )
+		return( 1 );
+	if( options.shrink_method == SHRINK_METHOD_SAMPLE )
+		return( -options.blowup );
+	if( options.shrink_method == SHRINK_METHOD_MEAN )
+		return( pyramid_stride_wanted( v ));
+	return( 1 );
+}
+
+/********************************************************************************
+ * Size of the 2-D array actually held in v->data.  This is the full size
+ * of the X-Y slice, except when only every data_stride'th point was read.
+ * The full size array is always allocated, but when sampling only the
+ * first part of it gets touched.
+ */
+	void
+view_data_size( View *v, size_t *nx, size_t *ny )
+{
+	size_t	s;
+
+	s   = v->data_stride;
+	*nx = (*(v->variable->size + v->x_axis_id) + s - 1)/s;
+	*ny = (*(v->variable->size + v->y_axis_id) + s - 1)/s;
+}
+
+/********************************************************************************
+ * Value of the data at full-resolution location (data_x, data_y).  If we
+ * only read a sample of the points, the location is moved to the sampled
+ * point that stands for it, which is what is shown on the screen.
+ */
+	static float
+view_data_value( View *v, size_t *data_x, size_t *data_y )
+{
+	size_t	nx, ny, s;
+
+	s = v->data_stride;
+	view_data_size( v, &nx, &ny );
+
+	*data_x = (*data_x/s)*s;
+	*data_y = (*data_y/s)*s;
+
+	return( *((float *)v->data + *data_x/s + (*data_y/s)*nx) );
 }
 
 /********************************************************************************
@@ -1198,14 +1598,17 @@ view_change_blowup( int delta, int redraw_flag, int view_var_is_valid )
 		view->variable->user_set_blowup = options.blowup;
 		}
 
+	/* Made again at the new size when it is next needed */
 	free( view->pixels );
+	view->pixels   = NULL;
+	view->n_pixels = 0L;
 
 	x_size       = *(view->variable->size + view->x_axis_id);
 	y_size       = *(view->variable->size + view->y_axis_id);
 	view_get_scaled_size( options.blowup, x_size, y_size, &scaled_x_size, &scaled_y_size );
 
-	view->pixels = (void *)malloc( scaled_x_size*scaled_y_size*sizeof(ncv_pixel) );
-
+	in_pixmap_ring_invalidate();
+	view_tiles_invalidate();
 	if( options.save_frames == TRUE ) {
 		if( options.debug )
 			fprintf( stderr, "calling init_saveframes from view_change_blowup\n" );
@@ -1291,14 +1694,20 @@ view_change_cur_dim( char *dim_name, int modifier )
 
 	place = *(view->var_place+dimid);
 
-	type  = fi_dim_value( view->variable, dimid, place, &new_dimval, temp_string, 
-		&has_bounds, &bound_min, &bound_max, view->var_place );
-	if( type == NC_DOUBLE ) {
-		if( dim->timelike && options.t_conv ) {
-			fmt_time( temp_string, 1024, new_dimval, dim, 1 );
+	/* Timelike dims have their values at hand */
+	if( dim->timelike && options.t_conv && (place < dim->n_time_values) )
+		fmt_time( temp_string, 1024, dim->time_values[place], dim, 1 );
+	else
+		{
+		type  = fi_dim_value( view->variable, dimid, place, &new_dimval, temp_string, 
+			&has_bounds, &bound_min, &bound_max, view->var_place );
+		if( type == NC_DOUBLE ) {
+			if( dim->timelike && options.t_conv ) {
+				fmt_time( temp_string, 1024, new_dimval, dim, 1 );
+				}
+			else
+				snprintf( temp_string, 1023, "%lg", new_dimval );
 			}
-		else
-			snprintf( temp_string, 1023, "%lg", new_dimval );
 		}
 	in_set_cur_dim_value( dim_name, temp_string );
 
@@ -1311,6 +1720,72 @@ view_change_cur_dim( char *dim_name, int modifier )
 	view_draw( TRUE, FALSE ); /* 'TRUE' because we initialized saveframes above */
 }
 
+/************************************************************************
+ * This routine handles the case where the user asks to jump to a 
+ * particular date on a timelike dimension.  We go to the entry nearest
+ * to the date they give.
+ */
+	void
+view_jump_cur_dim( char *dim_name )
+{
+	int	dimid, message;
+	double	target;
+	size_t	place;
+	NCDim	*dim;
+	char	temp_string[1024], date_string[1024];
+
+	if( view == NULL ) {
+		in_error( "Please select a variable first" );
+		return;
+		}
+
+	dimid = fi_dim_name_to_id( view->variable->first_file->id,
+				view->variable->name, dim_name );
+	if( (dimid == view->x_axis_id) ||
+	    (dimid == view->y_axis_id) )
+		return;
+
+	dim = *(view->variable->dim + dimid);
+	if( (dim == NULL) || (! dim->timelike) || (! dim_fill_time_values( view->variable, dimid )) ) {
+		in_error( "Can only jump to a date on a time dimension" );
+		return;
+		}
+
+	fmt_time( date_string, 1024, dim->time_values[ *(view->var_place+dimid) ], dim, 0 );
+	message = in_dialog( "Jump to date (like 2000-01-31 12:00:00):", date_string, TRUE );
+	if( message != MESSAGE_OK )
+		return;
+
+	if( parse_time( date_string, dim, &target ) != 0 ) {
+		snprintf( temp_string, 1023, "Can't understand the date \"%s\"", date_string );
+		in_error( temp_string );
+		return;
+		}
+
+	place = dim_nearest_time( dim, target );
+	if( options.debug )
+		printf( "view_jump_cur_dim: date %s is %lf, nearest place is %ld\n", date_string, target, place );
+
+	if( view->data_status == VDS_EDITED ) 
+		view_data_edit_warn();
+
+	if( dimid == view->scan_axis_id ) {
+		view->data_status = VDS_INVALID;
+		set_scan_view( place );
+		view_draw( TRUE, FALSE );
+		return;
+		}
+
+	*(view->var_place+dimid) = place;
+	fmt_time( temp_string, 1024, dim->time_values[place], dim, 1 );
+	in_set_cur_dim_value( dim_name, temp_string );
+
+	view->data_status = VDS_INVALID;
+	init_saveframes();
+
+	view_draw( TRUE, FALSE );
+}
+
 /**********************************************************************
  * This is ultimately what changes what the X and Y dims are.  It is
  * called when the interface button requesting that a change to the
@@ -1465,7 +1940,7 @@ view_set_axis( View *local_view, int dimension, char *new_dim_name )
 	static void
 alloc_view_storage( View *view )
 {
-	size_t	x_size, y_size, tot_size, scaled_x_size, scaled_y_size;
+	size_t	x_size, y_size, tot_size;
 
 	/* Allocate storage space for the data in the view structure
 	 */
@@ -1480,7 +1955,6 @@ alloc_view_storage( View *view )
 		free( view->pixels );
 	x_size       = *(view->variable->size + view->x_axis_id);
 	y_size       = *(view->variable->size + view->y_axis_id);
-	view_get_scaled_size( options.blowup, x_size, y_size, &scaled_x_size, &scaled_y_size );
 
 	tot_size     = x_size*y_size*sizeof(float);
 	view->data   = (void *)malloc( tot_size );
@@ -1499,7 +1973,29 @@ alloc_view_storage( View *view )
 					   view->y_axis_id ) );
 		exit( -1 );
 		}
-	view->pixels = (ncv_pixel *)malloc( scaled_x_size*scaled_y_size*sizeof(ncv_pixel) );
+	view->pixels   = NULL;
+	view->n_pixels = 0L;
+}
+
+/**************************************************************************************/
+/* Makes sure view->pixels has room for the whole blown-up image.  Big images
+ * drawn a tile at a time never need it, so it isn't made until it is used.
+ */
+	static void
+alloc_view_pixels( View *view )
+{
+	size_t	x_size, y_size, scaled_x_size, scaled_y_size;
+
+	x_size = *(view->variable->size + view->x_axis_id);
+	y_size = *(view->variable->size + view->y_axis_id);
+	view_get_scaled_size( options.blowup, x_size, y_size, &scaled_x_size, &scaled_y_size );
+	if( (view->pixels != NULL) && (view->n_pixels == scaled_x_size*scaled_y_size) )
+		return;
+
+	if( view->pixels != NULL )
+		free( view->pixels );
+	view->n_pixels = scaled_x_size*scaled_y_size;
+	view->pixels = (ncv_pixel *)malloc( view->n_pixels*sizeof(ncv_pixel) );
 	if( view->pixels == NULL ) {
 		fprintf( stderr, "ncview: can't allocate pixel array\n" );
 		fprintf( stderr, "variable name: %s\n", view->variable->name );
@@ -1519,6 +2015,22 @@ alloc_view_storage( View *view )
 		}
 }
 
+/**************************************************************************************/
+/* Returns the whole blown-up image of the current frame.  When the frame was
+ * drawn a tile at a time the whole image was never made, so make it now.
+ * Returns NULL if the frame can't be made.
+ */
+	ncv_pixel *
+view_whole_image( void )
+{
+	if( view_tiles_active( view )) {
+		alloc_view_pixels( view );
+		if( data_to_pixels( view ) < 0 )
+			return( NULL );
+		}
+	return( view->pixels );
+}
+
 /********************************************************************
  * The user has requested that we change the displayed range;
  * pop up appropriate dialog windows, get the new min and max
@@ -1641,12 +2153,28 @@ init_saveframes()
 	size_t	storage_size, n_scan_entries, xsize, ysize, n_extra_frames;
 	char	err_message[132];
 
+	in_pixmap_ring_invalidate();
+	view_tiles_invalidate();
+
 	if( options.save_frames == FALSE )
 		return;
 
 	if( framestore.frame != NULL ) {
 		free( framestore.frame );
 		free( framestore.frame_valid );
+		framestore.frame       = NULL;
+		framestore.frame_valid = NULL;
+		framestore.nt          = 0L;
+		}
+
+	/* Big images drawn a tile at a time keep their tiles in the tile
+	 * cache instead, so a framestore of whole frames is not made
+	 */
+	if( view_tiles_active( view )) {
+		framestore.valid = FALSE;
+		if( options.debug )
+			fprintf( stderr, "not making a framestore, since images are drawn in tiles\n" );
+		return;
 		}
 
 	if( view->scan_axis_id == -1 ) {
@@ -1701,6 +2229,9 @@ invalidate_all_saveframes()
 {
 	size_t	i;
 
+	in_pixmap_ring_invalidate();
+	view_tiles_invalidate();
+
 	if( view == NULL )
 		return;
 
@@ -1725,7 +2256,9 @@ init_view( View **view, NCVar *var )
 		}
 	(*view)->data         = NULL;
 	(*view)->data_status  = VDS_INVALID;
+	(*view)->data_stride  = 1;
 	(*view)->pixels       = NULL;
+	(*view)->n_pixels     = 0L;
 	(*view)->x_axis_id    = -1;
 	(*view)->y_axis_id    = -1;
 	(*view)->scan_axis_id = -1;
@@ -2139,12 +2672,10 @@ flip_if_inverted( View *view )
 view_report_position( int x, int y, unsigned int button_mask )
 {
 	size_t	data_x, data_y, x_size, y_size;
-	int	type, has_bounds, i, x_is_mapped, y_is_mapped;
+	int	i;
 	float	val;
-	double	new_dimval, bound_min, bound_max;
-	char	current_value_label[500], temp_string[1024];
+	char	current_value_label[500];
 	char	xdim_str[80], ydim_str[80];
-	NCDim	*xdim, *ydim;
 	size_t	virt_cursor_pos[MAX_NC_DIMS];
 
 	/* This can happen if you display a 2-d variable, then
@@ -2184,49 +2715,82 @@ view_report_position( int x, int y, unsigned int button_mask )
 		data_y = y_size - data_y - 1;
 	
 	/* Get the value of the data field under the cursor */
-	val = *((float *)view->data + data_x + data_y*x_size);
+	val = view_data_value( view, &data_x, &data_y );
+
+	/* Nothing to do if the readout would be the same as last time */
+	if( (readout.view == view) && (readout.variable == view->variable) &&
+	    (readout.x_axis_id == view->x_axis_id) && (readout.y_axis_id == view->y_axis_id) &&
+	    (readout.t_conv == options.t_conv) &&
+	    (readout.data_x == data_x) && (readout.data_y == data_y) &&
+	    (memcmp( &readout.val, &val, sizeof(float) ) == 0) &&
+	    (memcmp( readout.var_place, view->var_place, view->variable->n_dims*sizeof(size_t) ) == 0) )
+		return;
+	readout.view      = view;
+	readout.variable  = view->variable;
+	readout.x_axis_id = view->x_axis_id;
+	readout.y_axis_id = view->y_axis_id;
+	readout.t_conv    = options.t_conv;
+	readout.data_x    = data_x;
+	readout.data_y    = data_y;
+	readout.val       = val;
+	memcpy( readout.var_place, view->var_place, view->variable->n_dims*sizeof(size_t) );
+
+	/* Get virtual position in all dims for this mouse cursor point */
+	for( i=0; i<view->variable->n_dims; i++ ) 
+		virt_cursor_pos[i] = *(view->var_place+i);
+	virt_cursor_pos[ view->x_axis_id ] = data_x;
+	virt_cursor_pos[ view->y_axis_id ] = data_y;
 
-	/* Get the values of the X and Y indices. 
-	* 'type' is the data type of the dimension--can be float or character 
-	*/
-	xdim = *(view->variable->dim + view->x_axis_id);
-	ydim = *(view->variable->dim + view->y_axis_id);
+	view_axis_value_str( view->x_axis_id, data_x, virt_cursor_pos, xdim_str, 80 );
+	view_axis_value_str( view->y_axis_id, data_y, virt_cursor_pos, ydim_str, 80 );
 
-	x_is_mapped = (view->variable->dim_map_info[ view->x_axis_id ] != NULL);
-	y_is_mapped = (view->variable->dim_map_info[ view->y_axis_id ] != NULL);
-	if( 1 || x_is_mapped || y_is_mapped ) {
-		/* Get virtual position in all dims for this mouse cursor point */
-		for( i=0; i<view->variable->n_dims; i++ ) 
-			virt_cursor_pos[i] = *(view->var_place+i);
-		virt_cursor_pos[ view->x_axis_id ] = data_x;
-		virt_cursor_pos[ view->y_axis_id ] = data_y;
-		}
+	snprintf( current_value_label, 499, "Current: (i=%1ld, j=%1ld) %g (x=%s, y=%s)\n", 
+				data_x, data_y, val, xdim_str, ydim_str );
+	in_set_label( LABEL_DATA_VALUE, current_value_label );
+}
 
-	type = fi_dim_value( view->variable, view->x_axis_id, data_x, &new_dimval, 
-			temp_string, &has_bounds, &bound_min, &bound_max, virt_cursor_pos );
-	if( type == NC_DOUBLE ) {
-		if( (xdim != NULL) && xdim->timelike && options.t_conv )
-			fmt_time( xdim_str, 79, new_dimval, xdim, 1 );
+/**************************************************************************************/
+/* Puts the value of axis 'axis_id' of the view at 'place' into s, formatted for
+ * the position readout.  The values worked out when the var was first looked at
+ * are used when there are any, so the file isn't touched while the mouse moves.
+ */
+	static void
+view_axis_value_str( int axis_id, size_t place, size_t *virt_cursor_pos, char *s, size_t slen )
+{
+	NCDim	*dim;
+	nc_type	type;
+	int	has_bounds;
+	double	new_dimval, bound_min, bound_max;
+	char	temp_string[1024];
+
+	dim = *(view->variable->dim + axis_id);
+
+	if( (dim != NULL) && dim->have_calc_minmax && (! dim->char_values) &&
+	    (view->variable->dim_map_info[axis_id] == NULL) && (place < dim->size) ) {
+		if( place < dim->n_time_values ) {
+			if( options.t_conv )
+				fmt_time( s, slen-1, dim->time_values[place], dim, 1 );
+			else
+				snprintf( s, slen-1, "%.7lg", dim->time_values[place] );
+			}
 		else
-			snprintf( xdim_str, 79, "%.7lg", new_dimval );
+			snprintf( s, slen-1, "%.7lg", (double)dim->values[place] );
+		return;
 		}
-	else
-		strncpy( xdim_str, temp_string, 80 );
 
-	type = fi_dim_value( view->variable, view->y_axis_id, data_y, &new_dimval, 
+	type = fi_dim_value( view->variable, axis_id, place, &new_dimval, 
 			temp_string, &has_bounds, &bound_min, &bound_max, virt_cursor_pos );
 	if( type == NC_DOUBLE ) {
-		if( (ydim != NULL) && ydim->timelike && options.t_conv )
-			fmt_time( ydim_str, 79, new_dimval, ydim, 1 );
+		if( (dim != NULL) && dim->timelike && options.t_conv )
+			fmt_time( s, slen-1, new_dimval, dim, 1 );
 		else
-			snprintf( ydim_str, 79, "%.7lg", new_dimval );
+			snprintf( s, slen-1, "%.7lg", new_dimval );
 		}
 	else
-		strncpy( ydim_str, temp_string, 80 );
-
-	snprintf( current_value_label, 499, "Current: (i=%1ld, j=%1ld) %g (x=%s, y=%s)\n", 
-				data_x, data_y, val, xdim_str, ydim_str );
-	in_set_label( LABEL_DATA_VALUE, current_value_label );
+		{
+		strncpy( s, temp_string, slen-1 );
+		s[slen-1] = '\0';
+		}
 }
 
 /**************************************************************************************/
@@ -2254,7 +2818,7 @@ view_construct_scalar_coord_str( char *str, int slen )
 	ts = *(view->var_place);
 
 	/* The file associated with this time step */
-	fdb = view->variable->timestep_2_fdb[ts];
+	fdb = timestep_fdb( view->variable, ts );
 
 	/* The integer position of this FDB on the var's list of FDBs. 
 	 * We need this because the scalar data is cached by FDB, *not*
@@ -2328,6 +2892,9 @@ view_report_position_vals( float xval, float yval, int plot_index )
 		snprintf( current_value_label, 79, "Current: x=%g, y=%g", 
 				xval, yval );
 	in_set_label( LABEL_DATA_VALUE, current_value_label );
+
+	/* The main window's readout has to be put back next time */
+	readout.view = NULL;
 }
 
 /**************************************************************************************/
@@ -2338,7 +2905,7 @@ set_dataedit_place()
 	int	x, y;
 	size_t	index;
 
-	if( view->data_status == VDS_INVALID ) {
+	if( (view->data_status == VDS_INVALID) || (view->data_status == VDS_PREVIEW) ) {
 		fill_view_data( view );
 		view->data_status = VDS_VALID;
 		}
@@ -2402,7 +2969,7 @@ set_min_from_curdata()
 		data_y = y_size - data_y - 1;
 	
 	/* Get the value of the data field under the cursor */
-	val = *((float *)view->data + data_x + data_y*x_size);
+	val = view_data_value( view, &data_x, &data_y );
 
 	view->variable->user_min = val;
 	set_range_labels( val, view->variable->user_max );
@@ -2444,7 +3011,7 @@ set_max_from_curdata()
 		data_y = y_size - data_y - 1;
 	
 	/* Get the value of the data field under the cursor */
-	val = *((float *)view->data + data_x + data_y*x_size);
+	val = view_data_value( view, &data_x, &data_y );
 
 	view->variable->user_max = val;
 	set_range_labels( val, view->variable->user_max );
@@ -2464,6 +3031,11 @@ view_data_edit( void )
 	size_t	index, n_entries;
 	float	val;
 
+	if( view->data_stride != 1 ) {
+		in_error( "Can't edit the data while it is shrunk by sampling or\nfrom the pyramid, since only part of it has been read.\nPick a different shrink method in the options, or unshrink." );
+		return;
+		}
+
 	x_size = *(view->variable->size + view->x_axis_id);
 	y_size = *(view->variable->size + view->y_axis_id);
 
@@ -2510,6 +3082,7 @@ view_change_dat( size_t index, float new_val )
 	*((float *)view->data + x + (x_size)*y) = new_val;
 	init_saveframes();
 	lockout_view_changes = TRUE;
+	alloc_view_pixels( view );
 	if( data_to_pixels( view ) < 0 ) {
 		in_timer_clear();
 		if( view->variable->global_min == view->variable->global_max )
@@ -2836,7 +3409,9 @@ plot_XY_sc( size_t *start, size_t *count )
 			*(plot_XY_xvals+i) = (double)i;
 
 	/* Get the y values (values to be plotted) */
+	TRACE_BEGIN( "plot_XY extract", view->variable->name );
 	fi_get_data( view->variable, start, count, tmp_yvals );
+	TRACE_END( "plot_XY extract" );
 
 	/* Eliminate the missing values */
 	j = 0;
@@ -3015,9 +3590,19 @@ view_plot_XY_fmt_x_val( float val, int dimindex, char *s, size_t s_len )
 	void
 view_information( void )
 {
-	in_display_stuff( netcdf_att_string( view->variable->first_file->id,
-						view->variable->name ),  
-			view->variable->name );
+	char	*atts, *s;
+	size_t	len;
+
+	/* Show how long drawing has been taking along with the attributes */
+	atts = netcdf_att_string( view->variable->first_file->id, view->variable->name );
+	len  = strlen(atts) + 2000;
+	s    = (char *)malloc( len );
+	snprintf( s, len, "%s\n", atts );
+	timing_report( s + strlen(s), len - strlen(s) );
+
+	in_display_stuff( s, view->variable->name );
+	free( atts );
+	free( s );
 }
 
 /**************************************************************************************/
@@ -3087,12 +3672,12 @@ view_data_has_missing( View *v )
 
 	if( v->x_axis_id < 0 ) 
 		return(TRUE);
-	nx = *(v->variable->size + v->x_axis_id);
+	nx = (*(v->variable->size + v->x_axis_id) + v->data_stride - 1)/v->data_stride;
 
 	if( v->y_axis_id < 0 ) 
 		ny = 1;
 	else
-		ny = *(v->variable->size + v->y_axis_id);
+		ny = (*(v->variable->size + v->y_axis_id) + v->data_stride - 1)/v->data_stride;
 
 	for( i=0; i<nx*ny; i++ ) {
 		dat = *((float *)(v->data) + i);
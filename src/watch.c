@@ -0,0 +1,355 @@
+/*
+ * Ncview by David W. Pierce.  A visual netCDF file viewer.
+ * Copyright (C) 1993 through 2024 David W. Pierce
+ *
+ * This program  is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License, version 3, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ *
+ * David W. Pierce
+ * davidwilliampierce@gmail.com
+ */
+
+/*****************************************************************************
+ * Watching the last input file for new data.  When paused on the last
+ * frame, view_check_new_data asks every options.watch_interval msec if
+ * the file has changed, and only then looks inside it.  Where we have
+ * inotify, the answer comes from the kernel without touching the disk;
+ * otherwise, or if the file is on a network disk (where inotify never
+ * hears about writes made on other machines), we stat the file and see
+ * if its size or modification time changed.
+ *
+ * With -watch_new_files, we also keep an eye on the directory the file is
+ * in, and hand back new files in it that sort after the watched file and
+ * have the same suffix, so they can be added as more timesteps.  Only
+ * finished files are wanted, so with inotify we wait for the file to be
+ * closed after writing or moved into place.
+ *****************************************************************************/
+
+#include "ncview.includes.h"
+#include "ncview.defines.h"
+#include "ncview.protos.h"
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#endif
+
+extern Options  options;
+
+static struct {
+	int	fd;				/* inotify instance, or -1 if we are polling */
+	int	file_wd, dir_wd;		/* inotify watches on the file and its directory */
+	char	filename[MAX_FILE_NAME_LEN];	/* the file being watched */
+	char	dirname [MAX_FILE_NAME_LEN];	/* and the directory it is in */
+	off_t	size;				/* when polling, what the file */
+	time_t	mtime, dir_mtime;		/* and its directory looked like last time */
+	int	file_changed, dir_changed;
+	char	retry[MAX_FILE_NAME_LEN];	/* a new file (in dirname) that could not */
+	time_t	retry_mtime;			/* be used when last handed back */
+} watch = { -1, -1, -1, "", "", 0, 0, 0, FALSE, FALSE, "", 0 };
+
+static void	watch_split_name( char *filename, char *dirname, char **basename );
+static void	watch_drain_events( void );
+static int	watch_on_network_disk( char *filename );
+static int	watch_retry_changed( void );
+
+/*============================================================================*/
+/* Starts watching 'filename', if we aren't already.  Whatever we were
+ * watching before is dropped.
+ */
+	void
+watch_file( char *filename )
+{
+	struct stat	st;
+	char		*basename;
+
+	if( strcmp( filename, watch.filename ) == 0 )
+		return;
+
+	watch_stop();
+
+	if( strlen(filename) > (MAX_FILE_NAME_LEN-1) )
+		return;
+	strcpy( watch.filename, filename );
+	watch_split_name( watch.filename, watch.dirname, &basename );
+
+	watch.size      = 0;
+	watch.mtime     = 0;
+	watch.dir_mtime = 0;
+	if( stat( watch.filename, &st ) == 0 ) {
+		watch.size  = st.st_size;
+		watch.mtime = st.st_mtime;
+		}
+	if( stat( watch.dirname, &st ) == 0 )
+		watch.dir_mtime = st.st_mtime;
+
+	/* It may have changed before we started watching, so the first
+	 * time through the file and directory are always looked at.
+	 */
+	watch.file_changed = TRUE;
+	watch.dir_changed  = TRUE;
+	watch.retry[0]     = '\0';
+
+#ifdef HAVE_SYS_INOTIFY_H
+	if( ! watch_on_network_disk( watch.filename )) {
+		watch.fd = inotify_init();
+		if( watch.fd >= 0 ) {
+			fcntl( watch.fd, F_SETFL, fcntl( watch.fd, F_GETFL ) | O_NONBLOCK );
+			watch.file_wd = inotify_add_watch( watch.fd, watch.filename,
+					IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF );
+			if( options.watch_new_files )
+				watch.dir_wd = inotify_add_watch( watch.fd, watch.dirname, IN_CLOSE_WRITE | IN_MOVED_TO );
+			if( (watch.file_wd < 0) || (options.watch_new_files && (watch.dir_wd < 0)) ) {
+				close( watch.fd );
+				watch.fd      = -1;
+				watch.file_wd = -1;
+				watch.dir_wd  = -1;
+				}
+			}
+		}
+#endif
+
+	if( options.debug )
+		printf( "watch_file: watching %s by %s\n", watch.filename,
+			(watch.fd >= 0) ? "inotify" : "polling" );
+}
+
+/*============================================================================*/
+/* Stops watching */
+	void
+watch_stop( void )
+{
+	if( watch.fd >= 0 )
+		close( watch.fd );	/* takes the watches with it */
+	watch.fd          = -1;
+	watch.file_wd     = -1;
+	watch.dir_wd      = -1;
+	watch.filename[0] = '\0';
+}
+
+/*============================================================================*/
+/* Returns TRUE if the watched file has changed since the last time we
+ * were asked.
+ */
+	int
+watch_file_changed( void )
+{
+	struct stat	st;
+	int		changed;
+
+	if( watch.filename[0] == '\0' )
+		return( FALSE );
+
+	if( watch.fd >= 0 )
+		watch_drain_events();
+
+	else if( stat( watch.filename, &st ) == 0 ) {
+		if( (st.st_size != watch.size) || (st.st_mtime != watch.mtime) )
+			watch.file_changed = TRUE;
+		watch.size  = st.st_size;
+		watch.mtime = st.st_mtime;
+		}
+
+	changed = watch.file_changed;
+	watch.file_changed = FALSE;
+	return( changed );
+}
+
+/*============================================================================*/
+/* If a new file has turned up in the directory of the watched file that
+ * looks like it carries on from it, puts its name in new_filename and
+ * returns TRUE.  If there are several, we give the one that sorts first.
+ * Once handed back, the new file should be added and watched in place of
+ * the old one, or it will be handed back again.
+ */
+	int
+watch_new_file( char *new_filename, int len )
+{
+	struct stat	st;
+	DIR		*dir;
+	struct dirent	*de;
+	char		*basename, *suffix, *s, best[MAX_FILE_NAME_LEN], dirname[MAX_FILE_NAME_LEN],
+			path[MAX_FILE_NAME_LEN];
+	int		found;
+
+	if( (! options.watch_new_files) || (watch.filename[0] == '\0') )
+		return( FALSE );
+
+	if( watch.fd >= 0 )
+		watch_drain_events();
+
+	else if( stat( watch.dirname, &st ) == 0 ) {
+		if( st.st_mtime != watch.dir_mtime )
+			watch.dir_changed = TRUE;
+		watch.dir_mtime = st.st_mtime;
+		}
+
+	/* A new file that couldn't be used before is tried again once it changes */
+	if( (! watch.dir_changed) && (watch.retry[0] != '\0') && watch_retry_changed() )
+		watch.dir_changed = TRUE;
+
+	if( ! watch.dir_changed )
+		return( FALSE );
+	watch.dir_changed = FALSE;
+
+	watch_split_name( watch.filename, dirname, &basename );
+	suffix = strrchr( basename, '.' );
+	if( suffix == NULL )
+		suffix = "";
+
+	if( (dir = opendir( watch.dirname )) == NULL )
+		return( FALSE );
+	found = FALSE;
+	while( (de = readdir( dir )) != NULL ) {
+		s = strrchr( de->d_name, '.' );
+		if( s == NULL )
+			s = "";
+		if( (strcmp( s, suffix ) != 0) || (strcmp( de->d_name, basename ) <= 0) )
+			continue;
+		if( found && (strcmp( de->d_name, best ) >= 0) )
+			continue;
+		if( strlen(watch.dirname) + strlen(de->d_name) + 2 > MAX_FILE_NAME_LEN )
+			continue;
+		if( (strcmp( de->d_name, watch.retry ) == 0) && (! watch_retry_changed()) )
+			continue;
+		strcpy( best, de->d_name );
+		found = TRUE;
+		}
+	closedir( dir );
+
+	if( ! found )
+		return( FALSE );
+
+	if( strcmp( watch.dirname, "." ) == 0 )
+		snprintf( path, MAX_FILE_NAME_LEN, "%s", best );
+	else
+		snprintf( path, MAX_FILE_NAME_LEN, "%s/%s", watch.dirname, best );
+	snprintf( new_filename, len, "%s", path );
+
+	/* If the caller can't use it, don't give it back until it changes */
+	strcpy( watch.retry, best );
+	watch.retry_mtime = (stat( path, &st ) == 0) ? st.st_mtime : 0;
+
+	if( options.debug )
+		printf( "watch_new_file: found new file %s after %s\n", new_filename, watch.filename );
+
+	return( TRUE );
+}
+
+/*============================================================================*/
+/* The interval between checks for new data, in msec */
+	unsigned long
+watch_interval( void )
+{
+	return( (unsigned long)options.watch_interval );
+}
+
+/*============================================================================*/
+/* Splits filename into the directory (copied into dirname, "." if there is
+ * none) and a pointer to the base name, which points into filename.
+ */
+	static void
+watch_split_name( char *filename, char *dirname, char **basename )
+{
+	char	*slash;
+
+	slash = strrchr( filename, '/' );
+	if( slash == NULL ) {
+		strcpy( dirname, "." );
+		*basename = filename;
+		}
+	else if( slash == filename ) {
+		strcpy( dirname, "/" );
+		*basename = slash+1;
+		}
+	else
+		{
+		strncpy( dirname, filename, slash-filename );
+		dirname[slash-filename] = '\0';
+		*basename = slash+1;
+		}
+}
+
+/*============================================================================*/
+/* Returns TRUE if the new file that couldn't be used last time has changed */
+	static int
+watch_retry_changed( void )
+{
+	struct stat	st;
+	char		path[MAX_FILE_NAME_LEN];
+
+	snprintf( path, MAX_FILE_NAME_LEN, "%s/%s", watch.dirname, watch.retry );
+	if( stat( path, &st ) != 0 )
+		return( FALSE );
+	return( st.st_mtime != watch.retry_mtime );
+}
+
+/*============================================================================*/
+/* Reads whatever inotify has to tell us, without waiting */
+	static void
+watch_drain_events( void )
+{
+#ifdef HAVE_SYS_INOTIFY_H
+	char	buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	struct inotify_event *ev;
+	ssize_t	n;
+	char	*p;
+
+	while( (n = read( watch.fd, buf, sizeof(buf) )) > 0 ) {
+		for( p=buf; p<buf+n; p += sizeof(struct inotify_event) + ev->len ) {
+			ev = (struct inotify_event *)p;
+			if( ev->wd == watch.file_wd )
+				watch.file_changed = TRUE;
+			else if( ev->wd == watch.dir_wd )
+				watch.dir_changed = TRUE;
+			if( ev->mask & IN_Q_OVERFLOW ) {
+				watch.file_changed = TRUE;
+				watch.dir_changed  = TRUE;
+				}
+			}
+		}
+#endif
+}
+
+/*============================================================================*/
+/* Returns TRUE if the file is on a network disk, or one we can't tell
+ * about, where inotify won't hear about writes from other machines.
+ */
+	static int
+watch_on_network_disk( char *filename )
+{
+#ifdef HAVE_SYS_INOTIFY_H
+	struct statfs	sfs;
+	int		i;
+	static long	network_magic[] = {
+		0x6969L,		/* NFS */
+		0x517BL,		/* SMB */
+		0xFF534D42L,		/* CIFS */
+		0xFE534D42L,		/* SMB2 */
+		0x0BD00BD0L,		/* Lustre */
+		0x47504653L,		/* GPFS */
+		0x00C36400L,		/* Ceph */
+		0x5346414FL,		/* AFS */
+		0xAAD7AAEAL,		/* PanFS */
+		0x19830326L,		/* BeeGFS */
+		0x65735546L,		/* FUSE (sshfs and friends) */
+		0L };
+
+	if( statfs( filename, &sfs ) != 0 )
+		return( TRUE );
+	for( i=0; network_magic[i] != 0L; i++ )
+		if( (unsigned long)sfs.f_type == (unsigned long)network_magic[i] )
+			return( TRUE );
+#endif
+	return( FALSE );
+}